@@ -0,0 +1,294 @@
+// Boost.Polygon library polygon_formation_benchmark.cpp file
+
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// See http://www.boost.org for updates, documentation, and revision history.
+
+// Times polygon_90_set_data::get over a range of vthreshold values on
+// synthetic layouts (grids, combs, staircases, random rectangle clouds) and
+// on the shapes of example/input_data, and writes wall time, polygons per
+// second and peak resident set size of every run as CSV.
+//
+// Usage: polygon_formation_benchmark [input_data directory] [csv file]
+// The defaults are ../example/input_data and polygon_formation_benchmark.csv.
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/time.h>
+#define BOOST_POLYGON_BENCHMARK_POSIX
+#endif
+
+#define BOOST_POLYGON_NO_DEPS
+#include <boost/polygon/polygon.hpp>
+
+namespace gtl = boost::polygon;
+
+typedef int Unit;
+typedef gtl::rectangle_data<Unit> rectangle;
+typedef gtl::polygon_90_set_data<Unit> polygon_set;
+typedef gtl::polygon_90_with_holes_data<Unit> polygon;
+
+const std::size_t UNBOUNDED = (std::numeric_limits<std::size_t>::max)();
+const std::size_t THRESHOLDS[] = {UNBOUNDED, 1024, 256, 64, 16};
+const int NUM_THRESHOLDS = sizeof(THRESHOLDS) / sizeof(THRESHOLDS[0]);
+const int NUM_RUNS = 3;
+const char* INPUT_KINDS[] = {"polygon", "primary", "random"};
+const int NUM_INPUT_KINDS = sizeof(INPUT_KINDS) / sizeof(INPUT_KINDS[0]);
+
+double wall_time() {
+#ifdef BOOST_POLYGON_BENCHMARK_POSIX
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+// On Linux the high water mark of the process can be reset to what is
+// resident, the input set among it, so every run gets its own peak;
+// elsewhere the peak only grows and the runs are in increasing size order
+// within an input.
+void reset_peak_rss() {
+#ifdef __linux__
+  std::FILE* clear_refs = std::fopen("/proc/self/clear_refs", "w");
+  if (clear_refs) {
+    std::fputs("5", clear_refs);
+    std::fclose(clear_refs);
+  }
+#endif
+}
+
+// Peak resident set size in KiB, 0 where it cannot be measured.
+long peak_rss_kb() {
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) return std::atol(line.c_str() + 6);
+  }
+#endif
+#ifdef BOOST_POLYGON_BENCHMARK_POSIX
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+unsigned int next_random(unsigned int& state) {
+  state = state * 1103515245u + 12345u;
+  return (state >> 8) & 0xffff;
+}
+
+// n by n separate squares on a pitch of 10, every square a polygon.
+void make_grid(polygon_set& ps, int n) {
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      ps.insert(rectangle(10 * i, 10 * j, 10 * i + 6, 10 * j + 6));
+}
+
+// One polygon: a spine with n teeth of scattered length.
+void make_comb(polygon_set& ps, int n) {
+  unsigned int state = 31;
+  ps.insert(rectangle(0, 0, 10, 4 * n));
+  for (int i = 0; i < n; ++i)
+    ps.insert(rectangle(10, 4 * i, 20 + next_random(state) % 1000, 4 * i + 2));
+}
+
+// One polygon: a staircase of n steps, two vertices per step.
+void make_staircase(polygon_set& ps, int n) {
+  for (int i = 0; i < n; ++i)
+    ps.insert(rectangle(0, 4 * i, 4 * (n - i), 4 * i + 4));
+}
+
+// n rectangles of random size scattered over a square that they cover
+// about twice, merging into large polygons with many holes.
+void make_cloud(polygon_set& ps, int n) {
+  unsigned int state = 27;
+  int side = 1;
+  while (side * side < n * 64) side *= 2;
+  for (int i = 0; i < n; ++i) {
+    Unit x = next_random(state) % side;
+    Unit y = next_random(state) % side;
+    Unit w = 1 + next_random(state) % 16;
+    Unit h = 1 + next_random(state) % 16;
+    ps.insert(rectangle(x, y, x + w, y + h));
+  }
+}
+
+// The files of example/input_data hold points and segments for the
+// Voronoi examples, some with coordinates beyond 32 bits. Here every file is
+// fitted into a square of INPUT_SIDE, every point becomes a unit square and
+// every segment the rectangle it is the diagonal of, so the shapes overlap in
+// some places and not in others.
+const Unit INPUT_SIDE = 1024;
+
+bool load_input_data(polygon_set& ps, const std::string& file) {
+  std::ifstream in(file.c_str());
+  if (!in) return false;
+  std::vector<double> coordinates;
+  std::size_t num_points = 0, num_segments = 0;
+  in >> num_points;
+  for (std::size_t i = 0; i < 2 * num_points; ++i) {
+    double value = 0;
+    in >> value;
+    coordinates.push_back(value);
+  }
+  in >> num_segments;
+  for (std::size_t i = 0; i < 4 * num_segments; ++i) {
+    double value = 0;
+    in >> value;
+    coordinates.push_back(value);
+  }
+  if (coordinates.empty()) return true;
+  double low = coordinates[0], high = coordinates[0];
+  for (std::size_t i = 1; i < coordinates.size(); ++i) {
+    if (coordinates[i] < low) low = coordinates[i];
+    if (coordinates[i] > high) high = coordinates[i];
+  }
+  double scale = high > low ? (INPUT_SIDE - 1) / (high - low) : 1;
+  std::vector<Unit> units(coordinates.size());
+  for (std::size_t i = 0; i < coordinates.size(); ++i)
+    units[i] = static_cast<Unit>((coordinates[i] - low) * scale);
+  std::size_t i = 0;
+  for (; i < 2 * num_points; i += 2)
+    ps.insert(rectangle(units[i], units[i + 1], units[i] + 1, units[i + 1] + 1));
+  for (; i < units.size(); i += 4) {
+    rectangle r;
+    gtl::set_points(r, gtl::point_data<Unit>(units[i], units[i + 1]),
+                    gtl::point_data<Unit>(units[i + 2], units[i + 3]));
+    if (gtl::delta(r, gtl::HORIZONTAL) == 0 || gtl::delta(r, gtl::VERTICAL) == 0)
+      gtl::bloat(r, 1);
+    ps.insert(r);
+  }
+  return true;
+}
+
+struct result {
+  std::size_t polygons;
+  std::size_t vertices;
+  double seconds;
+  long peak_rss_kb;
+};
+
+result run(const polygon_set& ps, std::size_t threshold) {
+  result best;
+  best.seconds = (std::numeric_limits<double>::max)();
+  for (int run = 0; run < NUM_RUNS; ++run) {
+    reset_peak_rss();
+    std::vector<polygon> output;
+    double start = wall_time();
+    ps.get(output, threshold);
+    double elapsed = wall_time() - start;
+    long rss = peak_rss_kb();
+    if (elapsed < best.seconds) {
+      best.seconds = elapsed;
+      best.peak_rss_kb = rss;
+    }
+    best.polygons = output.size();
+    best.vertices = 0;
+    for (std::size_t i = 0; i < output.size(); ++i) {
+      best.vertices += output[i].size();
+      for (polygon::iterator_holes_type h = output[i].begin_holes();
+           h != output[i].end_holes(); ++h)
+        best.vertices += (*h).size();
+    }
+  }
+  return best;
+}
+
+void report(std::ostream& csv, const std::string& input, std::size_t size,
+            const polygon_set& ps) {
+  for (int t = 0; t < NUM_THRESHOLDS; ++t) {
+    result r = run(ps, THRESHOLDS[t]);
+    std::ostringstream threshold;
+    if (THRESHOLDS[t] == UNBOUNDED)
+      threshold << "none";
+    else
+      threshold << THRESHOLDS[t];
+    double rate = r.seconds > 0 ? r.polygons / r.seconds : 0;
+    csv << input << "," << size << "," << threshold.str() << "," << r.polygons
+        << "," << r.vertices << "," << r.seconds << "," << rate << ","
+        << r.peak_rss_kb << std::endl;
+    std::cout << "| " << std::setw(10) << input << " ";
+    std::cout << "| " << std::setw(7) << size << " ";
+    std::cout << "| " << std::setw(10) << threshold.str() << " ";
+    std::cout << "| " << std::setw(8) << r.polygons << " ";
+    std::cout << "| " << std::setw(10) << r.seconds << " ";
+    std::cout << "| " << std::setw(10) << static_cast<long>(rate) << " ";
+    std::cout << "| " << std::setw(9) << r.peak_rss_kb << " |" << std::endl;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string input_dir = argc > 1 ? argv[1] : "../example/input_data";
+  const char* csv_file = argc > 2 ? argv[2] : "polygon_formation_benchmark.csv";
+  std::ofstream csv(csv_file);
+  if (!csv) {
+    std::cerr << "cannot write " << csv_file << std::endl;
+    return 1;
+  }
+  csv << "input,size,vthreshold,polygons,vertices,seconds,polygons_per_second,"
+         "peak_rss_kb" << std::endl;
+  std::cout << "| input      | size    | vthreshold | polygons | seconds    "
+               "| polygons/s | peak KiB  |" << std::endl;
+
+  typedef void (*generator)(polygon_set&, int);
+  const char* names[] = {"grid", "comb", "staircase", "cloud"};
+  const generator generators[] = {make_grid, make_comb, make_staircase,
+                                  make_cloud};
+  const int sizes[4][3] = {{100, 300, 1000},
+                           {10000, 100000, 1000000},
+                           {10000, 100000, 1000000},
+                           {10000, 100000, 1000000}};
+  for (int g = 0; g < 4; ++g) {
+    for (int i = 0; i < 3; ++i) {
+      polygon_set ps(gtl::HORIZONTAL);
+      generators[g](ps, sizes[g][i]);
+      ps.clean();
+      report(csv, names[g], sizes[g][i], ps);
+    }
+  }
+
+  for (int k = 0; k < NUM_INPUT_KINDS; ++k) {
+    polygon_set ps(gtl::HORIZONTAL);
+    std::size_t files = 0;
+    for (;; ++files) {
+      char name[64];
+      std::sprintf(name, "/%s/%s_%03d.txt", INPUT_KINDS[k], INPUT_KINDS[k],
+                   static_cast<int>(files + 1));
+      polygon_set file_set(gtl::HORIZONTAL);
+      if (!load_input_data(file_set, input_dir + name)) break;
+      // side by side, one file per column
+      file_set.move(static_cast<Unit>(files) * 2 * INPUT_SIDE, 0);
+      ps.insert(file_set);
+    }
+    if (files == 0) {
+      std::cerr << "no " << INPUT_KINDS[k] << " files in " << input_dir
+                << ", skipped" << std::endl;
+      continue;
+    }
+    ps.clean();
+    report(csv, INPUT_KINDS[k], files, ps);
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+// Boost.Polygon library polygon_formation_tail_map_benchmark.cpp file
+
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// See http://www.boost.org for updates, documentation, and revision history.
+
+// Compares the scanline tail map implementations of the Manhattan polygon
+// formation (std::map against FlatTailMap) on wide scanlines, where the
+// number of active tails is 10^5 or more at most scan stops.
+
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <vector>
+
+#define BOOST_POLYGON_NO_DEPS
+#include <boost/polygon/polygon.hpp>
+
+namespace gtl = boost::polygon;
+using namespace boost::polygon::polygon_formation;
+
+typedef int Unit;
+typedef gtl::polygon_90_set_data<Unit> polygon_set;
+typedef std::map<Unit, ActiveTail<Unit>*> std_tail_map;
+typedef FlatTailMap<Unit, ActiveTail<Unit>*> flat_tail_map;
+
+const int NUM_TESTS = 3;
+const int NUM_BARS[] = {50000, 100000, 200000};
+const int NUM_RUNS = 3;
+
+// Only count figures, so the timing is dominated by the scanline itself.
+struct count_output {
+  std::size_t vertices;
+  count_output() : vertices(0) {}
+  template <typename figure_type>
+  void operator()(const figure_type& figure) {
+    for (typename figure_type::iterator_type itr = figure.begin();
+         itr != figure.end(); ++itr)
+      ++vertices;
+  }
+};
+
+unsigned int next_random(unsigned int& state) {
+  state = state * 1103515245u + 12345u;
+  return (state >> 8) & 0xffff;
+}
+
+// Horizontal bars stacked in y whose left and right ends are scattered,
+// so every scan stop touches a few tails spread over the whole scanline
+// while all the other bars stay active.
+void make_bars(polygon_set& ps, int num_bars) {
+  unsigned int state = 27;
+  for (int i = 0; i < num_bars; ++i) {
+    Unit x0 = next_random(state) % 1000;
+    Unit x1 = 1000 + next_random(state) % 1000;
+    ps.insert(gtl::rectangle_data<Unit>(x0, 2 * i, x1, 2 * i + 1));
+  }
+}
+
+// Comb with num_bars teeth hanging off a spine, the teeth again end at
+// scattered x positions.
+void make_comb(polygon_set& ps, int num_bars) {
+  unsigned int state = 31;
+  ps.insert(gtl::rectangle_data<Unit>(0, 0, 10, 2 * num_bars));
+  for (int i = 0; i < num_bars; ++i) {
+    Unit x1 = 1000 + next_random(state) % 1000;
+    ps.insert(gtl::rectangle_data<Unit>(10, 2 * i, x1, 2 * i + 1));
+  }
+}
+
+template <typename tail_map_type>
+double run(const polygon_set& ps, std::size_t threshold, std::size_t& vertices) {
+  double best = (std::numeric_limits<double>::max)();
+  for (int run = 0; run < NUM_RUNS; ++run) {
+    ScanLineToPolygonItrs<true, Unit, gtl::polygon_90_concept, tail_map_type>
+        scanline(true);
+    count_output output;
+    std::clock_t start = std::clock();
+    formPolygons(scanline, ps.begin(), ps.end(), threshold, output);
+    double elapsed =
+        static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    if (elapsed < best) best = elapsed;
+    vertices = output.vertices;
+  }
+  return best;
+}
+
+void format_line(const char* name, int num_bars, std::size_t threshold,
+                 double map_time, double flat_time) {
+  std::cout << "| " << std::setw(6) << name << " ";
+  std::cout << "| " << std::setw(8) << num_bars << " ";
+  std::cout << "| " << std::setw(10);
+  if (threshold == (std::numeric_limits<std::size_t>::max)())
+    std::cout << "none";
+  else
+    std::cout << threshold;
+  std::cout << " | " << std::setw(10) << map_time;
+  std::cout << " | " << std::setw(10) << flat_time;
+  std::cout << " | " << std::setw(7) << map_time / flat_time;
+  std::cout << " |" << std::endl;
+}
+
+int main() {
+  const std::size_t thresholds[] = {
+      (std::numeric_limits<std::size_t>::max)(), 16};
+  std::cout << "| input  | bars     | vthreshold | std::map s | flat s     "
+               "| speedup |" << std::endl;
+  for (int shape = 0; shape < 2; ++shape) {
+    for (int i = 0; i < NUM_TESTS; ++i) {
+      polygon_set ps(gtl::VERTICAL);
+      if (shape == 0)
+        make_bars(ps, NUM_BARS[i]);
+      else
+        make_comb(ps, NUM_BARS[i]);
+      ps.clean();
+      for (int t = 0; t < 2; ++t) {
+        std::size_t map_vertices = 0, flat_vertices = 0;
+        double map_time = run<std_tail_map>(ps, thresholds[t], map_vertices);
+        double flat_time =
+            run<flat_tail_map>(ps, thresholds[t], flat_vertices);
+        if (map_vertices != flat_vertices) {
+          std::cerr << "tail maps disagree: " << map_vertices << " vs "
+                    << flat_vertices << " vertices" << std::endl;
+          return 1;
+        }
+        format_line(shape ? "comb" : "bars", NUM_BARS[i], thresholds[t],
+                    map_time, flat_time);
+      }
+    }
+  }
+  return 0;
+}
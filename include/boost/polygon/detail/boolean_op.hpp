@@ -30,6 +30,10 @@ namespace boolean_op {
     inline BooleanOp (T nullT) : scanData_(), nextItr_(), nullT_(nullT) { nextItr_ = scanData_.end(); }
     inline BooleanOp (const BooleanOp& that) : scanData_(that.scanData_), nextItr_(),
                                                nullT_(that.nullT_) { nextItr_ = scanData_.begin(); }
+    //starts from the transitions of [begin, end), sorted by position
+    template <class iT>
+    inline BooleanOp (iT begin, iT end, T nullT) : scanData_(begin, end), nextItr_(), nullT_(nullT) {
+      nextItr_ = scanData_.end(); }
     inline BooleanOp& operator=(const BooleanOp& that);
 
     //moves scanline forward
@@ -54,6 +58,115 @@ namespace boolean_op {
     inline void evaluateInterval_(cT& outputContainer, interval_data<Unit> ivl, T beforeCount, T afterCount);
   };
 
+  //BooleanOpFlat is BooleanOp with the scanline in a sorted vector instead of a map.  The
+  //intervals of a scan stop come in sorted and disjoint, so the transitions of the scanline are
+  //rebuilt at every stop by merging them with the intervals into a second vector, which is
+  //swapped in on advanceScan; there is no allocation per transition and every access is
+  //sequential.  Output is the same as the one of BooleanOp, interval for interval of the count.
+  //Rebuilding costs the length of the scanline at every stop, which does not pay off when a long
+  //scanline sees few intervals per stop, so once the transitions copied outnumber the intervals
+  //processed by far the scanline is moved into a BooleanOp for the rest of the scan.
+  template <class T, typename Unit>
+  class BooleanOpFlat {
+  public:
+    typedef std::pair<Unit, T> ElementType;
+    typedef std::vector<ElementType> ScanData;
+  private:
+    ScanData scanData_; //transitions before this stop, the count holds up to the next one
+    ScanData nextScanData_; //transitions after this stop, up to the intervals processed
+    std::size_t nextIndex_; //first transition of scanData_ not merged yet
+    T count_; //count of scanData_ at the position merged up to
+    T nullT_;
+    BooleanOp<T, Unit> tree_; //the scanline once it is no longer flat
+    bool flat_;
+    std::size_t copied_; //transitions copied by advanceScan
+    std::size_t processed_; //intervals processed
+  public:
+    inline BooleanOpFlat() : scanData_(), nextScanData_(), nextIndex_(0), count_(), nullT_(), tree_(),
+                             flat_(true), copied_(0), processed_(0) {
+      nullT_ = 0; count_ = nullT_; }
+    inline BooleanOpFlat(T nullT) : scanData_(), nextScanData_(), nextIndex_(0), count_(nullT), nullT_(nullT),
+                                    tree_(nullT), flat_(true), copied_(0), processed_(0) {}
+    //starts from the transitions of [begin, end), sorted by position
+    template <class iT>
+    inline BooleanOpFlat(iT begin, iT end, T nullT) : scanData_(begin, end), nextScanData_(), nextIndex_(0),
+                                                      count_(nullT), nullT_(nullT), tree_(nullT), flat_(true),
+                                                      copied_(0), processed_(0) {}
+
+    //moves scanline forward
+    inline void advanceScan() {
+      if(!flat_) {
+        tree_.advanceScan();
+        return;
+      }
+      copied_ += scanData_.size() - nextIndex_;
+      for( ; nextIndex_ < scanData_.size(); ++nextIndex_)
+        push_(scanData_[nextIndex_].first, scanData_[nextIndex_].second);
+      scanData_.swap(nextScanData_);
+      nextScanData_.clear();
+      nextIndex_ = 0;
+      count_ = nullT_;
+      if(copied_ > 65536 && copied_ / 32 > processed_) {
+        tree_ = BooleanOp<T, Unit>(scanData_.begin(), scanData_.end(), nullT_);
+        flat_ = false;
+        ScanData().swap(scanData_);
+        ScanData().swap(nextScanData_);
+      }
+    }
+
+    //proceses the given interval and T data, which must come after the intervals processed
+    //since the last advanceScan; appends output edges to cT
+    template <class cT>
+    inline void processInterval(cT& outputContainer, interval_data<Unit> ivl, T deltaCount) {
+      if(!flat_) {
+        tree_.processInterval(outputContainer, ivl, deltaCount);
+        return;
+      }
+      ++processed_;
+      for( ; nextIndex_ < scanData_.size() && scanData_[nextIndex_].first < ivl.low(); ++nextIndex_) {
+        ++copied_;
+        count_ = scanData_[nextIndex_].second;
+        push_(scanData_[nextIndex_].first, count_);
+      }
+      Unit low = ivl.low();
+      while(true) {
+        if(nextIndex_ < scanData_.size() && scanData_[nextIndex_].first == low)
+          count_ = scanData_[nextIndex_++].second;
+        Unit high = ivl.high();
+        if(nextIndex_ < scanData_.size() && scanData_[nextIndex_].first < high)
+          high = scanData_[nextIndex_].first;
+        T afterCount = count_ + deltaCount;
+        push_(low, afterCount);
+        evaluateInterval_(outputContainer, interval_data<Unit>(low, high), count_, afterCount);
+        if(high == ivl.high())
+          break;
+        low = high;
+      }
+      if(nextIndex_ < scanData_.size() && scanData_[nextIndex_].first == ivl.high())
+        count_ = scanData_[nextIndex_++].second;
+      push_(ivl.high(), count_);
+    }
+
+  private:
+    //appends a transition to the next scanline, replacing one at the same position and
+    //leaving out one that does not change the count
+    inline void push_(Unit pos, const T& count) {
+      if(!nextScanData_.empty() && nextScanData_.back().first == pos)
+        nextScanData_.pop_back();
+      if(nextScanData_.empty() ? count != nullT_ : count != nextScanData_.back().second)
+        nextScanData_.push_back(ElementType(pos, count));
+    }
+    template <class cT>
+    inline void evaluateInterval_(cT& outputContainer, interval_data<Unit> ivl, T beforeCount, T afterCount) {
+      bool before = (int)beforeCount > 0;
+      bool after = (int)afterCount > 0;
+      int value =  (!before & after) - (before & !after);
+      if(value) {
+        outputContainer.insert(outputContainer.end(), std::pair<interval_data<Unit>, int>(ivl, value));
+      }
+    }
+  };
+
   class BinaryAnd {
   public:
     inline BinaryAnd() {}
@@ -140,6 +253,91 @@ namespace boolean_op {
     int count_;
   };
 
+  class NaryAny {
+  public:
+    inline NaryAny() {}
+    inline bool operator()(const std::vector<int>& counts) const {
+      for(std::size_t i = 0; i < counts.size(); ++i)
+        if(counts[i] > 0) return true;
+      return false;
+    }
+  };
+  class NaryAll {
+  public:
+    inline NaryAll() {}
+    inline bool operator()(const std::vector<int>& counts) const {
+      for(std::size_t i = 0; i < counts.size(); ++i)
+        if(!(counts[i] > 0)) return false;
+      return !counts.empty();
+    }
+  };
+  class NaryAtLeast {
+  public:
+    inline explicit NaryAtLeast(std::size_t k) : k_(k) {}
+    inline bool operator()(const std::vector<int>& counts) const {
+      std::size_t covered = 0;
+      for(std::size_t i = 0; i < counts.size(); ++i)
+        covered += counts[i] > 0;
+      return covered >= k_ && covered > 0;
+    }
+  private:
+    std::size_t k_;
+  };
+
+  //NaryCount is the N layer counterpart of BinaryCount, the counts of any number of layers
+  //of scan event data, which casts to int by evaluating them with a predicate object.  The
+  //predicate gets the vector of counts and must be false when they are all zero.  It is held
+  //by pointer, so it may have state, like the k of NaryAtLeast, and must outlive the counts.
+  //The scanline copies counts all the time, so up to inline_size of them are kept in the object
+  //and the predicate is handed a scratch vector owned by the sweep, which they are copied to.
+  template <class T>
+  class NaryCount {
+  public:
+    static const std::size_t inline_size = 6;
+    inline NaryCount() : size_(0), heap_(), predicate_(0), scratch_(0) {}
+    inline NaryCount(std::size_t size, const T& predicate, std::vector<int>& scratch) :
+      size_(size), heap_(size > inline_size ? size : 0, 0), predicate_(&predicate), scratch_(&scratch) {
+      std::fill(inline_, inline_ + inline_size, 0);
+    }
+    inline NaryCount& operator=(int count) { std::fill(begin_(), begin_() + size_, count); return *this; }
+    inline bool operator==(const NaryCount& that) const {
+      return size_ == that.size_ && std::equal(begin_(), begin_() + size_, that.begin_());
+    }
+    inline bool operator!=(const NaryCount& that) const { return !((*this) == that);}
+    inline NaryCount& operator+=(const NaryCount& that) {
+      int* counts = begin_();
+      const int* thatCounts = that.begin_();
+      for(std::size_t i = 0; i < size_; ++i)
+        counts[i] += thatCounts[i];
+      return *this;
+    }
+    inline NaryCount& operator-=(const NaryCount& that) {
+      int* counts = begin_();
+      const int* thatCounts = that.begin_();
+      for(std::size_t i = 0; i < size_; ++i)
+        counts[i] -= thatCounts[i];
+      return *this;
+    }
+    inline NaryCount operator+(const NaryCount& that) const { NaryCount tmp(*this); tmp += that; return tmp; }
+    inline NaryCount operator-(const NaryCount& that) const { NaryCount tmp(*this); tmp -= that; return tmp; }
+    inline NaryCount operator-() const { NaryCount tmp(*this); tmp = 0; return tmp - *this; }
+    inline int& operator[](std::size_t index) { return begin_()[index]; }
+
+    //cast to int operator evaluates data using T predicate
+    inline operator int() const {
+      scratch_->assign(begin_(), begin_() + size_);
+      return (*predicate_)(*scratch_);
+    }
+  private:
+    inline int* begin_() { return size_ > inline_size ? &heap_[0] : inline_; }
+    inline const int* begin_() const { return size_ > inline_size ? &heap_[0] : inline_; }
+    std::size_t size_;
+    int inline_[inline_size];
+    std::vector<int> heap_; //the counts when there are more than inline_size of them
+    const T* predicate_;
+    std::vector<int>* scratch_;
+  };
+
   template <class T, typename Unit>
   inline BooleanOp<T, Unit>& BooleanOp<T, Unit>::operator=(const BooleanOp& that) {
     scanData_ = that.scanData_;
@@ -265,14 +463,14 @@ namespace boolean_op {
   }
 
 
-  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
-  inline void applyBooleanBinaryOp(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
-                                   //const std::vector<std::pair<Unit, std::pair<Unit, int> > >& input1,
-                                   //const std::vector<std::pair<Unit, std::pair<Unit, int> > >& input2,
+  //the sweep of applyBooleanBinaryOp from the scanline boolean holds, which is the scanline
+  //before the first scan stop of the inputs; the output may be any container of vertices with
+  //empty, back, push_back and pop_back, the last vertex being the only one read back
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2, typename output_type>
+  inline void applyBooleanBinaryOp(output_type& output,
                                    iterator_type_1 itr1, iterator_type_1 itr1_end,
                                    iterator_type_2 itr2, iterator_type_2 itr2_end,
-                                   T defaultCount) {
-    BooleanOp<T, Unit> boolean(defaultCount);
+                                   T defaultCount, BooleanOpFlat<T, Unit>& boolean) {
     //typename std::vector<std::pair<Unit, std::pair<Unit, int> > >::const_iterator itr1 = input1.begin();
     //typename std::vector<std::pair<Unit, std::pair<Unit, int> > >::const_iterator itr2 = input2.begin();
     std::vector<std::pair<interval_data<Unit>, int> > container;
@@ -366,6 +564,17 @@ namespace boolean_op {
     }
   }
 
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
+  inline void applyBooleanBinaryOp(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                   //const std::vector<std::pair<Unit, std::pair<Unit, int> > >& input1,
+                                   //const std::vector<std::pair<Unit, std::pair<Unit, int> > >& input2,
+                                   iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                   iterator_type_2 itr2, iterator_type_2 itr2_end,
+                                   T defaultCount) {
+    BooleanOpFlat<T, Unit> boolean(defaultCount);
+    applyBooleanBinaryOp(output, itr1, itr1_end, itr2, itr2_end, defaultCount, boolean);
+  }
+
   template <class T, typename Unit>
   inline void applyBooleanBinaryOp(std::vector<std::pair<Unit, std::pair<Unit, int> > >& inputOutput,
                                    const std::vector<std::pair<Unit, std::pair<Unit, int> > >& input2,
@@ -380,6 +589,81 @@ namespace boolean_op {
     inputOutput.insert(inputOutput.end(), output.begin(), output.end());
   }
 
+  //orders the heap of applyBooleanNaryOp with the least element on top
+  template <typename T>
+  class NaryHeapOrder {
+  public:
+    inline bool operator()(const T& lvalue, const T& rvalue) const { return rvalue < lvalue; }
+  };
+
+  //the boolean of N layers in one sweep: inputs holds the sorted and clean vertex ranges of the
+  //layers, which are merged through a heap as the sweep goes, and the output has the regions
+  //where predicate holds on the counts of the layers
+  template <typename Unit, typename iterator_type, class T>
+  inline void applyBooleanNaryOp(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                 const std::vector<std::pair<iterator_type, iterator_type> >& inputs,
+                                 const T& predicate) {
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+    typedef std::pair<vertex_type, std::size_t> heap_element; //vertex and the layer it is from
+    std::vector<iterator_type> itrs(inputs.size());
+    std::vector<heap_element> heap;
+    heap.reserve(inputs.size());
+    for(std::size_t i = 0; i < inputs.size(); ++i) {
+      itrs[i] = inputs[i].first;
+      if(itrs[i] != inputs[i].second)
+        heap.push_back(heap_element(*itrs[i], i));
+    }
+    NaryHeapOrder<heap_element> later;
+    std::make_heap(heap.begin(), heap.end(), later);
+    std::vector<int> scratch;
+    NaryCount<T> defaultCount(inputs.size(), predicate, scratch);
+    BooleanOp<NaryCount<T>, Unit> boolean(defaultCount);
+    std::vector<std::pair<interval_data<Unit>, int> > container;
+    NaryCount<T> count(defaultCount);
+    Unit prevCoord = Unit();
+    Unit prevPosition = Unit();
+    bool first = true;
+    while(!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      vertex_type vertex = heap.back().first;
+      std::size_t layer = heap.back().second;
+      if(++itrs[layer] != inputs[layer].second) {
+        heap.back().first = *itrs[layer];
+        std::push_heap(heap.begin(), heap.end(), later);
+      } else {
+        heap.pop_back();
+      }
+      if(first || vertex.first != prevCoord) {
+        if(!first)
+          boolean.advanceScan();
+        first = false;
+        prevCoord = vertex.first;
+        prevPosition = vertex.second.first;
+        count = defaultCount;
+        count[layer] += vertex.second.second;
+        continue;
+      }
+      if(vertex.second.first != prevPosition && count != defaultCount) {
+        interval_data<Unit> ivl(prevPosition, vertex.second.first);
+        container.clear();
+        boolean.processInterval(container, ivl, count);
+        for(std::size_t i = 0; i < container.size(); ++i) {
+          std::pair<interval_data<Unit>, int>& element = container[i];
+          if(!output.empty() && output.back().first == prevCoord &&
+             output.back().second.first == element.first.low() &&
+             output.back().second.second == element.second * -1) {
+            output.pop_back();
+          } else {
+            output.push_back(vertex_type(prevCoord, std::pair<Unit, int>(element.first.low(), element.second)));
+          }
+          output.push_back(vertex_type(prevCoord, std::pair<Unit, int>(element.first.high(), element.second * -1)));
+        }
+      }
+      prevPosition = vertex.second.first;
+      count[layer] += vertex.second.second;
+    }
+  }
+
   template <typename Unit>
   inline void applyUnaryXOr(std::vector<std::pair<Unit, std::pair<Unit, int> > >& input) {
     BooleanOp<UnaryCount, Unit> booleanXOr;
@@ -0,0 +1,197 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_BOOLEAN_OP_TILES_HPP
+#define BOOST_POLYGON_BOOLEAN_OP_TILES_HPP
+#include "parallel_for.hpp"
+namespace boost { namespace polygon{
+
+  //number of threads the booleans of polygon_90_set_data may run on, 1 by default and 0 for one
+  //per hardware thread; it only has an effect when BOOST_POLYGON_USE_THREADS is defined
+  inline std::size_t& polygon_boolean_threads() {
+    static std::size_t threads = 1;
+    return threads;
+  }
+
+namespace boolean_op {
+
+  //the scanline entering a tile from the coverage profiles of the two inputs at its start,
+  //the transitions the serial sweep has in its scanline there
+  template <class T, typename Unit>
+  inline void tileScanline(std::vector<std::pair<Unit, T> >& scanline,
+                           const std::vector<std::pair<Unit, int> >& profile1,
+                           const std::vector<std::pair<Unit, int> >& profile2,
+                           T defaultCount) {
+    scanline.clear();
+    T count(defaultCount);
+    std::size_t i = 0, j = 0;
+    while(i < profile1.size() || j < profile2.size()) {
+      Unit pos;
+      if(j == profile2.size() || (i < profile1.size() && profile1[i].first <= profile2[j].first))
+        pos = profile1[i].first;
+      else
+        pos = profile2[j].first;
+      T previous(count);
+      if(i < profile1.size() && profile1[i].first == pos)
+        count[0] += profile1[i++].second;
+      if(j < profile2.size() && profile2[j].first == pos)
+        count[1] += profile2[j++].second;
+      if(count != previous)
+        scanline.push_back(std::make_pair(pos, count));
+    }
+  }
+
+  //sweeps tile k of both inputs, starting from the scanline at its start
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
+  class BooleanTileTask {
+  private:
+    typedef std::vector<std::pair<Unit, int> > profile_type;
+    const std::vector<iterator_type_1>& bounds1_;
+    const std::vector<iterator_type_2>& bounds2_;
+    const std::vector<profile_type>& profiles1_;
+    const std::vector<profile_type>& profiles2_;
+    std::vector<std::vector<std::pair<Unit, std::pair<Unit, int> > > >& outputs_;
+    T defaultCount_;
+  public:
+    inline BooleanTileTask(const std::vector<iterator_type_1>& bounds1, const std::vector<iterator_type_2>& bounds2,
+                           const std::vector<profile_type>& profiles1, const std::vector<profile_type>& profiles2,
+                           std::vector<std::vector<std::pair<Unit, std::pair<Unit, int> > > >& outputs,
+                           T defaultCount) :
+      bounds1_(bounds1), bounds2_(bounds2), profiles1_(profiles1), profiles2_(profiles2), outputs_(outputs),
+      defaultCount_(defaultCount) {}
+    inline void operator()(std::size_t k) {
+      std::vector<std::pair<Unit, T> > scanline;
+      tileScanline(scanline, profiles1_[k], profiles2_[k], defaultCount_);
+      BooleanOpFlat<T, Unit> boolean(scanline.begin(), scanline.end(), defaultCount_);
+      applyBooleanBinaryOp(outputs_[k], bounds1_[k], bounds1_[k + 1], bounds2_[k], bounds2_[k + 1],
+                           defaultCount_, boolean);
+    }
+  };
+
+  template <typename Unit>
+  class TileStopOrder {
+  public:
+    template <typename vertex_type>
+    inline bool operator()(const vertex_type& vertex, Unit stop) const { return vertex.first < stop; }
+  };
+
+  /*
+   * applyBooleanBinaryOpInTiles cuts the sorted inputs, which must be random access, into up to
+   * numTiles tiles at the same scan stops and sweeps the tiles on up to numThreads threads.  The
+   * scanline entering a tile is the sum of the net coverage profiles of the tiles before it, which
+   * are taken in parallel first.  Scan stops are not split between tiles, so the output is the
+   * concatenation of the outputs of the tiles and the same as the one of applyBooleanBinaryOp.
+   */
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
+  inline void applyBooleanBinaryOpInTiles(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                          iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                          iterator_type_2 itr2, iterator_type_2 itr2_end,
+                                          T defaultCount, std::size_t numTiles, std::size_t numThreads) {
+    typedef std::vector<std::pair<Unit, int> > profile_type;
+    std::size_t size1 = itr1_end - itr1;
+    std::size_t size2 = itr2_end - itr2;
+    if(size1 == 0 && size2 == 0)
+      return;
+    //tiles start at stops of the bigger input at even intervals of its vertices
+    std::vector<Unit> stops;
+    for(std::size_t k = 1; k < numTiles; ++k) {
+      Unit stop = size1 >= size2 ? (*(itr1 + (size1 * k) / numTiles)).first : (*(itr2 + (size2 * k) / numTiles)).first;
+      if(stops.empty() || stops.back() < stop)
+        stops.push_back(stop);
+    }
+    std::vector<iterator_type_1> bounds1(1, itr1);
+    std::vector<iterator_type_2> bounds2(1, itr2);
+    for(std::size_t k = 0; k < stops.size(); ++k) {
+      iterator_type_1 bound1 = std::lower_bound(bounds1.back(), itr1_end, stops[k], TileStopOrder<Unit>());
+      iterator_type_2 bound2 = std::lower_bound(bounds2.back(), itr2_end, stops[k], TileStopOrder<Unit>());
+      if(bound1 == bounds1.back() && bound2 == bounds2.back())
+        continue;
+      bounds1.push_back(bound1);
+      bounds2.push_back(bound2);
+    }
+    bounds1.push_back(itr1_end);
+    bounds2.push_back(itr2_end);
+    numTiles = bounds1.size() - 1;
+    if(numTiles < 2) {
+      applyBooleanBinaryOp(output, itr1, itr1_end, itr2, itr2_end, defaultCount);
+      return;
+    }
+
+    std::vector<profile_type> netProfiles1(numTiles), netProfiles2(numTiles);
+    polygon_formation::SlabProfileTask<iterator_type_1, Unit> profileTask1(bounds1, netProfiles1);
+    polygon_formation::SlabProfileTask<iterator_type_2, Unit> profileTask2(bounds2, netProfiles2);
+    parallel_for(numTiles - 1, numThreads, profileTask1);
+    parallel_for(numTiles - 1, numThreads, profileTask2);
+    std::vector<profile_type> profiles1(numTiles), profiles2(numTiles);
+    for(std::size_t k = 1; k < numTiles; ++k) {
+      polygon_formation::addProfiles(profiles1[k], profiles1[k - 1], netProfiles1[k - 1]);
+      polygon_formation::addProfiles(profiles2[k], profiles2[k - 1], netProfiles2[k - 1]);
+    }
+    netProfiles1.clear();
+    netProfiles2.clear();
+
+    std::vector<std::vector<std::pair<Unit, std::pair<Unit, int> > > > outputs(numTiles);
+    BooleanTileTask<T, Unit, iterator_type_1, iterator_type_2>
+      tileTask(bounds1, bounds2, profiles1, profiles2, outputs, defaultCount);
+    parallel_for(numTiles, numThreads, tileTask);
+    std::size_t outputSize = output.size();
+    for(std::size_t k = 0; k < numTiles; ++k)
+      outputSize += outputs[k].size();
+    output.reserve(outputSize);
+    for(std::size_t k = 0; k < numTiles; ++k) {
+      output.insert(output.end(), outputs[k].begin(), outputs[k].end());
+      std::vector<std::pair<Unit, std::pair<Unit, int> > >().swap(outputs[k]);
+    }
+  }
+
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
+  inline void applyBooleanBinaryOpOnThreads(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                            iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                            iterator_type_2 itr2, iterator_type_2 itr2_end,
+                                            T defaultCount, std::size_t numThreads,
+                                            std::random_access_iterator_tag, std::random_access_iterator_tag) {
+#ifdef BOOST_POLYGON_USE_THREADS
+    if(numThreads == 0)
+      numThreads = std::thread::hardware_concurrency();
+    //below some thousands of vertices per thread the threads cost more than they save
+    std::size_t numTiles = (std::min)(4 * numThreads, (std::size_t)((itr1_end - itr1) + (itr2_end - itr2)) / 8192);
+    if(numThreads > 1 && numTiles > 1) {
+      applyBooleanBinaryOpInTiles(output, itr1, itr1_end, itr2, itr2_end, defaultCount, numTiles, numThreads);
+      return;
+    }
+#endif
+    (void)numThreads;
+    applyBooleanBinaryOp(output, itr1, itr1_end, itr2, itr2_end, defaultCount);
+  }
+
+  //inputs that are not random access cannot be cut into tiles
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2,
+            typename category_type_1, typename category_type_2>
+  inline void applyBooleanBinaryOpOnThreads(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                            iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                            iterator_type_2 itr2, iterator_type_2 itr2_end,
+                                            T defaultCount, std::size_t, category_type_1, category_type_2) {
+    applyBooleanBinaryOp(output, itr1, itr1_end, itr2, itr2_end, defaultCount);
+  }
+
+  //applyBooleanBinaryOp on tiles swept on up to numThreads threads (0 means one per hardware
+  //thread) when BOOST_POLYGON_USE_THREADS is defined, the inputs are random access and big
+  //enough, serially otherwise; the output is the same either way
+  template <class T, typename Unit, typename iterator_type_1, typename iterator_type_2>
+  inline void applyBooleanBinaryOpOnThreads(std::vector<std::pair<Unit, std::pair<Unit, int> > >& output,
+                                            iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                            iterator_type_2 itr2, iterator_type_2 itr2_end,
+                                            T defaultCount, std::size_t numThreads) {
+    applyBooleanBinaryOpOnThreads(output, itr1, itr1_end, itr2, itr2_end, defaultCount, numThreads,
+                                  typename std::iterator_traits<iterator_type_1>::iterator_category(),
+                                  typename std::iterator_traits<iterator_type_2>::iterator_category());
+  }
+
+}
+}
+}
+#endif
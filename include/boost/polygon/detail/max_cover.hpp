@@ -7,34 +7,131 @@
 */
 #ifndef BOOST_POLYGON_MAX_COVER_HPP
 #define BOOST_POLYGON_MAX_COVER_HPP
+#include "parallel_for.hpp"
 namespace boost { namespace polygon{
 
+  //number of threads get_max_rectangles may run on, 1 by default and 0 for one per hardware
+  //thread; it only has an effect when BOOST_POLYGON_USE_THREADS is defined
+  inline std::size_t& polygon_max_cover_threads() {
+    static std::size_t threads = 1;
+    return threads;
+  }
+
   template <typename Unit>
   struct MaxCover {
     typedef interval_data<Unit> Interval;
     typedef rectangle_data<Unit> Rectangle;
 
-    class Node {
+    /*
+     * Graph is the DAG of a slicing into rectangles.  Node i is rects[i] and its children are the
+     * rectangles whose leading edge abuts its trailing edge.  The children of all nodes share one
+     * array indexed by node, which computeDag fills in the order of the parents.
+     */
+    class Graph {
     private:
-      std::vector<Node*> children_;
-      std::set<Interval> tracedPaths_;
+      const std::vector<Rectangle>& rects_;
+      std::vector<std::size_t> firstChild_;
+      std::vector<std::size_t> children_;
     public:
-      Rectangle rect;
-      Node() : children_(), tracedPaths_(), rect() {}
-      Node(const Rectangle rectIn) : children_(), tracedPaths_(), rect(rectIn) {}
-      typedef typename std::vector<Node*>::iterator iterator;
-      inline iterator begin() { return children_.begin(); }
-      inline iterator end() { return children_.end(); }
-      inline void add(Node* child) { children_.push_back(child); }
-      inline bool tracedPath(const Interval& ivl) const {
-        return tracedPaths_.find(ivl) != tracedPaths_.end();
+      typedef std::vector<std::size_t>::const_iterator iterator;
+      inline explicit Graph(const std::vector<Rectangle>& rects) : rects_(rects), firstChild_(1, 0), children_() {}
+      inline std::size_t size() const { return rects_.size(); }
+      inline const Rectangle& rect(std::size_t node) const { return rects_[node]; }
+      inline iterator begin(std::size_t node) const { return children_.begin() + firstChild_[node]; }
+      inline iterator end(std::size_t node) const { return children_.begin() + firstChild_[node + 1]; }
+      //edges must be added in the order of their parents and finish called after the last
+      inline void add(std::size_t parent, std::size_t child) {
+        while(firstChild_.size() <= parent) firstChild_.push_back(children_.size());
+        children_.push_back(child);
       }
-      inline void addPath(const Interval& ivl) {
-        tracedPaths_.insert(tracedPaths_.end(), ivl);
+      inline void finish() {
+        while(firstChild_.size() <= rects_.size()) firstChild_.push_back(children_.size());
       }
     };
 
-    typedef std::pair<std::pair<Unit, Interval>, Node* > EdgeAssociation;
+    /*
+     * TracedPaths is the set of the (node, interval) paths traced.  The first LIST_SIZE intervals
+     * traced at a node are a list linked through one array, which is all most nodes ever see.  A
+     * node that more paths reach, a rectangle a comb of others abuts for example, moves them to a
+     * hash table of its own, so the paths of a node stay together in memory either way.  The heads
+     * are indexed by node and may be shared by several TracedPaths over disjoint sets of nodes, as
+     * the tasks over connected components do.
+     */
+    class TracedPaths {
+    private:
+      enum { LIST_SIZE = 8 };
+      struct Entry {
+        Interval ivl;
+        std::size_t next;
+        inline Entry() : ivl(), next(0) {}
+        inline Entry(const Interval& i, std::size_t n) : ivl(i), next(n) {}
+      };
+      //open addressing with linear probing, next is 1 in a used slot
+      struct Table {
+        std::vector<Entry> slots;
+        std::size_t size;
+        inline Table() : slots(), size(0) {}
+      };
+      //0 for no paths, the index one up of the first entry of the list or the table index plus
+      //tableFlag()
+      std::vector<std::size_t>& heads_;
+      std::vector<Entry> entries_;
+      std::vector<Table> tables_;
+      static inline std::size_t tableFlag() { return ((std::numeric_limits<std::size_t>::max)() >> 1) + 1; }
+      static inline std::size_t hash(const Interval& ivl) {
+        std::size_t h = (std::size_t)(polygon_long_long_type)ivl.low() * 2654435761u;
+        h ^= (std::size_t)(polygon_long_long_type)ivl.high() + 0x9e3779b9u + (h << 6) + (h >> 2);
+        return h ^ (h >> 15);
+      }
+      static inline bool place(Table& table, const Interval& ivl) {
+        std::size_t mask = table.slots.size() - 1;
+        for(std::size_t i = hash(ivl) & mask; ; i = (i + 1) & mask) {
+          if(!table.slots[i].next) {
+            table.slots[i] = Entry(ivl, 1);
+            return true;
+          }
+          if(table.slots[i].ivl == ivl)
+            return false;
+        }
+      }
+      static inline bool insertInTable(Table& table, const Interval& ivl) {
+        if(2 * (table.size + 1) > table.slots.size()) {
+          std::vector<Entry> slots(table.slots.empty() ? 4 * LIST_SIZE : table.slots.size() * 2);
+          slots.swap(table.slots);
+          for(std::size_t i = 0; i < slots.size(); ++i)
+            if(slots[i].next) place(table, slots[i].ivl);
+        }
+        if(!place(table, ivl)) return false;
+        ++table.size;
+        return true;
+      }
+      TracedPaths(const TracedPaths&);
+      TracedPaths& operator=(const TracedPaths&);
+    public:
+      //heads must have an element, 0, for every node
+      inline explicit TracedPaths(std::vector<std::size_t>& heads) : heads_(heads), entries_(), tables_() {}
+      //adds the path, returns false if it was traced already
+      inline bool insert(std::size_t node, const Interval& ivl) {
+        if(heads_[node] >= tableFlag())
+          return insertInTable(tables_[heads_[node] - tableFlag()], ivl);
+        std::size_t length = 0;
+        for(std::size_t i = heads_[node]; i; i = entries_[i - 1].next, ++length)
+          if(entries_[i - 1].ivl == ivl) return false;
+        if(length == (std::size_t)LIST_SIZE) {
+          //move the list of the node to a table, its entries stay unused in the array
+          tables_.push_back(Table());
+          for(std::size_t i = heads_[node]; i; i = entries_[i - 1].next)
+            insertInTable(tables_.back(), entries_[i - 1].ivl);
+          heads_[node] = tableFlag() + tables_.size() - 1;
+          return insertInTable(tables_.back(), ivl);
+        }
+        entries_.push_back(Entry(ivl, heads_[node]));
+        heads_[node] = entries_.size();
+        return true;
+      }
+    };
+
+    typedef std::pair<std::pair<Unit, Interval>, std::size_t> EdgeAssociation;
 
     class lessEdgeAssociation : public std::binary_function<const EdgeAssociation&, const EdgeAssociation&, bool> {
     public:
@@ -47,72 +144,73 @@ namespace boost { namespace polygon{
     };
 
     template <class cT>
-    static inline void getMaxCover(cT& outputContainer, Node* node, orientation_2d orient) {
-      Interval rectIvl = node->rect.get(orient);
-      if(node->tracedPath(rectIvl)) {
+    static inline void getMaxCover(cT& outputContainer, const Graph& graph, TracedPaths& traced,
+                                   std::size_t node, orientation_2d orient) {
+      Interval rectIvl = graph.rect(node).get(orient);
+      if(!traced.insert(node, rectIvl)) {
         return;
       }
-      node->addPath(rectIvl);
-      if(node->begin() == node->end()) {
+      if(graph.begin(node) == graph.end(node)) {
         //std::cout << "WRITE OUT 3: " << node->rect << std::endl;
-        outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(node->rect));
+        outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(graph.rect(node)));
         return;
       }
       bool writeOut = true;
-      for(typename Node::iterator itr = node->begin(); itr != node->end(); ++itr) {
-        getMaxCover(outputContainer, *itr, orient, node->rect); //get rectangles down path
-        Interval nodeIvl = (*itr)->rect.get(orient);
+      for(typename Graph::iterator itr = graph.begin(node); itr != graph.end(node); ++itr) {
+        getMaxCover(outputContainer, graph, traced, *itr, orient, graph.rect(node)); //get rectangles down path
+        Interval nodeIvl = graph.rect(*itr).get(orient);
         if(contains(nodeIvl, rectIvl, true)) writeOut = false;
       }
       if(writeOut) {
         //std::cout << "WRITE OUT 2: " << node->rect << std::endl;
-        outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(node->rect));
+        outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(graph.rect(node)));
       }
     }
 
     struct stack_element {
       inline stack_element() :
         node(), rect(), itr() {}
-      inline stack_element(Node* n,
+      inline stack_element(std::size_t n,
                            const Rectangle& r,
-                           typename Node::iterator i) :
+                           typename Graph::iterator i) :
         node(n), rect(r), itr(i) {}
-      Node* node;
+      std::size_t node;
       Rectangle rect;
-      typename Node::iterator itr;
+      typename Graph::iterator itr;
     };
 
     template <class cT>
-    static inline void getMaxCover(cT& outputContainer, Node* node, orientation_2d orient,
-                                   Rectangle rect) {
+    static inline void getMaxCover(cT& outputContainer, const Graph& graph, TracedPaths& traced,
+                                   std::size_t node, orientation_2d orient, Rectangle rect) {
       //std::cout << "New Root\n";
       std::vector<stack_element> stack;
-      typename Node::iterator itr = node->begin();
+      typename Graph::iterator itr = graph.begin(node);
       do {
         //std::cout << "LOOP\n";
         //std::cout << node->rect << std::endl;
+        const Rectangle& nodeRect = graph.rect(node);
         Interval rectIvl = rect.get(orient);
-        Interval nodeIvl = node->rect.get(orient);
+        Interval nodeIvl = nodeRect.get(orient);
         bool iresult = intersect(rectIvl, nodeIvl, false);
-        bool tresult = !node->tracedPath(rectIvl);
+        //the path is traced here only if it reaches the node
+        bool tresult = iresult && traced.insert(node, rectIvl);
         //std::cout << (itr != node->end()) << " " << iresult << " " << tresult << std::endl;
         Rectangle nextRect1 = Rectangle(rectIvl, rectIvl);
         Unit low = rect.get(orient.get_perpendicular()).low();
-        Unit high = node->rect.get(orient.get_perpendicular()).high();
+        Unit high = nodeRect.get(orient.get_perpendicular()).high();
         nextRect1.set(orient.get_perpendicular(), Interval(low, high));
-        if(iresult && tresult) {
-          node->addPath(rectIvl);
+        if(tresult) {
           bool writeOut = true;
           //check further visibility beyond this node
-          for(typename Node::iterator itr2 = node->begin(); itr2 != node->end(); ++itr2) {
-            Interval nodeIvl3 = (*itr2)->rect.get(orient);
+          for(typename Graph::iterator itr2 = graph.begin(node); itr2 != graph.end(node); ++itr2) {
+            Interval nodeIvl3 = graph.rect(*itr2).get(orient);
             //if a child of this node can contain the interval then we can extend through
             if(contains(nodeIvl3, rectIvl, true)) writeOut = false;
             //std::cout << "child " << (*itr2)->rect << std::endl;
           }
           Rectangle nextRect2 = Rectangle(rectIvl, rectIvl);
           Unit low2 = rect.get(orient.get_perpendicular()).low();
-          Unit high2 = node->rect.get(orient.get_perpendicular()).high();
+          Unit high2 = nodeRect.get(orient.get_perpendicular()).high();
           nextRect2.set(orient.get_perpendicular(), Interval(low2, high2));
           if(writeOut) {
             //std::cout << "write out " << nextRect << std::endl;
@@ -121,12 +219,12 @@ namespace boost { namespace polygon{
             //std::cout << "suppress " << nextRect << std::endl;
           }
         }
-        if(itr != node->end() && iresult && tresult) {
+        if(itr != graph.end(node) && tresult) {
           //std::cout << "recurse into child\n";
           stack.push_back(stack_element(node, rect, itr));
           rect = nextRect1;
           node = *itr;
-          itr = node->begin();
+          itr = graph.begin(node);
         } else {
           if(!stack.empty()) {
             //std::cout << "recurse out of child\n";
@@ -144,82 +242,78 @@ namespace boost { namespace polygon{
 //             outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(nextRect));
           }
           //std::cout << "increment " << (itr != node->end()) << std::endl;
-          if(itr != node->end()) {
+          if(itr != graph.end(node)) {
             ++itr;
-            if(itr != node->end()) {
+            if(itr != graph.end(node)) {
               //std::cout << "recurse into next child.\n";
               stack.push_back(stack_element(node, rect, itr));
               Interval rectIvl2 = rect.get(orient);
-              Interval nodeIvl2 = node->rect.get(orient);
+              Interval nodeIvl2 = graph.rect(node).get(orient);
               /*bool iresult =*/ intersect(rectIvl2, nodeIvl2, false);
               Rectangle nextRect2 = Rectangle(rectIvl2, rectIvl2);
               Unit low2 = rect.get(orient.get_perpendicular()).low();
-              Unit high2 = node->rect.get(orient.get_perpendicular()).high();
+              Unit high2 = graph.rect(node).get(orient.get_perpendicular()).high();
               nextRect2.set(orient.get_perpendicular(), Interval(low2, high2));
               rect = nextRect2;
               //std::cout << "rect for next child" << rect << std::endl;
               node = *itr;
-              itr = node->begin();
+              itr = graph.begin(node);
             }
           }
         }
-      } while(!stack.empty() || itr != node->end());
+      } while(!stack.empty() || itr != graph.end(node));
     }
 
     /*  Function recursive version of getMaxCover
         Because the code is so much simpler than the loop algorithm I retain it for clarity
 
     template <class cT>
-    static inline void getMaxCover(cT& outputContainer, Node* node, orientation_2d orient,
-                                   const Rectangle& rect) {
+    static inline void getMaxCover(cT& outputContainer, const Graph& graph, TracedPaths& traced,
+                                   std::size_t node, orientation_2d orient, const Rectangle& rect) {
       Interval rectIvl = rect.get(orient);
-      Interval nodeIvl = node->rect.get(orient);
+      Interval nodeIvl = graph.rect(node).get(orient);
       if(!intersect(rectIvl, nodeIvl, false)) {
         return;
       }
-      if(node->tracedPath(rectIvl)) {
+      if(!traced.insert(node, rectIvl)) {
         return;
       }
-      node->addPath(rectIvl);
       Rectangle nextRect(rectIvl, rectIvl);
       Unit low = rect.get(orient.get_perpendicular()).low();
-      Unit high = node->rect.get(orient.get_perpendicular()).high();
+      Unit high = graph.rect(node).get(orient.get_perpendicular()).high();
       nextRect.set(orient.get_perpendicular(), Interval(low, high));
       bool writeOut = true;
       rectIvl = nextRect.get(orient);
-      for(typename Node::iterator itr = node->begin(); itr != node->end(); ++itr) {
-        nodeIvl = (*itr)->rect.get(orient);
+      for(typename Graph::iterator itr = graph.begin(node); itr != graph.end(node); ++itr) {
+        nodeIvl = graph.rect(*itr).get(orient);
         if(contains(nodeIvl, rectIvl, true)) writeOut = false;
       }
       if(writeOut) {
         outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(nextRect));
       }
-      for(typename Node::iterator itr = node->begin(); itr != node->end(); ++itr) {
-        getMaxCover(outputContainer, *itr, orient, nextRect);
+      for(typename Graph::iterator itr = graph.begin(node); itr != graph.end(node); ++itr) {
+        getMaxCover(outputContainer, graph, traced, *itr, orient, nextRect);
       }
     }
     */
 
-    //iterator range is assummed to be in topological order meaning all node's trailing
-    //edges are in sorted order
-    template <class iT>
-    static inline void computeDag(iT beginNode, iT endNode, orientation_2d orient,
-                                  std::size_t size) {
+    //the rectangles of the graph are assummed to be in topological order meaning all node's
+    //trailing edges are in sorted order
+    static inline void computeDag(Graph& graph, orientation_2d orient) {
       std::vector<EdgeAssociation> leadingEdges;
-      leadingEdges.reserve(size);
-      for(iT iter = beginNode; iter != endNode; ++iter) {
-        Node* nodep = &(*iter);
-        Unit leading = nodep->rect.get(orient.get_perpendicular()).low();
-        Interval rectIvl = nodep->rect.get(orient);
-        leadingEdges.push_back(EdgeAssociation(std::pair<Unit, Interval>(leading, rectIvl), nodep));
+      leadingEdges.reserve(graph.size());
+      for(std::size_t node = 0; node < graph.size(); ++node) {
+        Unit leading = graph.rect(node).get(orient.get_perpendicular()).low();
+        Interval rectIvl = graph.rect(node).get(orient);
+        leadingEdges.push_back(EdgeAssociation(std::pair<Unit, Interval>(leading, rectIvl), node));
       }
       polygon_sort(leadingEdges.begin(), leadingEdges.end(), lessEdgeAssociation());
       typename std::vector<EdgeAssociation>::iterator leadingBegin = leadingEdges.begin();
-      iT trailingBegin = beginNode;
+      std::size_t trailingBegin = 0;
       while(leadingBegin != leadingEdges.end()) {
         EdgeAssociation& leadingSegment = (*leadingBegin);
-        Unit trailing = (*trailingBegin).rect.get(orient.get_perpendicular()).high();
-        Interval ivl = (*trailingBegin).rect.get(orient);
+        Unit trailing = graph.rect(trailingBegin).get(orient.get_perpendicular()).high();
+        Interval ivl = graph.rect(trailingBegin).get(orient);
         std::pair<Unit, Interval> trailingSegment(trailing, ivl);
         if(leadingSegment.first.first < trailingSegment.first) {
           ++leadingBegin;
@@ -238,7 +332,7 @@ namespace boost { namespace polygon{
           continue;
         }
         //leading segment intersects trailing segment
-        (*trailingBegin).add((*leadingBegin).second);
+        graph.add(trailingBegin, (*leadingBegin).second);
         if(leadingSegment.first.second.high() > trailingSegment.second.high()) {
           ++trailingBegin;
           continue;
@@ -250,24 +344,116 @@ namespace boost { namespace polygon{
         ++leadingBegin;
         ++trailingBegin;
       }
+      graph.finish();
+    }
+
+    /*
+     * ComponentTask runs getMaxCover from every node of a run of connected components of the
+     * graph into an output of its own, and records where the rectangles of each node start and
+     * end in it.  Paths never leave a component, so components have nothing to share and the
+     * tasks of parallel_for may take them in any order.
+     */
+    class ComponentTask {
+    private:
+      const Graph& graph_;
+      const std::vector<std::size_t>& nodes_;
+      const std::vector<std::size_t>& runs_;
+      orientation_2d orient_;
+      std::vector<std::size_t>& heads_;
+      std::vector<std::vector<Rectangle> >& outputs_;
+      std::vector<std::pair<std::size_t, std::size_t> >& spans_;
+    public:
+      inline ComponentTask(const Graph& graph, const std::vector<std::size_t>& nodes,
+                           const std::vector<std::size_t>& runs, orientation_2d orient,
+                           std::vector<std::size_t>& heads, std::vector<std::vector<Rectangle> >& outputs,
+                           std::vector<std::pair<std::size_t, std::size_t> >& spans) :
+        graph_(graph), nodes_(nodes), runs_(runs), orient_(orient), heads_(heads), outputs_(outputs),
+        spans_(spans) {}
+      inline void operator()(std::size_t run) {
+        TracedPaths traced(heads_);
+        for(std::size_t i = runs_[run]; i < runs_[run + 1]; ++i) {
+          std::size_t begin = outputs_[run].size();
+          getMaxCover(outputs_[run], graph_, traced, nodes_[i], orient_);
+          spans_[nodes_[i]] = std::make_pair(begin, outputs_[run].size());
+        }
+      }
+    };
+
+    //the nodes grouped by connected component, the components in order of their first node, cut
+    //into runs of about runSize nodes that do not split a component
+    static inline void componentRuns(std::vector<std::size_t>& nodes, std::vector<std::size_t>& runs,
+                                     const Graph& graph, std::size_t runSize) {
+      std::vector<std::size_t> parent(graph.size());
+      for(std::size_t node = 0; node < graph.size(); ++node) parent[node] = node;
+      for(std::size_t node = 0; node < graph.size(); ++node) {
+        for(typename Graph::iterator itr = graph.begin(node); itr != graph.end(node); ++itr) {
+          std::size_t a = findRoot(parent, node), b = findRoot(parent, *itr);
+          if(a < b) parent[b] = a;
+          else parent[a] = b;
+        }
+      }
+      //the root of a component is its first node, count the nodes of each to place them
+      std::vector<std::size_t> first(graph.size() + 1, 0);
+      for(std::size_t node = 0; node < graph.size(); ++node) ++first[findRoot(parent, node) + 1];
+      for(std::size_t node = 0; node < graph.size(); ++node) first[node + 1] += first[node];
+      nodes.resize(graph.size());
+      runs.assign(1, 0);
+      for(std::size_t node = 0; node < graph.size(); ++node) {
+        std::size_t root = findRoot(parent, node);
+        if(root == node && first[node] - runs.back() >= runSize) runs.push_back(first[node]);
+        nodes[first[root]++] = node;
+      }
+      runs.push_back(graph.size());
+    }
+
+    static inline std::size_t findRoot(std::vector<std::size_t>& parent, std::size_t node) {
+      while(parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+      }
+      return node;
     }
 
     template <class cT>
     static inline void getMaxCover(cT& outputContainer,
                                    const std::vector<Rectangle>& rects, orientation_2d orient) {
       if(rects.empty()) return;
-      std::vector<Node> nodes;
-      {
-        if(rects.size() == 1) {
-          outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(rects[0]));
-          return;
+      if(rects.size() == 1) {
+        outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(rects[0]));
+        return;
+      }
+      Graph graph(rects);
+      computeDag(graph, orient);
+      std::size_t numThreads = polygon_max_cover_threads();
+#ifdef BOOST_POLYGON_USE_THREADS
+      if(numThreads == 0)
+        numThreads = std::thread::hardware_concurrency();
+#endif
+      if(numThreads < 2 || rects.size() < 4096) {
+        std::vector<std::size_t> heads(graph.size(), 0);
+        TracedPaths traced(heads);
+        for(std::size_t node = 0; node < graph.size(); ++node) {
+          getMaxCover(outputContainer, graph, traced, node, orient);
         }
-        nodes.reserve(rects.size());
-        for(std::size_t i = 0; i < rects.size(); ++i) { nodes.push_back(Node(rects[i])); }
+        return;
+      }
+      std::vector<std::size_t> nodes, runs;
+      componentRuns(nodes, runs, graph, rects.size() / (8 * numThreads) + 1);
+      std::vector<std::size_t> heads(graph.size(), 0);
+      std::vector<std::vector<Rectangle> > outputs(runs.size() - 1);
+      std::vector<std::pair<std::size_t, std::size_t> > spans(graph.size());
+      ComponentTask task(graph, nodes, runs, orient, heads, outputs, spans);
+      parallel_for(outputs.size(), numThreads, task);
+      //the rectangles of each node, in node order, give the same output as the serial path
+      std::vector<std::size_t> runOf(graph.size());
+      for(std::size_t run = 0; run < outputs.size(); ++run) {
+        for(std::size_t i = runs[run]; i < runs[run + 1]; ++i)
+          runOf[nodes[i]] = run;
       }
-      computeDag(nodes.begin(), nodes.end(), orient, nodes.size());
-      for(std::size_t i = 0; i < nodes.size(); ++i) {
-        getMaxCover(outputContainer, &(nodes[i]), orient);
+      for(std::size_t node = 0; node < graph.size(); ++node) {
+        const std::vector<Rectangle>& output = outputs[runOf[node]];
+        for(std::size_t i = spans[node].first; i < spans[node].second; ++i)
+          outputContainer.push_back(copy_construct<typename cT::value_type, Rectangle>(output[i]));
       }
     }
 
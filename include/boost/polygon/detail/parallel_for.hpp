@@ -0,0 +1,82 @@
+/*
+    Copyright 2008 Intel Corporation
+
+    Use, modification and distribution are subject to the Boost Software License,
+    Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+    http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_PARALLEL_FOR_HPP
+#define BOOST_POLYGON_PARALLEL_FOR_HPP
+#include <cstddef>
+#ifdef BOOST_POLYGON_USE_THREADS
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+#endif
+namespace boost { namespace polygon {
+
+#ifdef BOOST_POLYGON_USE_THREADS
+  //pulls task indices from a shared counter until they run out, the first exception thrown by a
+  //task is kept and rethrown on the calling thread
+  template <typename task_type>
+  class ParallelForWorker {
+  private:
+    task_type& task_;
+    std::size_t count_;
+    std::atomic<std::size_t>& next_;
+    std::exception_ptr& error_;
+  public:
+    inline ParallelForWorker(task_type& task, std::size_t count, std::atomic<std::size_t>& next,
+                             std::exception_ptr& error) :
+      task_(task), count_(count), next_(next), error_(error) {}
+    inline void operator()() {
+      try {
+        for(std::size_t i = next_++; i < count_; i = next_++)
+          task_(i);
+      } catch(...) {
+        error_ = std::current_exception();
+        next_ = count_;
+      }
+    }
+  };
+#endif
+
+  //calls task(i) for every i in [0, count), on up to numThreads threads (0 means one per hardware
+  //thread) when BOOST_POLYGON_USE_THREADS is defined and <thread> is available, otherwise in order
+  //on the calling thread; calls for different i must be independent
+  template <typename task_type>
+  inline void parallel_for(std::size_t count, std::size_t numThreads, task_type& task) {
+#ifdef BOOST_POLYGON_USE_THREADS
+    if(numThreads == 0)
+      numThreads = std::thread::hardware_concurrency();
+    if(numThreads > count)
+      numThreads = count;
+    if(numThreads > 1) {
+      std::atomic<std::size_t> next(0);
+      std::vector<std::exception_ptr> errors(numThreads);
+      std::vector<std::thread> threads;
+      threads.reserve(numThreads - 1);
+      //a thread that cannot be started is not an error, the threads already running and the
+      //calling thread pull the tasks it would have run
+      try {
+        for(std::size_t t = 1; t < numThreads; ++t)
+          threads.push_back(std::thread(ParallelForWorker<task_type>(task, count, next, errors[t])));
+      } catch(...) {}
+      ParallelForWorker<task_type>(task, count, next, errors[0])();
+      for(std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+      for(std::size_t t = 0; t < numThreads; ++t)
+        if(errors[t])
+          std::rethrow_exception(errors[t]);
+      return;
+    }
+#endif
+    (void)numThreads;
+    for(std::size_t i = 0; i < count; ++i)
+      task(i);
+  }
+
+}
+}
+#endif
@@ -36,26 +36,29 @@ namespace boost { namespace polygon{
       typedef typename std::list<Point>::const_iterator iterator;
 
       // default constructor of point does not initialize x and y
-      inline PolyLine45() : points() {} //do nothing default constructor
+      inline PolyLine45() : points(), numPoints(0) {} //do nothing default constructor
 
       // initialize a polygon from x,y values, it is assumed that the first is an x
       // and that the input is a well behaved polygon
       template<class iT>
       inline PolyLine45& set(iT inputBegin, iT inputEnd) {
         points.clear();  //just in case there was some old data there
+        numPoints = 0;
         while(inputBegin != inputEnd) {
           points.insert(points.end(), *inputBegin);
+          ++numPoints;
           ++inputBegin;
         }
         return *this;
       }
 
       // copy constructor (since we have dynamic memory)
-      inline PolyLine45(const PolyLine45& that) : points(that.points) {}
+      inline PolyLine45(const PolyLine45& that) : points(that.points), numPoints(that.numPoints) {}
 
       // assignment operator (since we have dynamic memory do a deep copy)
       inline PolyLine45& operator=(const PolyLine45& that) {
         points = that.points;
+        numPoints = that.numPoints;
         return *this;
       }
 
@@ -65,10 +68,12 @@ namespace boost { namespace polygon{
       // get end iterator, returns a pointer to a const Unit
       inline iterator end() const { return points.end(); }
 
-      inline std::size_t size() const { return points.size(); }
+      inline std::size_t size() const { return numPoints; }
 
       //public data member
       std::list<Point> points;
+      //points.size(), counted here since std::list::size may walk the list
+      std::size_t numPoints;
     };
 
     class ActiveTail45 {
@@ -77,6 +82,7 @@ namespace boost { namespace polygon{
       PolyLine45* tailp_;
       ActiveTail45 *otherTailp_;
       std::list<ActiveTail45*> holesList_;
+      std::size_t holePoints_;
       bool head_;
     public:
 
@@ -91,13 +97,14 @@ namespace boost { namespace polygon{
       typedef typename std::list<ActiveTail45*>::const_iterator iteratorHoles;
 
       //default constructor
-      inline ActiveTail45() : tailp_(0), otherTailp_(0), holesList_(), head_(0) {}
+      inline ActiveTail45() : tailp_(0), otherTailp_(0), holesList_(), holePoints_(0), head_(0) {}
 
       //constructor
       inline ActiveTail45(const Vertex45& vertex, ActiveTail45* otherTailp = 0) :
-        tailp_(0), otherTailp_(0), holesList_(), head_(0) {
+        tailp_(0), otherTailp_(0), holesList_(), holePoints_(0), head_(0) {
         tailp_ = new PolyLine45;
         tailp_->points.push_back(vertex.pt);
+        tailp_->numPoints = 1;
         bool headArray[4] = {false, true, true, true};
         bool inverted = vertex.count == -1;
         head_ = headArray[vertex.rise+1] ^ inverted;
@@ -105,22 +112,23 @@ namespace boost { namespace polygon{
       }
 
       inline ActiveTail45(Point point, ActiveTail45* otherTailp, bool head = true) :
-        tailp_(0), otherTailp_(0), holesList_(), head_(0) {
+        tailp_(0), otherTailp_(0), holesList_(), holePoints_(0), head_(0) {
         tailp_ = new PolyLine45;
         tailp_->points.push_back(point);
+        tailp_->numPoints = 1;
         head_ = head;
         otherTailp_ = otherTailp;
 
       }
       inline ActiveTail45(ActiveTail45* otherTailp) :
-        tailp_(0), otherTailp_(0), holesList_(), head_(0)  {
+        tailp_(0), otherTailp_(0), holesList_(), holePoints_(0), head_(0)  {
         tailp_ = otherTailp->tailp_;
         otherTailp_ = otherTailp;
       }
 
       //copy constructor
       inline ActiveTail45(const ActiveTail45& that) :
-        tailp_(0), otherTailp_(0), holesList_(), head_(0)  { (*this) = that; }
+        tailp_(0), otherTailp_(0), holesList_(), holePoints_(0), head_(0)  { (*this) = that; }
 
       //destructor
       inline ~ActiveTail45() {
@@ -133,6 +141,7 @@ namespace boost { namespace polygon{
         head_ = that.head_;
         otherTailp_ = that.otherTailp_;
         holesList_ = that.holesList_;
+        holePoints_ = that.holePoints_;
         return *this;
       }
 
@@ -190,6 +199,7 @@ namespace boost { namespace polygon{
         PolyLine45* tail2 = tail->tailp_;
         if(head_) std::swap(tail1, tail2);
         tail1->points.splice(tail1->points.end(), tail2->points);
+        tail1->numPoints += tail2->numPoints;
         delete tail2;
         otherTailp_->tailp_ = tail1;
         tail->otherTailp_->tailp_ = tail1;
@@ -207,6 +217,7 @@ namespace boost { namespace polygon{
        */
       inline ActiveTail45* addHole(ActiveTail45* hole) {
         holesList_.push_back(hole);
+        holePoints_ += hole->tailp_->numPoints;
         copyHoles(*hole);
         copyHoles(*(hole->otherTailp_));
         return this;
@@ -220,7 +231,16 @@ namespace boost { namespace polygon{
       /**
        * @brief copy holes from that to this
        */
-      inline void copyHoles(ActiveTail45& that) { holesList_.splice(holesList_.end(), that.holesList_); }
+      inline void copyHoles(ActiveTail45& that) {
+        holesList_.splice(holesList_.end(), that.holesList_);
+        holePoints_ += that.holePoints_;
+        that.holePoints_ = 0;
+      }
+
+      /**
+       * @brief get the number of points of the holes in the list of holes
+       */
+      inline std::size_t getHolePoints() const { return holePoints_; }
 
       /**
        * @brief find out if solid to right
@@ -248,6 +268,7 @@ namespace boost { namespace polygon{
           typename std::list<Point>::iterator iter = tailp_->points.begin();
           if(iter == tailp_->points.end()) {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
             return;
           }
           Unit firstY = (*iter).y();
@@ -255,6 +276,7 @@ namespace boost { namespace polygon{
           ++iter;
           if(iter == tailp_->points.end()) {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
             return;
           }
           if((iter->y() == point.y() && firstY == point.y()) ||
@@ -263,6 +285,7 @@ namespace boost { namespace polygon{
             *iter = point;
           } else {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
           }
           return;
         }
@@ -273,6 +296,7 @@ namespace boost { namespace polygon{
         typename std::list<Point>::reverse_iterator iter = tailp_->points.rbegin();
         if(iter == tailp_->points.rend()) {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
           return;
         }
         Unit firstY = (*iter).y();
@@ -280,6 +304,7 @@ namespace boost { namespace polygon{
         ++iter;
         if(iter == tailp_->points.rend()) {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
           return;
         }
         if((iter->y() == point.y() && firstY == point.y()) ||
@@ -288,6 +313,7 @@ namespace boost { namespace polygon{
           *iter = point;
         } else {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
         }
       }
 
@@ -305,6 +331,13 @@ namespace boost { namespace polygon{
           //we are closing a figure
           at1->pushPoint(point);
           at2->pushPoint(point);
+          if(solid && at1->tailp_->size() < 4) {
+            //the figure has no area, it was begun with vertical edges by a cut at this x and
+            //ends with them
+            delete at1->otherTailp_;
+            delete at1;
+            return 0;
+          }
           if(solid) {
             //we are closing a solid figure, write to output
             //std::cout << "test1\n";
@@ -364,6 +397,7 @@ namespace boost { namespace polygon{
           (*itr) = 0;
         }
         holesList_.clear();
+        holePoints_ = 0;
       }
 
 //       inline void print() {
@@ -536,32 +570,55 @@ namespace boost { namespace polygon{
       typedef std::map<Vertex45, ActiveTail45*, lessVertex45> Polygon45FormationData;
       typedef typename Polygon45FormationData::iterator iterator;
       typedef typename Polygon45FormationData::const_iterator const_iterator;
+      typedef std::map<ActiveTail45*, iterator> TailIterators;
 
       //data
       Polygon45FormationData scanData_;
       Unit x_;
       int justBefore_;
       int fractureHoles_;
+      std::size_t vertexThreshold_;
+      //only kept with a vertex threshold: where each active tail is in scanData_ and the active
+      //tails put in scanData_ at the last stop
+      TailIterators tailIters_;
+      std::vector<ActiveTail45*> touched_;
     public:
-      inline Polygon45Formation() : scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0) {
+      inline Polygon45Formation() : scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0),
+                                    vertexThreshold_((std::numeric_limits<std::size_t>::max)()), tailIters_(), touched_() {
+        lessVertex45 lessElm(&x_, &justBefore_);
+        scanData_ = Polygon45FormationData(lessElm);
+      }
+      inline Polygon45Formation(bool fractureHoles) : scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles),
+                                                      vertexThreshold_((std::numeric_limits<std::size_t>::max)()), tailIters_(), touched_() {
         lessVertex45 lessElm(&x_, &justBefore_);
         scanData_ = Polygon45FormationData(lessElm);
       }
-      inline Polygon45Formation(bool fractureHoles) : scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles) {
+      //a figure that reaches vertexThreshold points, the points of its holes included, is closed with
+      //vertical edges at the next stop and begun again from those edges, so that no figure keeps
+      //growing while it is open
+      inline Polygon45Formation(bool fractureHoles, std::size_t vertexThreshold) :
+        scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles),
+        vertexThreshold_(vertexThreshold), tailIters_(), touched_() {
         lessVertex45 lessElm(&x_, &justBefore_);
         scanData_ = Polygon45FormationData(lessElm);
       }
       inline Polygon45Formation(const Polygon45Formation& that) :
-        scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0) { (*this) = that; }
+        scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0),
+        vertexThreshold_((std::numeric_limits<std::size_t>::max)()), tailIters_(), touched_() { (*this) = that; }
       inline Polygon45Formation& operator=(const Polygon45Formation& that) {
         x_ = that.x_;
         justBefore_ = that.justBefore_;
         fractureHoles_ = that.fractureHoles_;
+        vertexThreshold_ = that.vertexThreshold_;
         lessVertex45 lessElm(&x_, &justBefore_);
         scanData_ = Polygon45FormationData(lessElm);
+        tailIters_.clear();
         for(const_iterator itr = that.scanData_.begin(); itr != that.scanData_.end(); ++itr){
-          scanData_.insert(scanData_.end(), *itr);
+          iterator inserted = scanData_.insert(scanData_.end(), *itr);
+          if(bounded_())
+            tailIters_[inserted->second] = inserted;
         }
+        touched_ = that.touched_;
         return *this;
       }
 
@@ -584,6 +641,99 @@ namespace boost { namespace polygon{
 
     private:
       //functions
+      inline bool bounded_() const { return vertexThreshold_ != (std::numeric_limits<std::size_t>::max)(); }
+
+      //the element of the scanline at the other side of the solid interval of itr, the solid
+      //is above an element of count 1 and below an element of count -1
+      inline bool solidPartner_(iterator itr, iterator& partner) {
+        partner = itr;
+        if(itr->first.count == 1) {
+          ++partner;
+          return partner != scanData_.end() && partner->first.count == -1;
+        }
+        if(itr == scanData_.begin()) return false;
+        --partner;
+        return partner->first.count == 1;
+      }
+
+      //an element that meets a neighbour at x_ ends at this stop with it, a vertical edge
+      //through their common point would touch the figure to itself
+      inline bool meetsNeighbour_(iterator itr) {
+        Unit y = itr->first.evalAtX(x_);
+        iterator next = itr;
+        ++next;
+        if(next != scanData_.end() && next->first.evalAtX(x_) == y) return true;
+        if(itr == scanData_.begin()) return false;
+        --itr;
+        return itr->first.evalAtX(x_) == y;
+      }
+
+      //a figure is open on the scanline as a cycle of chains, each solid interval joining the
+      //ends of two of them: one chain for a simple figure, more when it wraps around empty space
+      //that is still open; every figure touched at the last stop whose cycle has reached
+      //vertexThreshold_ points is cut here, before the events at x_ are applied
+      template <class cT>
+      inline void cutFigures_(cT& output) {
+        std::set<ActiveTail45*> visited;
+        std::vector<iterator> cycle;
+        for(std::size_t i = 0; i < touched_.size(); ++i) {
+          typename TailIterators::iterator found = tailIters_.find(touched_[i]);
+          if(found == tailIters_.end() || visited.find(touched_[i]) != visited.end()) continue;
+          cycle.clear();
+          //the ring is written out with its first point repeated
+          std::size_t points = 1;
+          bool cut = true;
+          iterator itr = found->second;
+          do {
+            iterator partner;
+            if(!solidPartner_(itr, partner) || meetsNeighbour_(itr) || meetsNeighbour_(partner)) {
+              cut = false;
+              break;
+            }
+            cycle.push_back(itr);
+            cycle.push_back(partner);
+            visited.insert(itr->second);
+            visited.insert(partner->second);
+            ActiveTail45* otherTail = partner->second->getOtherActiveTail();
+            points += partner->second->getTail()->size() + partner->second->getHolePoints() +
+              otherTail->getHolePoints() + 2;
+            found = tailIters_.find(otherTail);
+            if(found == tailIters_.end()) {
+              cut = false;
+              break;
+            }
+            itr = found->second;
+          } while(itr != cycle.front() && cycle.size() <= scanData_.size());
+          if(cut && itr == cycle.front() && points >= vertexThreshold_)
+            cutFigure_(output, cycle);
+        }
+        touched_.clear();
+      }
+
+      //closes the figure with a vertical edge at x_ across each of its solid intervals, the last
+      //one writes it out, and begins a new figure from each of those edges
+      template <class cT>
+      inline void cutFigure_(cT& output, const std::vector<iterator>& cycle) {
+        for(std::size_t i = 0; i < cycle.size(); i += 2) {
+          iterator lower = cycle[i];
+          iterator upper = cycle[i + 1];
+          if(lower->first.count != 1) std::swap(lower, upper);
+          Point lowPoint(x_, lower->first.evalAtX(x_));
+          Point highPoint(x_, upper->first.evalAtX(x_));
+          tailIters_.erase(lower->second);
+          tailIters_.erase(upper->second);
+          upper->second->pushPoint(highPoint);
+          ActiveTail45::joinChains(lowPoint, lower->second, upper->second, true, output);
+          std::pair<ActiveTail45*, ActiveTail45*> tailPair =
+            ActiveTail45::createActiveTail45sAsPair(lowPoint, true, 0, false);
+          tailPair.first->pushPoint(highPoint);
+          lower->second = tailPair.second;
+          upper->second = tailPair.first;
+          tailIters_[lower->second] = lower;
+          tailIters_[upper->second] = upper;
+        }
+      }
+
       template <class cT, class cT2>
       inline std::pair<int, ActiveTail45*> processPoint_(cT& output, cT2& elements, Point point,
                                                          Vertex45Count& counts, ActiveTail45** tails, Vertex45Count& incoming) {
@@ -777,6 +927,8 @@ namespace boost { namespace polygon{
       inline iT processEvent_(cT& output, iT inputBegin, iT inputEnd) {
         //std::cout << "processEvent_\n";
         justBefore_ = true;
+        if(bounded_())
+          cutFigures_(output);
         //collect up all elements from the tree that are at the y
         //values of events in the input queue
         //create vector of new elements to add into tree
@@ -852,12 +1004,19 @@ namespace boost { namespace polygon{
                 iter->second = verticalTail->getOtherActiveTail();
                 at->pushPoint(point);
                 verticalTail->join(at);
+                if(bounded_()) {
+                  tailIters_.erase(at);
+                  tailIters_[iter->second] = iter;
+                  touched_.push_back(iter->second);
+                }
                 delete at;
                 delete verticalTail;
                 verticalTail = 0;
               } else {
                 //std::cout << "push hole onto list\n";
                 iter->second->addHole(verticalTail);
+                if(bounded_())
+                  touched_.push_back(iter->second);
                 verticalTail = 0;
               }
             }
@@ -868,6 +1027,12 @@ namespace boost { namespace polygon{
         for(typename std::vector<iterator>::iterator iter = elementIters.begin();
             iter != elementIters.end(); ++iter) {
           //std::cout << "erasing loop\n";
+          if(bounded_()) {
+            //the active tail may have moved on to another element at this stop
+            typename TailIterators::iterator found = tailIters_.find((*iter)->second);
+            if(found != tailIters_.end() && found->second == *iter)
+              tailIters_.erase(found);
+          }
           scanData_.erase(*iter);
         }
         //switch comparison tie breaking policy
@@ -877,7 +1042,11 @@ namespace boost { namespace polygon{
         for(typename std::vector<std::pair<Vertex45, ActiveTail45*> >::iterator iter = elements.begin();
             iter != elements.end(); ++iter) {
           //std::cout << "inserting loop\n";
-          scanData_.insert(scanData_.end(), *iter);
+          iterator inserted = scanData_.insert(scanData_.end(), *iter);
+          if(bounded_()) {
+            tailIters_[inserted->second] = inserted;
+            touched_.push_back(inserted->second);
+          }
         }
         //std::cout << "end processEvent\n";
         return currentIter;
@@ -0,0 +1,131 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_90_COMPACT_DATA_HPP
+#define BOOST_POLYGON_POLYGON_90_COMPACT_DATA_HPP
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+namespace boost { namespace polygon{
+
+  //Packed storage for the clean vertex data of a polygon_90_set_data.  A clean set only has
+  //counts of +1 and -1, so instead of a (major, (minor, count)) pair per vertex, which is 12
+  //bytes for int, the majors and the minors are kept in two arrays and the signs of the
+  //counts in a bit vector alongside, 8 bytes and a bit per vertex for int.  The iterator
+  //hands out the vertices as the pairs of the unpacked layout, by value, so that the scanline
+  //algorithms run on the packed data as they do on the vector.
+  template <typename T>
+  class polygon_90_compact_data {
+  public:
+    typedef T coordinate_type;
+    typedef std::pair<coordinate_type, std::pair<coordinate_type, int> > vertex_type;
+
+    class iterator {
+    private:
+      const polygon_90_compact_data* data_;
+      std::size_t index_;
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef vertex_type value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const vertex_type* pointer; //immutable
+      typedef vertex_type reference; //by value, there is no vertex_type in the storage to refer to
+
+      inline iterator() : data_(0), index_(0) {}
+      inline iterator(const polygon_90_compact_data* data, std::size_t index) : data_(data), index_(index) {}
+      //use bitwise copy and assign provided by the compiler
+      inline vertex_type operator*() const {
+        return vertex_type(data_->majors_[index_],
+                           std::pair<coordinate_type, int>(data_->minors_[index_],
+                                                           data_->negative_[index_] ? -1 : 1));
+      }
+      inline vertex_type operator[](difference_type n) const { return *(*this + n); }
+      inline iterator& operator++() { ++index_; return *this; }
+      inline iterator operator++(int) { iterator tmp(*this); ++index_; return tmp; }
+      inline iterator& operator--() { --index_; return *this; }
+      inline iterator operator--(int) { iterator tmp(*this); --index_; return tmp; }
+      inline iterator& operator+=(difference_type n) { index_ += n; return *this; }
+      inline iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+      inline iterator operator+(difference_type n) const { iterator tmp(*this); return tmp += n; }
+      inline iterator operator-(difference_type n) const { iterator tmp(*this); return tmp -= n; }
+      inline difference_type operator-(const iterator& that) const {
+        return (difference_type)index_ - (difference_type)that.index_;
+      }
+      inline bool operator==(const iterator& that) const { return index_ == that.index_; }
+      inline bool operator!=(const iterator& that) const { return index_ != that.index_; }
+      inline bool operator<(const iterator& that) const { return index_ < that.index_; }
+      inline bool operator<=(const iterator& that) const { return index_ <= that.index_; }
+      inline bool operator>(const iterator& that) const { return index_ > that.index_; }
+      inline bool operator>=(const iterator& that) const { return index_ >= that.index_; }
+    };
+
+    inline polygon_90_compact_data() : majors_(), minors_(), negative_() {}
+
+    //packs the vertices of [input_begin, input_end); returns false and stays empty if one of
+    //them has a count other than +1 or -1, which only unclean data can have
+    template <typename iT>
+    inline bool assign(iT input_begin, iT input_end) {
+      clear();
+      std::size_t size = std::distance(input_begin, input_end);
+      majors_.reserve(size);
+      minors_.reserve(size);
+      negative_.reserve(size);
+      for( ; input_begin != input_end; ++input_begin) {
+        int count = (*input_begin).second.second;
+        if(count != 1 && count != -1) {
+          clear();
+          return false;
+        }
+        majors_.push_back((*input_begin).first);
+        minors_.push_back((*input_begin).second.first);
+        negative_.push_back(count < 0);
+      }
+      return true;
+    }
+
+    inline iterator begin() const { return iterator(this, 0); }
+    inline iterator end() const { return iterator(this, majors_.size()); }
+    inline std::size_t size() const { return majors_.size(); }
+    inline bool empty() const { return majors_.empty(); }
+    //vertices the arrays hold without reallocating
+    inline std::size_t capacity() const { return majors_.capacity(); }
+
+    //bytes held by the three arrays
+    inline std::size_t memory() const {
+      return (majors_.capacity() + minors_.capacity()) * sizeof(coordinate_type) + negative_.capacity() / 8;
+    }
+
+    //releases the storage, not just the contents
+    inline void clear() {
+      std::vector<coordinate_type>().swap(majors_);
+      std::vector<coordinate_type>().swap(minors_);
+      std::vector<bool>().swap(negative_);
+    }
+
+    //translation keeps the order of the vertices, so it is done in place
+    inline void move(coordinate_type major_delta, coordinate_type minor_delta) {
+      for(std::size_t i = 0; i < majors_.size(); ++i) {
+        majors_[i] += major_delta;
+        minors_[i] += minor_delta;
+      }
+    }
+
+    inline bool operator==(const polygon_90_compact_data& that) const {
+      return majors_ == that.majors_ && minors_ == that.minors_ && negative_ == that.negative_;
+    }
+
+  private:
+    friend class iterator;
+    std::vector<coordinate_type> majors_;
+    std::vector<coordinate_type> minors_;
+    std::vector<bool> negative_;
+  };
+
+}
+}
+#endif
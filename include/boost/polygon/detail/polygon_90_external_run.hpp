@@ -0,0 +1,208 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_90_EXTERNAL_RUN_HPP
+#define BOOST_POLYGON_POLYGON_90_EXTERNAL_RUN_HPP
+#include <cstdio>
+#include <stdexcept>
+namespace boost { namespace polygon{
+namespace external_sort {
+
+  //A run of (major, (minor, count)) vertices in an anonymous temporary file, which the system
+  //removes when the run is closed.  Vertices are only appended at the end and read back by index.
+  template <typename Unit>
+  class VertexRun {
+  public:
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+  private:
+    std::FILE* file_;
+    polygon_ulong_long_type size_;
+    VertexRun(const VertexRun&);
+    VertexRun& operator=(const VertexRun&);
+  public:
+    inline VertexRun() : file_(std::tmpfile()), size_(0) {
+      if(!file_)
+        throw std::runtime_error("boost::polygon: cannot create a temporary file");
+    }
+    inline ~VertexRun() { std::fclose(file_); }
+
+    inline void append(const vertex_type* vertices, std::size_t count) {
+      if(count == 0)
+        return;
+      seek_(size_);
+      if(std::fwrite(vertices, sizeof(vertex_type), count, file_) != count)
+        throw std::runtime_error("boost::polygon: cannot write a temporary file");
+      size_ += count;
+    }
+
+    //reads up to count vertices from index on and returns how many it read
+    inline std::size_t read(vertex_type* vertices, polygon_ulong_long_type index, std::size_t count) const {
+      if(index >= size_)
+        return 0;
+      if(size_ - index < count)
+        count = (std::size_t)(size_ - index);
+      seek_(index);
+      if(std::fread(vertices, sizeof(vertex_type), count, file_) != count)
+        throw std::runtime_error("boost::polygon: cannot read a temporary file");
+      return count;
+    }
+
+    inline polygon_ulong_long_type size() const { return size_; }
+
+  private:
+    //reads and writes share the file position, every access seeks first
+    inline void seek_(polygon_ulong_long_type index) const {
+      polygon_ulong_long_type offset = index * sizeof(vertex_type);
+#ifdef _MSC_VER
+      int result = _fseeki64(file_, (__int64)offset, SEEK_SET);
+#else
+      int result = std::fseek(file_, (long)offset, SEEK_SET);
+#endif
+      if(result != 0)
+        throw std::runtime_error("boost::polygon: cannot seek in a temporary file");
+    }
+  };
+
+  //reads a run front to back through a buffer of bufferSize vertices, no run reads as empty
+  template <typename Unit>
+  class RunReader {
+  public:
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+  private:
+    const VertexRun<Unit>* run_;
+    std::vector<vertex_type> buffer_;
+    std::size_t index_;
+    polygon_ulong_long_type next_; //index in the run of the vertex after the buffer
+    std::size_t bufferSize_;
+  public:
+    inline RunReader(const VertexRun<Unit>* run, std::size_t bufferSize) :
+      run_(run), buffer_(), index_(0), next_(0), bufferSize_(bufferSize < 1024 ? 1024 : bufferSize) {}
+
+    inline bool next(vertex_type& vertex) {
+      if(index_ == buffer_.size()) {
+        if(!run_)
+          return false;
+        buffer_.resize(bufferSize_);
+        std::size_t count = run_->read(&buffer_[0], next_, bufferSize_);
+        buffer_.resize(count);
+        next_ += count;
+        index_ = 0;
+        if(count == 0)
+          return false;
+      }
+      vertex = buffer_[index_++];
+      return true;
+    }
+  };
+
+  //the sorted merge of runs that are each sorted, which share about bufferSize vertices of buffers
+  template <typename Unit>
+  class RunMerge {
+  public:
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+  private:
+    std::vector<RunReader<Unit> > readers_;
+    std::vector<std::pair<vertex_type, std::size_t> > heap_;
+  public:
+    inline RunMerge(const std::vector<VertexRun<Unit>*>& runs, std::size_t bufferSize) : readers_(), heap_() {
+      std::size_t readerSize = runs.empty() ? bufferSize : bufferSize / runs.size();
+      readers_.reserve(runs.size());
+      heap_.reserve(runs.size());
+      for(std::size_t i = 0; i < runs.size(); ++i) {
+        readers_.push_back(RunReader<Unit>(runs[i], readerSize));
+        vertex_type vertex;
+        if(readers_.back().next(vertex))
+          heap_.push_back(std::make_pair(vertex, i));
+      }
+      std::make_heap(heap_.begin(), heap_.end(), boolean_op::NaryHeapOrder<std::pair<vertex_type, std::size_t> >());
+    }
+
+    inline bool next(vertex_type& vertex) {
+      if(heap_.empty())
+        return false;
+      std::pop_heap(heap_.begin(), heap_.end(), boolean_op::NaryHeapOrder<std::pair<vertex_type, std::size_t> >());
+      vertex = heap_.back().first;
+      if(readers_[heap_.back().second].next(heap_.back().first))
+        std::push_heap(heap_.begin(), heap_.end(), boolean_op::NaryHeapOrder<std::pair<vertex_type, std::size_t> >());
+      else
+        heap_.pop_back();
+      return true;
+    }
+  };
+
+  //input iterator over the vertices of a RunReader or a RunMerge, end is default constructed
+  template <typename source_type>
+  class SourceIterator {
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef typename source_type::vertex_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef const value_type& reference;
+  private:
+    source_type* source_;
+    value_type vertex_;
+  public:
+    inline SourceIterator() : source_(0), vertex_() {}
+    inline explicit SourceIterator(source_type& source) : source_(&source), vertex_() {
+      if(!source_->next(vertex_))
+        source_ = 0;
+    }
+    inline reference operator*() const { return vertex_; }
+    inline pointer operator->() const { return &vertex_; }
+    inline SourceIterator& operator++() {
+      if(!source_->next(vertex_))
+        source_ = 0;
+      return *this;
+    }
+    inline SourceIterator operator++(int) {
+      SourceIterator tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    inline bool operator==(const SourceIterator& that) const { return source_ == that.source_; }
+    inline bool operator!=(const SourceIterator& that) const { return source_ != that.source_; }
+  };
+
+  //Output of the boolean sweep into a run through a buffer of bufferSize vertices.  The sweep
+  //may take back the last vertex it wrote, so a full buffer is written out all but that one.
+  template <typename Unit>
+  class RunWriter {
+  public:
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+    typedef vertex_type value_type;
+  private:
+    VertexRun<Unit>& run_;
+    std::vector<vertex_type> buffer_;
+    std::size_t bufferSize_;
+  public:
+    inline RunWriter(VertexRun<Unit>& run, std::size_t bufferSize) :
+      run_(run), buffer_(), bufferSize_(bufferSize < 2 ? 2 : bufferSize) {
+      buffer_.reserve(bufferSize_);
+    }
+    inline bool empty() const { return buffer_.empty(); }
+    inline const vertex_type& back() const { return buffer_.back(); }
+    inline void push_back(const vertex_type& vertex) {
+      if(buffer_.size() == bufferSize_) {
+        run_.append(&buffer_[0], buffer_.size() - 1);
+        buffer_[0] = buffer_.back();
+        buffer_.resize(1);
+      }
+      buffer_.push_back(vertex);
+    }
+    inline void pop_back() { buffer_.pop_back(); }
+    inline void flush() {
+      if(!buffer_.empty())
+        run_.append(&buffer_[0], buffer_.size());
+      buffer_.clear();
+    }
+  };
+
+}
+}
+}
+#endif
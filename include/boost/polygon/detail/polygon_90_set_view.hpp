@@ -14,6 +14,9 @@ namespace boost { namespace polygon{
   template <typename value_type, typename arg_type>
   inline void insert_into_view_arg(value_type& dest, const arg_type& arg, orientation_2d orient);
 
+  template <typename value_type, typename T>
+  inline void insert_into_view_arg(value_type& dest, const polygon_90_set_data<T>& arg, orientation_2d orient);
+
   template <typename ltype, typename rtype, typename op_type>
   class polygon_90_set_view;
 
@@ -33,6 +36,116 @@ namespace boost { namespace polygon{
     static inline bool sorted(const polygon_90_set_view<ltype, rtype, op_type>& polygon_set);
   };
 
+    //a polygon_90_set_data argument of a boolean is read through its packed vertices if it is compacted
+    template <typename value_type, typename lcoord, typename iterator_type_2, typename count_type>
+    inline void apply_90_set_boolean(value_type& output_, const polygon_90_set_data<lcoord>& lvalue_,
+                                     iterator_type_2 itr2, iterator_type_2 itr2_end, count_type count) {
+      if(lvalue_.compacted())
+        output_.applyBooleanBinaryOp(lvalue_.begin_compact(), lvalue_.end_compact(), itr2, itr2_end, count);
+      else
+        output_.applyBooleanBinaryOp(lvalue_.begin(), lvalue_.end(), itr2, itr2_end, count);
+    }
+
+    template <typename value_type, typename iterator_type_1, typename rcoord, typename count_type>
+    inline void apply_90_set_boolean(value_type& output_, iterator_type_1 itr1, iterator_type_1 itr1_end,
+                                     const polygon_90_set_data<rcoord>& rvalue_, count_type count) {
+      if(rvalue_.compacted())
+        output_.applyBooleanBinaryOp(itr1, itr1_end, rvalue_.begin_compact(), rvalue_.end_compact(), count);
+      else
+        output_.applyBooleanBinaryOp(itr1, itr1_end, rvalue_.begin(), rvalue_.end(), count);
+    }
+
+    template <typename value_type, typename lcoord, typename rcoord, typename count_type>
+    inline void apply_90_set_boolean(value_type& output_, const polygon_90_set_data<lcoord>& lvalue_,
+                                     const polygon_90_set_data<rcoord>& rvalue_, count_type count) {
+      if(rvalue_.compacted())
+        apply_90_set_boolean(output_, lvalue_, rvalue_.begin_compact(), rvalue_.end_compact(), count);
+      else
+        apply_90_set_boolean(output_, lvalue_, rvalue_.begin(), rvalue_.end(), count);
+    }
+
+    //A view with another view among its arguments is evaluated fused: the sets at the leaves of
+    //the expression are swept at once with a count per leaf, and the expression is evaluated on
+    //the counts of every interval, so no view inside it makes an intermediate set.
+    //polygon_90_set_view_expression gathers the leaves and evaluates the expression on them.
+    template <typename arg_type>
+    struct polygon_90_set_view_expression {
+      static const bool is_view = false;
+      template <typename leaves_type>
+      static inline void leaves(leaves_type& leaves, const arg_type& arg) { leaves.add(arg); }
+      static inline bool evaluate(const std::vector<int>& counts, std::size_t& index) {
+        return counts[index++] > 0;
+      }
+    };
+
+    template <typename ltype, typename rtype, typename op_type>
+    struct polygon_90_set_view_expression<polygon_90_set_view<ltype, rtype, op_type> > {
+      static const bool is_view = true;
+      template <typename leaves_type>
+      static inline void leaves(leaves_type& leaves, const polygon_90_set_view<ltype, rtype, op_type>& view) {
+        polygon_90_set_view_expression<ltype>::leaves(leaves, view.lvalue_);
+        polygon_90_set_view_expression<rtype>::leaves(leaves, view.rvalue_);
+      }
+      static inline bool evaluate(const std::vector<int>& counts, std::size_t& index) {
+        bool left = polygon_90_set_view_expression<ltype>::evaluate(counts, index);
+        bool right = polygon_90_set_view_expression<rtype>::evaluate(counts, index);
+        op_type op;
+        return op(left, right);
+      }
+    };
+
+    //the predicate of the fused sweep, false when no leaf covers an interval since none of the
+    //binary operations of the views is true on two zero counts
+    template <typename expression_type>
+    class polygon_90_set_view_predicate {
+    public:
+      inline bool operator()(const std::vector<int>& counts) const {
+        std::size_t index = 0;
+        return polygon_90_set_view_expression<expression_type>::evaluate(counts, index);
+      }
+    };
+
+    //the sorted vertex ranges of the leaves, read in place where the leaf is a set of the output
+    //orientation and copied otherwise
+    template <typename value_type>
+    class polygon_90_set_view_leaves {
+    public:
+      typedef typename value_type::iterator_type iterator_type;
+      typedef std::vector<std::pair<iterator_type, iterator_type> > inputs_type;
+    private:
+      orientation_2d orient_;
+      std::list<value_type> copies_;
+      inputs_type inputs_;
+    public:
+      inline explicit polygon_90_set_view_leaves(orientation_2d orient) : orient_(orient), copies_(), inputs_() {}
+      inline void add(const value_type& leaf) {
+        if(leaf.orient() != orient_ || leaf.compacted()) {
+          add_copy_(leaf);
+          return;
+        }
+        leaf.sort();
+        inputs_.push_back(std::make_pair(leaf.begin(), leaf.end()));
+      }
+      template <typename arg_type>
+      inline void add(const arg_type& leaf) { add_copy_(leaf); }
+      inline const inputs_type& inputs() const { return inputs_; }
+    private:
+      template <typename arg_type>
+      inline void add_copy_(const arg_type& leaf) {
+        copies_.push_back(value_type(orient_));
+        insert_into_view_arg(copies_.back(), leaf, polygon_90_set_traits<arg_type>::orient(leaf));
+        inputs_.push_back(std::make_pair(copies_.back().begin(), copies_.back().end()));
+      }
+    };
+
+    template <typename value_type, typename expression_type>
+    inline void compute_90_set_fused_value(value_type& output_, const expression_type& expression,
+                                           orientation_2d orient_) {
+      polygon_90_set_view_leaves<value_type> leaves(orient_);
+      polygon_90_set_view_expression<expression_type>::leaves(leaves, expression);
+      output_.applyBooleanNaryOp(leaves.inputs(), polygon_90_set_view_predicate<expression_type>());
+    }
+
     template <typename value_type, typename ltype, typename rtype, typename op_type>
     struct compute_90_set_value {
       static
@@ -64,8 +177,7 @@ namespace boost { namespace polygon{
         if((orient_ == orient_l) && (orient_== orient_r)){ // assume that most of the time this condition is met
           lvalue_.sort();
           rvalue_.sort();
-          output_.applyBooleanBinaryOp(lvalue_.begin(), lvalue_.end(),
-                                       rvalue_.begin(), rvalue_.end(), boolean_op::BinaryCount<op_type>());
+          apply_90_set_boolean(output_, lvalue_, rvalue_, boolean_op::BinaryCount<op_type>());
         }else if((orient_ != orient_l) && (orient_!= orient_r)){ // both the orientations are not equal to input
           // easier way is to ignore the input orientation and use the input data's orientation, but not done so
           insert_into_view_arg(linput_, lvalue_, orient_l);
@@ -75,13 +187,13 @@ namespace boost { namespace polygon{
         }else if(orient_ != orient_l){ // left hand side orientation is different
           insert_into_view_arg(linput_, lvalue_, orient_l);
           rvalue_.sort();
-          output_.applyBooleanBinaryOp(linput_.begin(), linput_.end(),
-                                       rvalue_.begin(), rvalue_.end(), boolean_op::BinaryCount<op_type>());
+          apply_90_set_boolean(output_, linput_.begin(), linput_.end(),
+                               rvalue_, boolean_op::BinaryCount<op_type>());
         } else if(orient_ != orient_r){ // right hand side orientation is different
           insert_into_view_arg(rinput_, rvalue_, orient_r);
           lvalue_.sort();
-          output_.applyBooleanBinaryOp(lvalue_.begin(), lvalue_.end(),
-                                       rinput_.begin(), rinput_.end(), boolean_op::BinaryCount<op_type>());
+          apply_90_set_boolean(output_, lvalue_,
+                               rinput_.begin(), rinput_.end(), boolean_op::BinaryCount<op_type>());
         }
       }
     };
@@ -97,8 +209,8 @@ namespace boost { namespace polygon{
          //std::cout << "compute_90_set_value-2 orientations (right, out):\t" << orient_r.to_int()
          //          << "," << orient_.to_int() << std::endl;
          insert_into_view_arg(rinput_, rvalue_, orient_r);
-         output_.applyBooleanBinaryOp(lvalue_.begin(), lvalue_.end(),
-                                      rinput_.begin(), rinput_.end(), boolean_op::BinaryCount<op_type>());
+         apply_90_set_boolean(output_, lvalue_,
+                              rinput_.begin(), rinput_.end(), boolean_op::BinaryCount<op_type>());
       }
     };
 
@@ -114,8 +226,8 @@ namespace boost { namespace polygon{
         //std::cout << "compute_90_set_value-3 orientations (left, out):\t" << orient_l.to_int()
         //          << "," << orient_.to_int() << std::endl;
 
-        output_.applyBooleanBinaryOp(linput_.begin(), linput_.end(),
-                                     rvalue_.begin(), rvalue_.end(), boolean_op::BinaryCount<op_type>());
+        apply_90_set_boolean(output_, linput_.begin(), linput_.end(),
+                             rvalue_, boolean_op::BinaryCount<op_type>());
       }
     };
 
@@ -134,6 +246,8 @@ namespace boost { namespace polygon{
     mutable value_type output_;
     mutable bool evaluated_;
     polygon_90_set_view& operator=(const polygon_90_set_view&);
+    template <typename arg_type>
+    friend struct polygon_90_set_view_expression;
   public:
     polygon_90_set_view(const ltype& lvalue,
                      const rtype& rvalue,
@@ -146,7 +260,10 @@ namespace boost { namespace polygon{
     const value_type& value() const {
       if(!evaluated_) {
         evaluated_ = true;
-        compute_90_set_value<value_type, ltype, rtype, op_type>::value(output_, lvalue_, rvalue_, orient_);
+        if(polygon_90_set_view_expression<ltype>::is_view || polygon_90_set_view_expression<rtype>::is_view)
+          compute_90_set_fused_value(output_, *this, orient_);
+        else
+          compute_90_set_value<value_type, ltype, rtype, op_type>::value(output_, lvalue_, rvalue_, orient_);
       }
       return output_;
     }
@@ -217,6 +334,27 @@ namespace boost { namespace polygon{
     dest.sort();
   }
 
+  template <typename value_type, typename T>
+  inline void insert_into_view_arg(value_type& dest, const polygon_90_set_data<T>& arg, orientation_2d orient) {
+    if(arg.compacted())
+      dest.insert(arg.begin_compact(), arg.end_compact(), orient);
+    else
+      dest.insert(arg.begin(), arg.end(), orient);
+    dest.sort();
+  }
+
+  template <typename coordinate_type_1, typename geometry_type_2>
+  inline void insert_90_set_data(polygon_90_set_data<coordinate_type_1>& lvalue, const geometry_type_2& rvalue) {
+    lvalue.insert(polygon_90_set_traits<geometry_type_2>::begin(rvalue), polygon_90_set_traits<geometry_type_2>::end(rvalue),
+                  polygon_90_set_traits<geometry_type_2>::orient(rvalue));
+  }
+
+  //a set of the same type is appended in bulk, from its packed vertices if it is compacted
+  template <typename T>
+  inline void insert_90_set_data(polygon_90_set_data<T>& lvalue, const polygon_90_set_data<T>& rvalue) {
+    lvalue.insert(rvalue);
+  }
+
   template <typename T>
   template <typename ltype, typename rtype, typename op_type>
   inline polygon_90_set_data<T>& polygon_90_set_data<T>::operator=(const polygon_90_set_view<ltype, rtype, op_type>& that) {
@@ -229,7 +367,8 @@ namespace boost { namespace polygon{
   template <typename T>
   template <typename ltype, typename rtype, typename op_type>
   inline polygon_90_set_data<T>::polygon_90_set_data(const polygon_90_set_view<ltype, rtype, op_type>& that) :
-    orient_(that.orient()), data_(that.begin(), that.end()), dirty_(false), unsorted_(false) {}
+    orient_(that.orient()), data_(that.begin(), that.end()), dirty_(false), unsorted_(false),
+    compact_(), compacted_(false) {}
 
   template <typename geometry_type_1, typename geometry_type_2>
   struct self_assign_operator_lvalue {
@@ -362,8 +501,7 @@ namespace boost { namespace polygon{
   typename enable_if< typename gtl_and< y_ps90_pe, typename is_polygon_90_set_type<geometry_type_2>::type>::type,
                        polygon_90_set_data<coordinate_type_1> >::type &
   operator+=(polygon_90_set_data<coordinate_type_1>& lvalue, const geometry_type_2& rvalue) {
-    lvalue.insert(polygon_90_set_traits<geometry_type_2>::begin(rvalue), polygon_90_set_traits<geometry_type_2>::end(rvalue),
-                  polygon_90_set_traits<geometry_type_2>::orient(rvalue));
+    insert_90_set_data(lvalue, rvalue);
     return lvalue;
   }
 
@@ -13,9 +13,72 @@ namespace boost { namespace polygon{
   struct touch_90_operation {
     typedef interval_data<Unit> Interval;
 
+    //sets of polygon ids are small sorted vectors, they seldom hold more than a few ids
+    typedef std::vector<int> IdSet;
+
+    //inserts id into ids if it is not there and erases it if it is
+    static inline void toggleId(IdSet& ids, int id) {
+      IdSet::iterator lb = std::lower_bound(ids.begin(), ids.end(), id);
+      if(lb != ids.end() && *lb == id)
+        ids.erase(lb);
+      else
+        ids.insert(lb, id);
+    }
+
+    //Union-find output of the sweep, which joins the components of the graph nodes that touch
+    //instead of storing the edges between them.  The root of a component is its least node id.
+    class TouchComponents {
+    private:
+      std::vector<int> parent_;
+    public:
+      inline explicit TouchComponents(std::size_t nodeCount) : parent_(nodeCount) {
+        for(std::size_t i = 0; i < nodeCount; ++i)
+          parent_[i] = (int)i;
+      }
+      inline int find(int id) {
+        while(parent_[id] != id) {
+          parent_[id] = parent_[parent_[id]];
+          id = parent_[id];
+        }
+        return id;
+      }
+      inline void join(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if(a < b) parent_[b] = a;
+        else if(b < a) parent_[a] = b;
+      }
+    };
+
+    //Edge list output of the sweep, which gives each edge to sink as sink(id, id)
+    template <typename sinkT>
+    class TouchEdgeSink {
+    private:
+      sinkT& sink_;
+    public:
+      inline explicit TouchEdgeSink(sinkT& sink) : sink_(sink) {}
+      inline void edge(int a, int b) { sink_(a, b); }
+    };
+
+    //records that graph nodes a and b touch, a graph is indexable by node id and holds sets of node ids
+    template <typename graphT>
+    static inline void addEdge(graphT& graph, int a, int b) {
+      graph[a].insert(b);
+      graph[b].insert(a);
+    }
+    static inline void addEdge(TouchComponents& components, int a, int b) { components.join(a, b); }
+    template <typename sinkT>
+    static inline void addEdge(TouchEdgeSink<sinkT>& edges, int a, int b) { edges.edge(a, b); }
+
+    //The ids of an interval of the scanline all touch each other, so once a node is joined with
+    //one of them the rest add nothing to its component.  Other outputs need an edge per id.
+    template <typename graphT>
+    static inline bool edgePerId(const graphT&) { return true; }
+    static inline bool edgePerId(const TouchComponents&) { return false; }
+
     class TouchScanEvent {
     private:
-      typedef std::map<Unit, std::set<int> > EventData;
+      typedef std::map<Unit, IdSet> EventData;
       EventData eventData_;
     public:
 
@@ -26,12 +89,12 @@ namespace boost { namespace polygon{
       class iterator {
       private:
         typename EventData::const_iterator itr_;
-        std::pair<Interval, std::set<int> > ivlIds_;
+        std::pair<Interval, IdSet> ivlIds_;
         bool incremented_;
       public:
         inline iterator() : itr_(), ivlIds_(), incremented_(false) {}
         inline iterator(typename EventData::const_iterator itr,
-                        Unit prevPos, Unit curPos, const std::set<int>& ivlIds) : itr_(itr), ivlIds_(), incremented_(false) {
+                        Unit prevPos, Unit curPos, const IdSet& ivlIds) : itr_(itr), ivlIds_(), incremented_(false) {
           ivlIds_.second = ivlIds;
           ivlIds_.first = Interval(prevPos, curPos);
         }
@@ -46,27 +109,10 @@ namespace boost { namespace polygon{
         inline bool operator==(const iterator& that) { return itr_ == that.itr_; }
         inline bool operator!=(const iterator& that) { return itr_ != that.itr_; }
         inline iterator& operator++() {
-          //std::cout << "increment\n";
-          //std::cout << "state\n";
-          //for(std::set<int>::iterator itr = ivlIds_.second.begin(); itr != ivlIds_.second.end(); ++itr) {
-          //   std::cout << (*itr) << " ";
-          //} std::cout << std::endl;
-          //std::cout << "update\n";
-          for(std::set<int>::const_iterator itr = (*itr_).second.begin();
+          for(IdSet::const_iterator itr = (*itr_).second.begin();
               itr != (*itr_).second.end(); ++itr) {
-            //std::cout << (*itr) <<  " ";
-            std::set<int>::iterator lb = ivlIds_.second.find(*itr);
-            if(lb != ivlIds_.second.end()) {
-              ivlIds_.second.erase(lb);
-            } else {
-              ivlIds_.second.insert(*itr);
-            }
+            toggleId(ivlIds_.second, *itr);
           }
-          //std::cout << std::endl;
-          //std::cout << "new state\n";
-          //for(std::set<int>::iterator itr = ivlIds_.second.begin(); itr != ivlIds_.second.end(); ++itr) {
-          //   std::cout << (*itr) << " ";
-          //} std::cout << std::endl;
           ++itr_;
           //ivlIds_.first = Interval(ivlIds_.first.get(HIGH), itr_->first);
           incremented_ = true;
@@ -77,7 +123,7 @@ namespace boost { namespace polygon{
           ++(*this);
           return tmpItr;
         }
-        inline std::pair<Interval, std::set<int> >& operator*() {
+        inline std::pair<Interval, IdSet>& operator*() {
           if(incremented_) ivlIds_.first = Interval(ivlIds_.first.get(HIGH), itr_->first);
           incremented_ = false;
           if(ivlIds_.second.empty())(++(*this));
@@ -109,16 +155,10 @@ namespace boost { namespace polygon{
       inline void insert(Unit pos, int id) {
         typename EventData::iterator lb = eventData_.lower_bound(pos);
         if(lb != eventData_.end() && lb->first == pos) {
-          std::set<int>& mr (lb->second);
-          std::set<int>::iterator mri = mr.find(id);
-          if(mri == mr.end()) {
-            mr.insert(id);
-          } else {
-            mr.erase(id);
-          }
+          toggleId(lb->second, id);
         } else {
-          lb = eventData_.insert(lb, std::pair<Unit, std::set<int> >(pos, std::set<int>()));
-          (*lb).second.insert(id);
+          lb = eventData_.insert(lb, std::pair<Unit, IdSet>(pos, IdSet()));
+          (*lb).second.push_back(id);
         }
       }
 
@@ -126,7 +166,12 @@ namespace boost { namespace polygon{
       inline void insert(const TouchScanEvent& that){
         typename EventData::const_iterator itr;
         for(itr = that.eventData_.begin(); itr != that.eventData_.end(); ++itr) {
-          eventData_[(*itr).first].insert(itr->second.begin(), itr->second.end());
+          IdSet& ids = eventData_[(*itr).first];
+          for(IdSet::const_iterator iditr = itr->second.begin(); iditr != itr->second.end(); ++iditr) {
+            IdSet::iterator lb = std::lower_bound(ids.begin(), ids.end(), *iditr);
+            if(lb == ids.end() || *lb != *iditr)
+              ids.insert(lb, *iditr);
+          }
         }
       }
 
@@ -136,13 +181,13 @@ namespace boost { namespace polygon{
         if(eventData_.empty()) return end();
         typename EventData::const_iterator itr = eventData_.begin();
         Unit pos = itr->first;
-        const std::set<int>& idr = itr->second;
+        const IdSet& idr = itr->second;
         ++itr;
         return iterator(itr, pos, itr->first, idr);
       }
 
       //Get the end iterator over event data
-      inline iterator end() const { return iterator(eventData_.end(), 0, 0, std::set<int>()); }
+      inline iterator end() const { return iterator(eventData_.end(), 0, 0, IdSet()); }
 
       inline void clear() { eventData_.clear(); }
 
@@ -158,8 +203,8 @@ namespace boost { namespace polygon{
 
     class TouchOp {
     public:
-      typedef std::map<Unit, std::set<int> > ScanData;
-      typedef std::pair<Unit, std::set<int> > ElementType;
+      typedef std::map<Unit, IdSet> ScanData;
+      typedef std::pair<Unit, IdSet> ElementType;
     protected:
       ScanData scanData_;
       typename ScanData::iterator nextItr_;
@@ -171,31 +216,29 @@ namespace boost { namespace polygon{
       //moves scanline forward
       inline void advanceScan() { nextItr_ = scanData_.begin(); }
 
-      //proceses the given interval and std::set<int> data
+      //proceses the given interval and id set data
       //the output data structre is a graph, the indicies in the vector correspond to graph nodes,
-      //the integers in the set are vector indicies and are the nodes with which that node shares an edge
+      //the integers in the set are vector indicies and are the nodes with which that node shares an edge,
+      //or a TouchComponents or TouchEdgeSink, see addEdge
       template <typename graphT>
-      inline void processInterval(graphT& outputContainer, Interval ivl, const std::set<int>& ids, bool leadingEdge) {
+      inline void processInterval(graphT& outputContainer, Interval ivl, const IdSet& ids, bool leadingEdge) {
         //print();
         typename ScanData::iterator lowItr = lookup_(ivl.low());
         typename ScanData::iterator highItr = lookup_(ivl.high());
         //std::cout << "Interval: " << ivl << std::endl;
-        //for(std::set<int>::const_iterator itr = ids.begin(); itr != ids.end(); ++itr)
-        //   std::cout << (*itr) << " ";
-        //std::cout << std::endl;
         //add interval to scan data if it is past the end
         if(lowItr == scanData_.end()) {
           //std::cout << "case0" << std::endl;
           lowItr = insert_(ivl.low(), ids);
           evaluateBorder_(outputContainer, ids, ids);
-          highItr = insert_(ivl.high(), std::set<int>());
+          highItr = insert_(ivl.high(), IdSet());
           return;
         }
         //ensure that highItr points to the end of the ivl
         if(highItr == scanData_.end() || (*highItr).first > ivl.high()) {
           //std::cout << "case1" << std::endl;
           //std::cout << highItr->first << std::endl;
-          std::set<int> value = std::set<int>();
+          IdSet value = IdSet();
           if(highItr != scanData_.begin()) {
             --highItr;
             //std::cout << highItr->first << std::endl;
@@ -221,7 +264,7 @@ namespace boost { namespace polygon{
           } else {
             //std::cout << "case4" << std::endl;
             nextItr_ = lowItr;
-            lowItr = insert_(ivl.low(), std::set<int>());
+            lowItr = insert_(ivl.low(), IdSet());
           }
         } else {
           //evaluate border with next higher interval
@@ -238,7 +281,7 @@ namespace boost { namespace polygon{
         for(typename ScanData::iterator itr = lowItr; itr != highItr; ){
           //std::cout << "case5" << std::endl;
           //std::cout << itr->first << std::endl;
-          std::set<int>& beforeIds = itr->second;
+          IdSet& beforeIds = itr->second;
           ++itr;
           evaluateInterval_(outputContainer, beforeIds, ids, leadingEdge);
         }
@@ -272,7 +315,7 @@ namespace boost { namespace polygon{
 //       inline void print() const {
 //         for(typename ScanData::const_iterator itr = scanData_.begin(); itr != scanData_.end(); ++itr) {
 //           std::cout << itr->first << ": ";
-//           for(std::set<int>::const_iterator sitr = itr->second.begin();
+//           for(IdSet::const_iterator sitr = itr->second.begin();
 //               sitr != itr->second.end(); ++sitr){
 //             std::cout << *sitr << " ";
 //           }
@@ -288,55 +331,49 @@ namespace boost { namespace polygon{
         return nextItr_ = scanData_.lower_bound(pos);
       }
 
-      inline typename ScanData::iterator insert_(Unit pos, const std::set<int>& ids){
+      inline typename ScanData::iterator insert_(Unit pos, const IdSet& ids){
         //std::cout << "inserting " << ids.size() << " ids at: " << pos << std::endl;
-        return nextItr_ = scanData_.insert(nextItr_, std::pair<Unit, std::set<int> >(pos, ids));
+        return nextItr_ = scanData_.insert(nextItr_, std::pair<Unit, IdSet>(pos, ids));
       }
 
       template <typename graphT>
-      inline void evaluateInterval_(graphT& outputContainer, std::set<int>& ids,
-                                    const std::set<int>& changingIds, bool leadingEdge) {
-        for(std::set<int>::const_iterator ciditr = changingIds.begin(); ciditr != changingIds.end(); ++ciditr){
+      inline void evaluateInterval_(graphT& outputContainer, IdSet& ids,
+                                    const IdSet& changingIds, bool leadingEdge) {
+        for(IdSet::const_iterator ciditr = changingIds.begin(); ciditr != changingIds.end(); ++ciditr){
           //std::cout << "evaluateInterval " << (*ciditr) << std::endl;
           evaluateId_(outputContainer, ids, *ciditr, leadingEdge);
         }
       }
       template <typename graphT>
-      inline void evaluateBorder_(graphT& outputContainer, const std::set<int>& ids, const std::set<int>& changingIds) {
-        for(std::set<int>::const_iterator ciditr = changingIds.begin(); ciditr != changingIds.end(); ++ciditr){
+      inline void evaluateBorder_(graphT& outputContainer, const IdSet& ids, const IdSet& changingIds) {
+        for(IdSet::const_iterator ciditr = changingIds.begin(); ciditr != changingIds.end(); ++ciditr){
           //std::cout << "evaluateBorder " << (*ciditr) << std::endl;
           evaluateBorderId_(outputContainer, ids, *ciditr);
         }
       }
       template <typename graphT>
-      inline void evaluateBorderId_(graphT& outputContainer, const std::set<int>& ids, int changingId) {
-        for(std::set<int>::const_iterator scanItr = ids.begin(); scanItr != ids.end(); ++scanItr) {
+      inline void evaluateBorderId_(graphT& outputContainer, const IdSet& ids, int changingId) {
+        for(IdSet::const_iterator scanItr = ids.begin(); scanItr != ids.end(); ++scanItr) {
           //std::cout << "create edge: " << changingId << " " << *scanItr << std::endl;
           if(changingId != *scanItr){
-            outputContainer[changingId].insert(*scanItr);
-            outputContainer[*scanItr].insert(changingId);
+            addEdge(outputContainer, changingId, *scanItr);
+            if(!edgePerId(outputContainer)) break;
           }
         }
       }
       template <typename graphT>
-      inline void evaluateId_(graphT& outputContainer, std::set<int>& ids, int changingId, bool leadingEdge) {
-        //std::cout << "changingId: " << changingId << std::endl;
-        //for( std::set<int>::iterator itr = ids.begin(); itr != ids.end(); ++itr){
-        //   std::cout << *itr << " ";
-        //}std::cout << std::endl;
-        std::set<int>::iterator lb = ids.lower_bound(changingId);
+      inline void evaluateId_(graphT& outputContainer, IdSet& ids, int changingId, bool leadingEdge) {
+        IdSet::iterator lb = std::lower_bound(ids.begin(), ids.end(), changingId);
         if(lb == ids.end() || (*lb) != changingId) {
           if(leadingEdge) {
             //std::cout << "insert\n";
             //insert and add to output
-            for(std::set<int>::iterator scanItr = ids.begin(); scanItr != ids.end(); ++scanItr) {
+            for(IdSet::iterator scanItr = ids.begin(); scanItr != ids.end(); ++scanItr) {
               //std::cout << "create edge: " << changingId << " " << *scanItr << std::endl;
-              if(changingId != *scanItr){
-                outputContainer[changingId].insert(*scanItr);
-                outputContainer[*scanItr].insert(changingId);
-              }
+              addEdge(outputContainer, changingId, *scanItr);
+              if(!edgePerId(outputContainer)) break;
             }
-            ids.insert(changingId);
+            ids.insert(lb, changingId);
           }
         } else {
           if(!leadingEdge){
@@ -852,26 +852,29 @@ namespace boost { namespace polygon{
       typedef typename std::list<Point>::const_iterator iterator;
 
       // default constructor of point does not initialize x and y
-      inline poly_line_arbitrary() : points() {} //do nothing default constructor
+      inline poly_line_arbitrary() : points(), numPoints(0) {} //do nothing default constructor
 
       // initialize a polygon from x,y values, it is assumed that the first is an x
       // and that the input is a well behaved polygon
       template<class iT>
       inline poly_line_arbitrary& set(iT inputBegin, iT inputEnd) {
         points.clear();  //just in case there was some old data there
+        numPoints = 0;
         while(inputBegin != inputEnd) {
           points.insert(points.end(), *inputBegin);
+          ++numPoints;
           ++inputBegin;
         }
         return *this;
       }
 
       // copy constructor (since we have dynamic memory)
-      inline poly_line_arbitrary(const poly_line_arbitrary& that) : points(that.points) {}
+      inline poly_line_arbitrary(const poly_line_arbitrary& that) : points(that.points), numPoints(that.numPoints) {}
 
       // assignment operator (since we have dynamic memory do a deep copy)
       inline poly_line_arbitrary& operator=(const poly_line_arbitrary& that) {
         points = that.points;
+        numPoints = that.numPoints;
         return *this;
       }
 
@@ -881,10 +884,12 @@ namespace boost { namespace polygon{
       // get end iterator, returns a pointer to a const Unit
       inline iterator end() const { return points.end(); }
 
-      inline std::size_t size() const { return points.size(); }
+      inline std::size_t size() const { return numPoints; }
 
       //public data member
       std::list<Point> points;
+      //points.size(), counted here since std::list::size may walk the list
+      std::size_t numPoints;
     };
 
     class active_tail_arbitrary {
@@ -893,6 +898,11 @@ namespace boost { namespace polygon{
       poly_line_arbitrary* tailp_;
       active_tail_arbitrary *otherTailp_;
       std::list<active_tail_arbitrary*> holesList_;
+      std::size_t holePoints_;
+      //the x at which the last of the holes in the list of holes closed
+      Unit holesEndX_;
+      //the x at which the element next above the one this is the tail of last changed
+      Unit aboveX_;
       bool head_;
     public:
 
@@ -907,12 +917,15 @@ namespace boost { namespace polygon{
       typedef typename std::list<active_tail_arbitrary*>::const_iterator iteratorHoles;
 
       //default constructor
-      inline active_tail_arbitrary() : tailp_(), otherTailp_(), holesList_(), head_() {}
+      inline active_tail_arbitrary() : tailp_(), otherTailp_(), holesList_(), holePoints_(0), holesEndX_((std::numeric_limits<Unit>::min)()),
+        aboveX_((std::numeric_limits<Unit>::max)()), head_() {}
 
       //constructor
-      inline active_tail_arbitrary(const vertex_half_edge& vertex, active_tail_arbitrary* otherTailp = 0) : tailp_(), otherTailp_(), holesList_(), head_() {
+      inline active_tail_arbitrary(const vertex_half_edge& vertex, active_tail_arbitrary* otherTailp = 0) : tailp_(), otherTailp_(), holesList_(), holePoints_(0), holesEndX_((std::numeric_limits<Unit>::min)()),
+        aboveX_((std::numeric_limits<Unit>::max)()), head_() {
         tailp_ = new poly_line_arbitrary;
         tailp_->points.push_back(vertex.pt);
+        tailp_->numPoints = 1;
         //bool headArray[4] = {false, true, true, true};
         bool inverted = vertex.count == -1;
         head_ = (!vertex.is_vertical) ^ inverted;
@@ -920,22 +933,26 @@ namespace boost { namespace polygon{
       }
 
       inline active_tail_arbitrary(Point point, active_tail_arbitrary* otherTailp, bool head = true) :
-        tailp_(), otherTailp_(), holesList_(), head_() {
+        tailp_(), otherTailp_(), holesList_(), holePoints_(0), holesEndX_((std::numeric_limits<Unit>::min)()),
+        aboveX_((std::numeric_limits<Unit>::max)()), head_() {
         tailp_ = new poly_line_arbitrary;
         tailp_->points.push_back(point);
+        tailp_->numPoints = 1;
         head_ = head;
         otherTailp_ = otherTailp;
 
       }
       inline active_tail_arbitrary(active_tail_arbitrary* otherTailp) :
-        tailp_(), otherTailp_(), holesList_(), head_() {
+        tailp_(), otherTailp_(), holesList_(), holePoints_(0), holesEndX_((std::numeric_limits<Unit>::min)()),
+        aboveX_((std::numeric_limits<Unit>::max)()), head_() {
         tailp_ = otherTailp->tailp_;
         otherTailp_ = otherTailp;
       }
 
       //copy constructor
       inline active_tail_arbitrary(const active_tail_arbitrary& that) :
-        tailp_(), otherTailp_(), holesList_(), head_() { (*this) = that; }
+        tailp_(), otherTailp_(), holesList_(), holePoints_(0), holesEndX_((std::numeric_limits<Unit>::min)()),
+        aboveX_((std::numeric_limits<Unit>::max)()), head_() { (*this) = that; }
 
       //destructor
       inline ~active_tail_arbitrary() {
@@ -948,6 +965,9 @@ namespace boost { namespace polygon{
         head_ = that.head_;
         otherTailp_ = that.otherTailp_;
         holesList_ = that.holesList_;
+        holePoints_ = that.holePoints_;
+        holesEndX_ = that.holesEndX_;
+        aboveX_ = that.aboveX_;
         return *this;
       }
 
@@ -1008,8 +1028,10 @@ namespace boost { namespace polygon{
         typename std::list<point_data<Unit> >::iterator iter = tail2->points.begin();
         if(*riter == *iter) {
           tail1->points.pop_back(); //remove duplicate point
+          --tail1->numPoints;
         }
         tail1->points.splice(tail1->points.end(), tail2->points);
+        tail1->numPoints += tail2->numPoints;
         delete tail2;
         otherTailp_->tailp_ = tail1;
         tail->otherTailp_->tailp_ = tail1;
@@ -1027,6 +1049,9 @@ namespace boost { namespace polygon{
        */
       inline active_tail_arbitrary* addHole(active_tail_arbitrary* hole) {
         holesList_.push_back(hole);
+        holePoints_ += hole->tailp_->numPoints;
+        //a hole is added at the x of the point where it closed, its rightmost
+        if(holesEndX_ < hole->getPoint().x()) holesEndX_ = hole->getPoint().x();
         copyHoles(*hole);
         copyHoles(*(hole->otherTailp_));
         return this;
@@ -1040,7 +1065,28 @@ namespace boost { namespace polygon{
       /**
        * @brief copy holes from that to this
        */
-      inline void copyHoles(active_tail_arbitrary& that) { holesList_.splice(holesList_.end(), that.holesList_); }
+      inline void copyHoles(active_tail_arbitrary& that) {
+        holesList_.splice(holesList_.end(), that.holesList_);
+        holePoints_ += that.holePoints_;
+        that.holePoints_ = 0;
+        if(holesEndX_ < that.holesEndX_) holesEndX_ = that.holesEndX_;
+      }
+
+      /**
+       * @brief get the number of points of the holes in the list of holes
+       */
+      inline std::size_t getHolePoints() const { return holePoints_; }
+
+      /**
+       * @brief get the x at which the last of the holes in the list of holes closed
+       */
+      inline Unit getHolesEndX() const { return holesEndX_; }
+
+      /**
+       * @brief get and set the x at which the element next above the one this is the tail of last changed
+       */
+      inline Unit getAboveX() const { return aboveX_; }
+      inline void setAboveX(Unit x) { aboveX_ = x; }
 
       /**
        * @brief find out if solid to right
@@ -1068,16 +1114,19 @@ namespace boost { namespace polygon{
           typename std::list<Point>::iterator iter = tailp_->points.begin();
           if(iter == tailp_->points.end()) {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
             return;
           }
           ++iter;
           if(iter == tailp_->points.end()) {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
             return;
           }
           --iter;
           if(*iter != point) {
             tailp_->points.push_front(point);
+            ++tailp_->numPoints;
           }
           return;
         }
@@ -1088,16 +1137,19 @@ namespace boost { namespace polygon{
         typename std::list<Point>::reverse_iterator iter = tailp_->points.rbegin();
         if(iter == tailp_->points.rend()) {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
           return;
         }
         ++iter;
         if(iter == tailp_->points.rend()) {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
           return;
         }
         --iter;
         if(*iter != point) {
           tailp_->points.push_back(point);
+          ++tailp_->numPoints;
         }
       }
 
@@ -1172,6 +1224,8 @@ namespace boost { namespace polygon{
           (*itr) = 0;
         }
         holesList_.clear();
+        holePoints_ = 0;
+        holesEndX_ = (std::numeric_limits<Unit>::min)();
       }
 
       inline void print() {
@@ -1320,23 +1374,37 @@ namespace boost { namespace polygon{
     Unit x_;
     int justBefore_;
     int fractureHoles_;
+    std::size_t vertexThreshold_;
   public:
     inline polygon_arbitrary_formation() :
-      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0) {
+      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0),
+      vertexThreshold_((std::numeric_limits<std::size_t>::max)()) {
       less_vertex_half_edge lessElm(&x_, &justBefore_);
       scanData_ = scanline_data(lessElm);
     }
     inline polygon_arbitrary_formation(bool fractureHoles) :
-      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles) {
+      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles),
+      vertexThreshold_((std::numeric_limits<std::size_t>::max)()) {
+      less_vertex_half_edge lessElm(&x_, &justBefore_);
+      scanData_ = scanline_data(lessElm);
+    }
+    //a figure that reaches vertexThreshold points, the points of its holes included, is cut along
+    //a segment across one of its solid intervals when an edge of that interval ends, the part left
+    //of the segment is written out and the part right of it begun again from the segment
+    inline polygon_arbitrary_formation(bool fractureHoles, std::size_t vertexThreshold) :
+      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(fractureHoles),
+      vertexThreshold_(vertexThreshold) {
       less_vertex_half_edge lessElm(&x_, &justBefore_);
       scanData_ = scanline_data(lessElm);
     }
     inline polygon_arbitrary_formation(const polygon_arbitrary_formation& that) :
-      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0) { (*this) = that; }
+      scanData_(), x_((std::numeric_limits<Unit>::min)()), justBefore_(false), fractureHoles_(0),
+      vertexThreshold_((std::numeric_limits<std::size_t>::max)()) { (*this) = that; }
     inline polygon_arbitrary_formation& operator=(const polygon_arbitrary_formation& that) {
       x_ = that.x_;
       justBefore_ = that.justBefore_;
       fractureHoles_ = that.fractureHoles_;
+      vertexThreshold_ = that.vertexThreshold_;
       less_vertex_half_edge lessElm(&x_, &justBefore_);
       scanData_ = scanline_data(lessElm);
       for(const_iterator itr = that.scanData_.begin(); itr != that.scanData_.end(); ++itr){
@@ -1652,6 +1720,8 @@ namespace boost { namespace polygon{
       typedef typename high_precision_type<Unit>::type high_precision;
       //std::cout << "processEvent_\n";
       justBefore_ = true;
+      if(vertexThreshold_ != (std::numeric_limits<std::size_t>::max)())
+        cutFigures_(output, inputBegin, inputEnd);
       //collect up all elements from the tree that are at the y
       //values of events in the input queue
       //create vector of new elements to add into tree
@@ -1758,6 +1828,7 @@ namespace boost { namespace polygon{
               Point point(x_, fracture_y);
               verticalTail->getOtherActiveTail()->pushPoint(point);
               iter->second = verticalTail->getOtherActiveTail();
+              iter->second->setAboveX(x_);
               at->pushPoint(point);
               verticalTail->join(at);
               delete at;
@@ -1780,12 +1851,26 @@ namespace boost { namespace polygon{
       }
       //switch comparison tie breaking policy
       justBefore_ = false;
+      bool cutting = vertexThreshold_ != (std::numeric_limits<std::size_t>::max)();
+      if(cutting) {
+        //the element below an event has a new element above it
+        for(iT eventIter = inputBegin; eventIter != currentIter; ++eventIter) {
+          iterator iter = lookUp_(eventIter->pt.get(VERTICAL));
+          if(iter != scanData_.begin())
+            (--iter)->second->setAboveX(x_);
+        }
+      }
       //add new elements into tree
       //std::cout << "inserting\n";
       for(typename std::vector<std::pair<vertex_half_edge, active_tail_arbitrary*> >::iterator iter = elements.begin();
           iter != elements.end(); ++iter) {
         //std::cout << "inserting loop\n";
-        scanData_.insert(scanData_.end(), *iter);
+        iterator inserted = scanData_.insert(scanData_.end(), *iter);
+        if(cutting) {
+          inserted->second->setAboveX(x_);
+          if(inserted != scanData_.begin())
+            (--inserted)->second->setAboveX(x_);
+        }
       }
       //std::cout << "end processEvent\n";
       return currentIter;
@@ -1797,6 +1882,101 @@ namespace boost { namespace polygon{
       return scanData_.lower_bound(vertex_half_edge(Point(x_, y), Point(x_, y+1), 0));
     }
 
+    //an edge of a solid interval gets a point pushed on its tail only when it ends, so the
+    //figures are checked against vertexThreshold_ at the elements that end at x_, before the
+    //events at x_ are applied
+    template <class cT, class iT>
+    inline void cutFigures_(cT& output, iT inputBegin, iT inputEnd) {
+      while(inputBegin != inputEnd && inputBegin->pt.get(HORIZONTAL) == x_) {
+        Unit currentY = inputBegin->pt.get(VERTICAL);
+        for(iterator iter = lookUp_(currentY); iter != scanData_.end() &&
+              iter->first.other_pt == Point(x_, currentY); ++iter)
+          cutFigure_(output, iter);
+        while(inputBegin != inputEnd && inputBegin->pt.get(HORIZONTAL) == x_ &&
+              inputBegin->pt.get(VERTICAL) == currentY)
+          ++inputBegin;
+      }
+    }
+
+    //the solid is above an element of count 1 and below an element of count -1, between the tail
+    //of the lower element at L and of the upper one at U; when the lower element ends at E on x_
+    //and L is not right of U the segment from U to E lies in the solid between the two edges, and
+    //nothing else crosses it if the two elements have been next to each other since U, likewise
+    //from L to the end of the upper element
+    template <class cT>
+    inline void cutFigure_(cT& output, iterator iter) {
+      iterator lower = iter;
+      iterator upper = iter;
+      if(iter->first.count == 1) {
+        ++upper;
+        if(upper == scanData_.end() || upper->first.count != -1) return;
+      } else {
+        if(iter->first.count != -1 || iter == scanData_.begin()) return;
+        --lower;
+        if(lower->first.count != 1) return;
+      }
+      active_tail_arbitrary* lowTail = lower->second;
+      active_tail_arbitrary* highTail = upper->second;
+      //one chain or two, the point added by the cut and the first point, which the ring is written
+      //out with again
+      std::size_t points = lowTail->getTail()->size() + lowTail->getHolePoints() +
+        lowTail->getOtherActiveTail()->getHolePoints() + 2;
+      if(highTail->getTail() != lowTail->getTail())
+        points += highTail->getTail()->size() + highTail->getHolePoints() +
+          highTail->getOtherActiveTail()->getHolePoints();
+      if(points < vertexThreshold_) return;
+      //pushing onto a chain of one point does not check for a repeated point
+      if(lowTail->getTail()->size() < 2 || highTail->getTail()->size() < 2) return;
+      Point lowPoint = lowTail->getPoint();
+      Point highPoint = highTail->getPoint();
+      Point lowEnd = lower->first.other_pt;
+      Point highEnd = upper->first.other_pt;
+      bool lowEnds = lowEnd.get(HORIZONTAL) == x_;
+      bool highEnds = highEnd.get(HORIZONTAL) == x_;
+      if(lowEnd == highEnd) return;
+      Unit cutX = (std::max)(lowPoint.get(HORIZONTAL), highPoint.get(HORIZONTAL));
+      //an edge that was between the two right of cutX could cross the segment
+      if(lowTail->getAboveX() > cutX) return;
+      if(lowTail->getHolesEndX() >= cutX || lowTail->getOtherActiveTail()->getHolesEndX() >= cutX ||
+         highTail->getHolesEndX() >= cutX || highTail->getOtherActiveTail()->getHolesEndX() >= cutX)
+        return;
+      if(lowEnds && lowPoint.get(HORIZONTAL) <= highPoint.get(HORIZONTAL)) {
+        //the element below the lower one must not end at the same point
+        if(lower != scanData_.begin()) {
+          iterator below = lower;
+          --below;
+          if(below->first.other_pt == lowEnd) return;
+        }
+        if(scanline_base<Unit>::on_above_or_below(highPoint, half_edge(lowPoint, lowEnd)) != 1 ||
+           scanline_base<Unit>::on_above_or_below(lowEnd, half_edge(highPoint, highEnd)) != -1)
+          return;
+        lowTail->pushPoint(lowEnd);
+        active_tail_arbitrary::joinChains(highPoint, highTail, lowTail, true, output);
+        std::pair<active_tail_arbitrary*, active_tail_arbitrary*> tailPair =
+          active_tail_arbitrary::createActiveTailsAsPair(lowEnd, true, 0, false);
+        tailPair.first->pushPoint(highPoint);
+        upper->second = tailPair.first;
+        lower->second = tailPair.second;
+        tailPair.second->setAboveX(x_);
+      } else if(highEnds && highPoint.get(HORIZONTAL) <= lowPoint.get(HORIZONTAL)) {
+        //the element above the upper one must not end at the same point
+        iterator above = upper;
+        ++above;
+        if(above != scanData_.end() && above->first.other_pt == highEnd) return;
+        if(scanline_base<Unit>::on_above_or_below(lowPoint, half_edge(highPoint, highEnd)) != -1 ||
+           scanline_base<Unit>::on_above_or_below(highEnd, half_edge(lowPoint, lowEnd)) != 1)
+          return;
+        highTail->pushPoint(highEnd);
+        active_tail_arbitrary::joinChains(lowPoint, lowTail, highTail, true, output);
+        std::pair<active_tail_arbitrary*, active_tail_arbitrary*> tailPair =
+          active_tail_arbitrary::createActiveTailsAsPair(lowPoint, true, 0, false);
+        tailPair.first->pushPoint(highEnd);
+        upper->second = tailPair.first;
+        lower->second = tailPair.second;
+        tailPair.second->setAboveX(x_);
+      }
+    }
+
   public: //test functions
 
     template <typename stream_type>
@@ -7,10 +7,20 @@
 */
 #include<iostream>
 #include<cassert>
+#include<new>
 #ifndef BOOST_POLYGON_POLYGON_FORMATION_HPP
 #define BOOST_POLYGON_POLYGON_FORMATION_HPP
+#include "parallel_for.hpp"
 namespace boost { namespace polygon{
 
+  //forward declaration, figures that cross slab boundaries are stitched through a polygon set
+  template <typename T>
+  class polygon_90_set_data;
+
+  //forward declaration
+  template <typename T>
+  class polygon_buffer;
+
 namespace polygon_formation {
 
   /*
@@ -289,6 +299,10 @@ namespace polygon_formation {
   template<bool orientT, typename Unit>
   class PolyLinePolygonWithHolesData;
 
+  //forward declaration
+  template <typename Unit>
+  class PolyLineArena;
+
   /*
    * ActiveTail represents an edge of an incomplete polygon.
    *
@@ -321,6 +335,8 @@ namespace polygon_formation {
     std::list<ActiveTail*> holesList_;
     //Sum of all the polylines which constitute the active tail (including holes)//
     size_t polyLineSize_;  
+    //arena this active tail and its polylines were allocated from (0 for the heap)//
+    PolyLineArena<Unit>* arena_;
   public:
 
     inline size_t getPolyLineSize(){
@@ -455,8 +471,12 @@ namespace polygon_formation {
     //default constructor
     ActiveTail();
 
+    //constructor for an empty active tail owned by an arena
+    explicit ActiveTail(PolyLineArena<Unit>* arena);
+
     //constructor
-    ActiveTail(orientation_2d orient, Unit coord, Side solidToRight, ActiveTail* otherTailp);
+    ActiveTail(orientation_2d orient, Unit coord, Side solidToRight, ActiveTail* otherTailp,
+               PolyLineArena<Unit>* arena = 0);
 
     //constructor
     ActiveTail(PolyLine<Unit>* active, ActiveTail* otherTailp);
@@ -496,6 +516,11 @@ namespace polygon_formation {
      */
     ActiveTail* getOtherActiveTail() const;
 
+    /*
+     * get the arena this active tail was allocated from, 0 if it came from the heap
+     */
+    PolyLineArena<Unit>* getArena() const;
+
     /*
      * test if another active tail is the other end of the chain
      */
@@ -547,6 +572,12 @@ namespace polygon_formation {
      */
     void writeOutFigure(std::vector<Unit>& outVec, bool isHole = false) const;
 
+    /*
+     * write the figure that this active tail points to out to buffer as one polygon, in the frame of
+     * orient and in the same order as the iterators, followed by its holes unless it is a hole
+     */
+    void writeOutFigure(polygon_buffer<Unit>& buffer, bool isHole, orientation_2d orient) const;
+
     /*
      * write the figure that this active tail points to out through iterators
      */
@@ -561,6 +592,18 @@ namespace polygon_formation {
     iteratorHoles beginHoles() const;
     iteratorHoles endHoles() const;
 
+    /*
+     * number of coordinates in the figure that this active tail points to, holes included
+     */
+    std::size_t countCoordinates() const;
+
+  private:
+    /*
+     * append the compact coordinates of the ring of iterator(this, isHole, orient) a PolyLine at a time
+     */
+    void writeOutRing(std::vector<Unit>& outVec, bool isHole, orientation_2d orient) const;
+  public:
+
     /*
      * joins the two chains that the two active tail tails are ends of
      * checks for closure of figure and writes out polygons appropriately
@@ -581,19 +624,145 @@ namespace polygon_formation {
     void destroyContents();
   };
 
-  /* allocate a polyline object */
+  /*
+   * SlabPool hands out storage for objects of one type from large slabs instead of one heap
+   * allocation per object.  Destroyed objects go onto an intrusive free list and are reused
+   * first.  Once no object is live the pool can be rewound in O(1) with reset(), which keeps the
+   * slabs for the next scanline, or given back to the system with release().
+   */
+  template <typename T>
+  class SlabPool {
+  private:
+    struct FreeNode { FreeNode* next_; };
+    std::vector<T*> slabs_;
+    std::size_t slabSize_;
+    std::size_t slab_;   //index of the slab we are carving from
+    std::size_t cursor_; //next unused object in that slab
+    FreeNode* free_;
+    std::size_t live_;
+    //not copyable, the free list points into our own slabs
+    SlabPool(const SlabPool&);
+    SlabPool& operator=(const SlabPool&);
+  public:
+    inline explicit SlabPool(std::size_t slabSize = 1024) : slabs_(), slabSize_(slabSize ? slabSize : 1),
+      slab_(0), cursor_(0), free_(0), live_(0) {}
+    inline ~SlabPool() { release(); }
+
+    //raw storage for one T, the caller constructs into it
+    inline void* allocate() {
+      ++live_;
+      if(free_) {
+        FreeNode* node = free_;
+        free_ = node->next_;
+        return node;
+      }
+      if(slab_ < slabs_.size() && cursor_ == slabSize_) {
+        ++slab_;
+        cursor_ = 0;
+      }
+      if(slab_ == slabs_.size())
+        slabs_.push_back(static_cast<T*>(::operator new(sizeof(T) * slabSize_)));
+      return slabs_[slab_] + cursor_++;
+    }
+
+    //return storage of an already destroyed T to the pool
+    inline void deallocate(void* p) {
+      FreeNode* node = static_cast<FreeNode*>(p);
+      node->next_ = free_;
+      free_ = node;
+      --live_;
+    }
+
+    //number of objects handed out and not yet given back
+    inline std::size_t live() const { return live_; }
+
+    //bytes of slab storage currently held
+    inline std::size_t capacity() const { return slabs_.size() * slabSize_ * sizeof(T); }
+
+    //forget every object at once and start carving from the first slab again, only valid when
+    //nothing allocated from the pool is still referenced
+    inline void reset() {
+      slab_ = 0;
+      cursor_ = 0;
+      free_ = 0;
+      live_ = 0;
+    }
+
+    //give the slabs back to the system
+    inline void release() {
+      for(std::size_t i = 0; i < slabs_.size(); ++i)
+        ::operator delete(slabs_[i]);
+      slabs_.clear();
+      reset();
+    }
+  };
+
+  /*
+   * PolyLineArena owns the PolyLine and ActiveTail objects of a polygon formation scanline.
+   * Each ScanLineToPolygonItrs has one by default; a caller can also pass its own to
+   * get_polygons to keep the slabs warm across many calls (for example one per layer).
+   * The arena must outlive every figure allocated from it and is not thread safe, use
+   * one arena per concurrently running scanline.
+   */
   template <typename Unit>
-  PolyLine<Unit>* createPolyLine(orientation_2d orient, Unit coord, Side side);
+  class PolyLineArena {
+  private:
+    SlabPool<PolyLine<Unit> > polyLines_;
+    SlabPool<ActiveTail<Unit> > activeTails_;
+    //coordinates held by the live polylines
+    std::size_t liveVertices_;
+    PolyLineArena(const PolyLineArena&);
+    PolyLineArena& operator=(const PolyLineArena&);
+  public:
+    inline explicit PolyLineArena(std::size_t slabSize = 1024) : polyLines_(slabSize), activeTails_(slabSize),
+      liveVertices_(0) {}
+
+    inline PolyLine<Unit>* createPolyLine(orientation_2d orient, Unit coord, Side side) {
+      ++liveVertices_;
+      return new (polyLines_.allocate()) PolyLine<Unit>(orient, coord, side);
+    }
+    inline void destroyPolyLine(PolyLine<Unit>* pLine) {
+      liveVertices_ -= pLine->numSegments();
+      pLine->~PolyLine<Unit>();
+      polyLines_.deallocate(pLine);
+    }
+    inline ActiveTail<Unit>* createActiveTail() {
+      return new (activeTails_.allocate()) ActiveTail<Unit>(this);
+    }
+    inline void destroyActiveTail(ActiveTail<Unit>* aTail) {
+      aTail->~ActiveTail<Unit>();
+      activeTails_.deallocate(aTail);
+    }
+
+    //true when no polyline or active tail allocated from this arena is alive
+    inline bool empty() const { return polyLines_.live() == 0 && activeTails_.live() == 0; }
+    inline std::size_t livePolyLines() const { return polyLines_.live(); }
+    inline std::size_t liveActiveTails() const { return activeTails_.live(); }
+    inline std::size_t liveVertices() const { return liveVertices_; }
+    //called by ActiveTail when coordinates are pushed to or merged away from its polyline
+    inline void addVertices(int delta) { liveVertices_ += delta; }
+    inline std::size_t capacity() const { return polyLines_.capacity() + activeTails_.capacity(); }
+
+    //bulk release, only valid when the arena is empty, keeps the slabs for reuse
+    inline void reset() { polyLines_.reset(); activeTails_.reset(); liveVertices_ = 0; }
+
+    //return all slab memory to the system, only valid when the arena is empty
+    inline void release() { polyLines_.release(); activeTails_.release(); }
+  };
+
+  /* allocate a polyline object, from the arena if one is given */
+  template <typename Unit>
+  PolyLine<Unit>* createPolyLine(orientation_2d orient, Unit coord, Side side, PolyLineArena<Unit>* arena = 0);
 
   /* deallocate a polyline object */
   template <typename Unit>
-  void destroyPolyLine(PolyLine<Unit>* pLine);
+  void destroyPolyLine(PolyLine<Unit>* pLine, PolyLineArena<Unit>* arena = 0);
 
-  /* allocate an activetail object */
+  /* allocate an activetail object, from the arena if one is given */
   template <typename Unit>
-  ActiveTail<Unit>* createActiveTail();
+  ActiveTail<Unit>* createActiveTail(PolyLineArena<Unit>* arena = 0);
 
-  /* deallocate an activetail object */
+  /* deallocate an activetail object, returns it to the arena it came from */
   template <typename Unit>
   void destroyActiveTail(ActiveTail<Unit>* aTail);
      
@@ -709,18 +878,380 @@ namespace polygon_formation {
   template <bool orientT, typename Unit>
   struct PolyLineType<orientT, Unit, polygon_concept> { typedef PolyLineHoleData<orientT, Unit> type; };
 
-  template <bool orientT, typename Unit, typename polygon_concept_type>
+  //the concept figures are formed as for get_polygons_to_sink: the geometry_concept of a polygon
+  //type, or the type itself when it is a concept
+  template <typename T, typename concept_type = typename geometry_concept<T>::type>
+  struct SinkConcept { typedef concept_type type; };
+  template <typename T>
+  struct SinkConcept<T, undefined_concept> { typedef T type; };
+
+  /*
+   * FlatTailMap is the sorted map from y to ActiveTail used by the polygon formation scanline.
+   * Entries live in contiguous blocks of at most BLOCK_SIZE pairs, indexed by the first key of
+   * each block, so a lookup is a binary search over a small contiguous array followed by one
+   * inside a block instead of a walk down a red-black tree with a cache miss per level.  Inserts
+   * and erases shift at most one block.  The block of the last access is kept as a cursor hint;
+   * because the scanline visits keys in increasing order at each scan stop nearly every lookup
+   * starts in the right block.
+   *
+   * The interface is the subset of std::map the scanline uses and iterators keep the std::map
+   * guarantee that inserting or erasing other keys does not invalidate them: an iterator
+   * remembers its key and relocates itself through the cursor if the map changed since it was
+   * last dereferenced.
+   */
+  template <typename Key, typename T>
+  class FlatTailMap {
+  public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+    enum { BLOCK_SIZE = 128 };
+  private:
+    typedef std::vector<value_type> block_type;
+    std::vector<block_type*> blocks_;
+    std::vector<Key> firstKeys_;
+    std::size_t size_;
+    //bumped whenever an element changes position so that iterators know to relocate
+    std::size_t version_;
+    std::size_t cursor_;
+
+    //index of the block that holds key or would hold it if it were inserted
+    inline std::size_t findBlock(const Key& key) {
+      std::size_t n = blocks_.size();
+      if(cursor_ < n && !(key < firstKeys_[cursor_])) {
+        if(cursor_ + 1 == n || key < firstKeys_[cursor_ + 1]) return cursor_;
+        if(cursor_ + 2 == n || key < firstKeys_[cursor_ + 2]) return ++cursor_;
+      }
+      typename std::vector<Key>::iterator itr = std::upper_bound(firstKeys_.begin(), firstKeys_.end(), key);
+      cursor_ = itr == firstKeys_.begin() ? 0 : (itr - firstKeys_.begin()) - 1;
+      return cursor_;
+    }
+
+    inline std::size_t lowerBoundInBlock(std::size_t b, const Key& key) const {
+      const block_type& block = *blocks_[b];
+      std::size_t lo = 0, hi = block.size();
+      while(lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if(block[mid].first < key) lo = mid + 1;
+        else hi = mid;
+      }
+      return lo;
+    }
+
+    //finds the position of key, returns false if it is not in the map
+    inline bool locate(const Key& key, std::size_t& b, std::size_t& o) {
+      if(blocks_.empty()) return false;
+      b = findBlock(key);
+      o = lowerBoundInBlock(b, key);
+      return o < blocks_[b]->size() && !(key < (*blocks_[b])[o].first);
+    }
+
+    inline void removeBlock(std::size_t b) {
+      delete blocks_[b];
+      blocks_.erase(blocks_.begin() + b);
+      firstKeys_.erase(firstKeys_.begin() + b);
+      cursor_ = 0;
+    }
+
+    //merge a small block into a neighbor so the block index stays short
+    inline void mergeSmallBlock(std::size_t b) {
+      block_type& block = *blocks_[b];
+      if(block.size() >= (std::size_t)BLOCK_SIZE / 4) return;
+      if(b + 1 < blocks_.size() && block.size() + blocks_[b + 1]->size() <= (std::size_t)BLOCK_SIZE) {
+        block.insert(block.end(), blocks_[b + 1]->begin(), blocks_[b + 1]->end());
+        removeBlock(b + 1);
+      } else if(b > 0 && block.size() + blocks_[b - 1]->size() <= (std::size_t)BLOCK_SIZE) {
+        blocks_[b - 1]->insert(blocks_[b - 1]->end(), block.begin(), block.end());
+        removeBlock(b);
+      }
+    }
+
+    inline void copyFrom(const FlatTailMap& that) {
+      for(std::size_t i = 0; i < that.blocks_.size(); ++i)
+        blocks_.push_back(new block_type(*that.blocks_[i]));
+      firstKeys_ = that.firstKeys_;
+      size_ = that.size_;
+    }
+
+  public:
+    class iterator {
+    private:
+      FlatTailMap* map_;
+      std::size_t block_;
+      std::size_t offset_;
+      std::size_t version_;
+      Key key_;
+      bool end_;
+      inline void sync() const {
+        if(!end_ && version_ != map_->version_) {
+          iterator& self = const_cast<iterator&>(*this);
+          bool found = self.map_->locate(key_, self.block_, self.offset_);
+          assert(found);
+          (void)found;
+          self.version_ = map_->version_;
+        }
+      }
+      inline void setPosition(std::size_t b, std::size_t o) {
+        block_ = b;
+        offset_ = o;
+        end_ = b >= map_->blocks_.size();
+        if(!end_) key_ = (*map_->blocks_[b])[o].first;
+      }
+      friend class FlatTailMap;
+    public:
+      inline iterator() : map_(0), block_(0), offset_(0), version_(0), key_(), end_(true) {}
+      inline iterator(FlatTailMap* map, std::size_t b, std::size_t o) :
+        map_(map), block_(0), offset_(0), version_(map->version_), key_(), end_(true) {
+        setPosition(b, o);
+      }
+      //use bitwise copy and assign provided by the compiler
+      inline value_type& operator*() const {
+        sync();
+        return (*map_->blocks_[block_])[offset_];
+      }
+      inline value_type* operator->() const { return &(**this); }
+      inline iterator& operator++() {
+        if(end_) return *this;
+        sync();
+        if(offset_ + 1 < map_->blocks_[block_]->size()) setPosition(block_, offset_ + 1);
+        else setPosition(block_ + 1, 0);
+        return *this;
+      }
+      inline const iterator operator++(int) {
+        iterator tmp(*this);
+        ++(*this);
+        return tmp;
+      }
+      //decrementing the first element yields end(), which the scanline asserts against
+      inline iterator& operator--() {
+        if(end_) {
+          if(map_ && !map_->blocks_.empty()) {
+            version_ = map_->version_;
+            setPosition(map_->blocks_.size() - 1, map_->blocks_.back()->size() - 1);
+          }
+          return *this;
+        }
+        sync();
+        if(offset_) setPosition(block_, offset_ - 1);
+        else if(block_) setPosition(block_ - 1, map_->blocks_[block_ - 1]->size() - 1);
+        else end_ = true;
+        return *this;
+      }
+      inline const iterator operator--(int) {
+        iterator tmp(*this);
+        --(*this);
+        return tmp;
+      }
+      inline bool operator==(const iterator& that) const {
+        if(end_ || that.end_) return end_ == that.end_;
+        return !(key_ < that.key_) && !(that.key_ < key_);
+      }
+      inline bool operator!=(const iterator& that) const { return !(*this == that); }
+    };
+
+    inline FlatTailMap() : blocks_(), firstKeys_(), size_(0), version_(0), cursor_(0) {}
+    inline FlatTailMap(const FlatTailMap& that) : blocks_(), firstKeys_(), size_(0), version_(0), cursor_(0) {
+      copyFrom(that);
+    }
+    inline FlatTailMap& operator=(const FlatTailMap& that) {
+      if(this != &that) {
+        clear();
+        copyFrom(that);
+      }
+      return *this;
+    }
+    inline ~FlatTailMap() { clear(); }
+
+    inline iterator begin() { return iterator(this, 0, 0); }
+    inline iterator end() { return iterator(this, blocks_.size(), 0); }
+    inline bool empty() const { return size_ == 0; }
+    inline std::size_t size() const { return size_; }
+
+    inline void clear() {
+      for(std::size_t i = 0; i < blocks_.size(); ++i)
+        delete blocks_[i];
+      blocks_.clear();
+      firstKeys_.clear();
+      size_ = 0;
+      cursor_ = 0;
+      ++version_;
+    }
+
+    inline iterator find(const Key& key) {
+      std::size_t b, o;
+      if(locate(key, b, o)) return iterator(this, b, o);
+      return end();
+    }
+
+    inline iterator lower_bound(const Key& key) {
+      if(blocks_.empty()) return end();
+      std::size_t b = findBlock(key);
+      std::size_t o = lowerBoundInBlock(b, key);
+      if(o == blocks_[b]->size()) return iterator(this, b + 1, 0);
+      return iterator(this, b, o);
+    }
+
+    //the hint is accepted for compatibility with std::map, the cursor plays its role
+    inline iterator insert(iterator, const value_type& value) {
+      return insert(value).first;
+    }
+
+    inline std::pair<iterator, bool> insert(const value_type& value) {
+      if(blocks_.empty()) {
+        blocks_.push_back(new block_type());
+        blocks_.back()->reserve(BLOCK_SIZE + 1);
+        firstKeys_.push_back(value.first);
+        cursor_ = 0;
+      }
+      std::size_t b = findBlock(value.first);
+      std::size_t o = lowerBoundInBlock(b, value.first);
+      block_type& block = *blocks_[b];
+      if(o < block.size() && !(value.first < block[o].first))
+        return std::make_pair(iterator(this, b, o), false);
+      block.insert(block.begin() + o, value);
+      if(o == 0) firstKeys_[b] = value.first;
+      ++size_;
+      ++version_;
+      if(block.size() > (std::size_t)BLOCK_SIZE) {
+        //split the block in half
+        std::size_t half = block.size() / 2;
+        block_type* upper = new block_type(block.begin() + half, block.end());
+        upper->reserve(BLOCK_SIZE + 1);
+        block.erase(block.begin() + half, block.end());
+        blocks_.insert(blocks_.begin() + b + 1, upper);
+        firstKeys_.insert(firstKeys_.begin() + b + 1, (*upper)[0].first);
+        if(o >= half) {
+          ++b;
+          o -= half;
+        }
+        cursor_ = b;
+      }
+      return std::make_pair(iterator(this, b, o), true);
+    }
+
+    inline void erase(iterator itr) {
+      itr.sync();
+      std::size_t b = itr.block_;
+      block_type& block = *blocks_[b];
+      block.erase(block.begin() + itr.offset_);
+      --size_;
+      ++version_;
+      if(block.empty()) {
+        removeBlock(b);
+        return;
+      }
+      firstKeys_[b] = block[0].first;
+      mergeSmallBlock(b);
+    }
+
+    inline std::size_t erase(const Key& key) {
+      iterator itr = find(key);
+      if(itr == end()) return 0;
+      erase(itr);
+      return 1;
+    }
+
+    //Replaces the count elements from first on with the values [begin, end), which must be sorted
+    //and fall between the elements around the replaced ones.  Within a block this shifts the block
+    //once, where erasing and inserting the elements one at a time would shift it for each.
+    template <typename iterator_type>
+    inline void replace(iterator first, std::size_t count, iterator_type begin, iterator_type end) {
+      first.sync();
+      if(first.end_ || first.offset_ + count > blocks_[first.block_]->size()) {
+        std::vector<Key> keys;
+        for(std::size_t i = 0; i < count; ++i, ++first)
+          keys.push_back((*first).first);
+        for(std::size_t i = 0; i < keys.size(); ++i)
+          erase(keys[i]);
+        for( ; begin != end; ++begin)
+          insert(*begin);
+        return;
+      }
+      std::size_t b = first.block_;
+      block_type& block = *blocks_[b];
+      typename block_type::iterator position = block.begin() + first.offset_;
+      std::size_t kept = 0;
+      for( ; kept < count && begin != end; ++kept, ++begin)
+        *position++ = *begin;
+      position = block.erase(position, position + (count - kept));
+      std::size_t inserted = block.size();
+      block.insert(position, begin, end);
+      inserted = block.size() - inserted;
+      size_ = size_ + inserted + kept - count;
+      ++version_;
+      if(block.empty()) {
+        removeBlock(b);
+        return;
+      }
+      firstKeys_[b] = block[0].first;
+      cursor_ = b;
+      while(blocks_[b]->size() > (std::size_t)BLOCK_SIZE) {
+        //split off full halves until the block fits
+        block_type& full = *blocks_[b];
+        std::size_t half = (std::size_t)BLOCK_SIZE / 2;
+        block_type* upper = new block_type(full.begin() + half, full.end());
+        upper->reserve(BLOCK_SIZE + 1);
+        full.erase(full.begin() + half, full.end());
+        blocks_.insert(blocks_.begin() + b + 1, upper);
+        firstKeys_.insert(firstKeys_.begin() + b + 1, (*upper)[0].first);
+        ++b;
+      }
+      mergeSmallBlock(b);
+    }
+  };
+
+  /*
+   * FormationStats collects counters from the scanlines it is given to, see
+   * ScanLineToPolygonItrs::setStats.  Counts add up and peaks are maxima over every scanline
+   * it was given to, so one struct can cover several get_polygons calls (for example one layer).
+   */
+  struct FormationStats {
+    //most active tails in the tail map at the end of a scan stop
+    std::size_t peakTailMapSize;
+    //most coordinates held by live polylines at the end of a scan stop, the memory high water mark
+    std::size_t peakLiveVertices;
+    //scan stops with at least one vertical edge
+    std::size_t scanStops;
+    //figures output
+    std::size_t polygonsEmitted;
+    //partial figures closed early because of the vertex threshold
+    std::size_t thresholdCuts;
+    //coordinates of the figures output, holes included
+    std::size_t coordinatesWritten;
+
+    inline FormationStats() : peakTailMapSize(0), peakLiveVertices(0), scanStops(0),
+      polygonsEmitted(0), thresholdCuts(0), coordinatesWritten(0) {}
+  };
+
+  template <bool orientT, typename Unit, typename polygon_concept_type,
+            typename tail_map_type = FlatTailMap<Unit, ActiveTail<Unit>*> >
   class ScanLineToPolygonItrs {
   private:
-    std::map<Unit, ActiveTail<Unit>*> tailMap_;
+    tail_map_type tailMap_;
     typedef typename PolyLineType<orientT, Unit, polygon_concept_type>::type PolyLinePolygonData;
     std::vector<PolyLinePolygonData> outputPolygons_;
     bool fractureHoles_;
+    PolyLineArena<Unit> arena_;
+    //arena that all partial figures are allocated from, either arena_ or one supplied by the caller
+    PolyLineArena<Unit>* arenap_;
+    //counters to update, 0 unless requested with setStats
+    FormationStats* stats_;
+    //the arena holds pointers into itself, do not copy
+    ScanLineToPolygonItrs(const ScanLineToPolygonItrs&);
+    ScanLineToPolygonItrs& operator=(const ScanLineToPolygonItrs&);
   public:
     typedef typename std::vector<PolyLinePolygonData>::iterator iterator; 
-    inline ScanLineToPolygonItrs() : tailMap_(), outputPolygons_(), fractureHoles_(false)  {}
+    inline ScanLineToPolygonItrs() : tailMap_(), outputPolygons_(), fractureHoles_(false), arena_(), arenap_(&arena_),
+      stats_(0) {}
     /* construct a scanline with the proper offsets, protocol and options */
-    inline ScanLineToPolygonItrs(bool fractureHoles) : tailMap_(), outputPolygons_(), fractureHoles_(fractureHoles) {}
+    inline ScanLineToPolygonItrs(bool fractureHoles) : tailMap_(), outputPolygons_(), fractureHoles_(fractureHoles),
+      arena_(), arenap_(&arena_), stats_(0) {}
+    /* construct a scanline that allocates its partial figures from a caller supplied arena */
+    inline ScanLineToPolygonItrs(bool fractureHoles, PolyLineArena<Unit>* arena) : tailMap_(), outputPolygons_(),
+      fractureHoles_(fractureHoles), arena_(), arenap_(arena ? arena : &arena_), stats_(0) {}
+
+    /* update stats at every scan stop from now on, 0 to stop */
+    inline void setStats(FormationStats* stats) { stats_ = stats; }
    
     ~ScanLineToPolygonItrs() { clearOutput_(); }
    
@@ -748,11 +1279,11 @@ namespace polygon_formation {
          size_t vertexThreshold=(std::numeric_limits<size_t>::max)());
 
     void insertNewLeftEdgeIntoTailMap(Unit, Unit, Unit,
-      typename std::map<Unit, ActiveTail<Unit>*>::iterator &);
+      typename tail_map_type::iterator &);
     /**********************************************************************/
 
     inline size_t getTailMapSize(){
-       typename std::map<Unit, ActiveTail<Unit>* >::const_iterator itr;
+       typename tail_map_type::iterator itr;
        size_t tsize = 0;
        for(itr=tailMap_.begin(); itr!=tailMap_.end(); ++itr){
           tsize +=  (itr->second)->getPolyLineSize();
@@ -761,7 +1292,7 @@ namespace polygon_formation {
     }
    /*print the active tails in this map:*/
    inline void print(){
-      typename std::map<Unit, ActiveTail<Unit>* >::const_iterator itr;
+      typename tail_map_type::iterator itr;
       printf("=========TailMap[%lu]=========\n", tailMap_.size());
       for(itr=tailMap_.begin(); itr!=tailMap_.end(); ++itr){
          std::cout<< "[" << itr->first << "] : " << std::endl;
@@ -796,6 +1327,9 @@ namespace polygon_formation {
    
   private:
     void clearOutput_();
+    void recordStats_(bool edges);
+    void closeFigure_(Unit currentX, ActiveTail<Unit>* pfig, ActiveTail<Unit>* ppfig);
+    static bool movedAt_(const PolyLine<Unit>* tail, Unit currentX);
   };
 
   /*
@@ -1113,12 +1647,17 @@ namespace polygon_formation {
 
   template <typename Unit>
   inline ActiveTail<Unit>::ActiveTail() : tailp_(0), otherTailp_(0), holesList_(), 
-   polyLineSize_(0) {}
+   polyLineSize_(0), arena_(0) {}
+
+  template <typename Unit>
+  inline ActiveTail<Unit>::ActiveTail(PolyLineArena<Unit>* arena) : tailp_(0), otherTailp_(0), holesList_(), 
+   polyLineSize_(0), arena_(arena) {}
 
   template <typename Unit>
-  inline ActiveTail<Unit>::ActiveTail(orientation_2d orient, Unit coord, Side solidToRight, ActiveTail* otherTailp) : 
-    tailp_(0), otherTailp_(0), holesList_(), polyLineSize_(0) {
-    tailp_ = createPolyLine(orient, coord, solidToRight);
+  inline ActiveTail<Unit>::ActiveTail(orientation_2d orient, Unit coord, Side solidToRight, ActiveTail* otherTailp,
+                                      PolyLineArena<Unit>* arena) : 
+    tailp_(0), otherTailp_(0), holesList_(), polyLineSize_(0), arena_(arena) {
+    tailp_ = createPolyLine(orient, coord, solidToRight, arena);
     otherTailp_ = otherTailp;
     polyLineSize_ = tailp_->numSegments();
   }
@@ -1126,11 +1665,11 @@ namespace polygon_formation {
   template <typename Unit>
   inline ActiveTail<Unit>::ActiveTail(PolyLine<Unit>* active, ActiveTail<Unit>* otherTailp) : 
     tailp_(active), otherTailp_(otherTailp), holesList_(), 
-      polyLineSize_(0) {}
+      polyLineSize_(0), arena_(0) {}
 
   //copy constructor
   template <typename Unit>
-  inline ActiveTail<Unit>::ActiveTail(const ActiveTail<Unit>& that) : tailp_(that.tailp_), otherTailp_(that.otherTailp_), holesList_(), polyLineSize_(that.polyLineSize_) {}
+  inline ActiveTail<Unit>::ActiveTail(const ActiveTail<Unit>& that) : tailp_(that.tailp_), otherTailp_(that.otherTailp_), holesList_(), polyLineSize_(that.polyLineSize_), arena_(that.arena_) {}
 
   //destructor
   template <typename Unit>
@@ -1139,6 +1678,7 @@ namespace polygon_formation {
     tailp_ = 0; otherTailp_ = 0; 
   }
 
+  //the arena is where this object lives, so it is not assigned
   template <typename Unit>
   inline ActiveTail<Unit>& ActiveTail<Unit>::operator=(const ActiveTail<Unit>& that) {
     //self assignment is safe in this case
@@ -1182,6 +1722,10 @@ namespace polygon_formation {
   inline ActiveTail<Unit>* ActiveTail<Unit>::getOtherActiveTail() const { 
     return otherTailp_; }
 
+  template <typename Unit>
+  inline PolyLineArena<Unit>* ActiveTail<Unit>::getArena() const { 
+    return arena_; }
+
   template <typename Unit>
   inline bool ActiveTail<Unit>::isOtherTail(const ActiveTail<Unit>& b) {
     //       assert( (tailp_ == b.getOtherTail() && getOtherTail() == b.tailp_) ||
@@ -1264,35 +1808,43 @@ namespace polygon_formation {
     p.set(HORIZONTAL, coord);
     p.set(VERTICAL, coord);
     //if we are vertical assign the last coordinate (an X) to p.x, else to p.y
-    p.set(getOrient().get_perpendicular(), getCoordinate());
+    //a tail begun at this x is emptied by pushing it, then only coord is pushed
+    if(tailp_->numSegments())
+      p.set(getOrient().get_perpendicular(), getCoordinate());
     int oldSegments = tailp_->numSegments();
     tailp_->pushPoint(p);
     int delta = tailp_->numSegments() - oldSegments;
     addPolyLineSize(delta);
     otherTailp_->addPolyLineSize(delta);
+    if(arena_)
+      arena_->addVertices(delta);
   }
 
 
   //global utility functions
   template <typename Unit>
-  inline PolyLine<Unit>* createPolyLine(orientation_2d orient, Unit coord, Side side) {
+  inline PolyLine<Unit>* createPolyLine(orientation_2d orient, Unit coord, Side side, PolyLineArena<Unit>* arena) {
+    if(arena) return arena->createPolyLine(orient, coord, side);
     return new PolyLine<Unit>(orient, coord, side);
   }
 
   template <typename Unit>
-  inline void destroyPolyLine(PolyLine<Unit>* pLine) {
-    delete pLine;
+  inline void destroyPolyLine(PolyLine<Unit>* pLine, PolyLineArena<Unit>* arena) {
+    if(arena) arena->destroyPolyLine(pLine);
+    else delete pLine;
   }
 
   template <typename Unit>
-  inline ActiveTail<Unit>* createActiveTail() {
-    //consider replacing system allocator with ActiveTail memory pool
+  inline ActiveTail<Unit>* createActiveTail(PolyLineArena<Unit>* arena) {
+    if(arena) return arena->createActiveTail();
     return new ActiveTail<Unit>();
   }
 
   template <typename Unit>
   inline void destroyActiveTail(ActiveTail<Unit>* aTail) {
-    delete aTail;
+    PolyLineArena<Unit>* arena = aTail->getArena();
+    if(arena) arena->destroyActiveTail(aTail);
+    else delete aTail;
   }
 
 
@@ -1302,11 +1854,11 @@ namespace polygon_formation {
     tailp_->disconnectTails();
     PolyLine<Unit>* nextPolyLinep = tailp_->next(HEAD);
     End end = tailp_->endConnectivity(HEAD);
-    destroyPolyLine(tailp_);
+    destroyPolyLine(tailp_, arena_);
     while(nextPolyLinep) {
       End nextEnd = nextPolyLinep->endConnectivity(!end); //get the direction of next polyLine
       PolyLine<Unit>* nextNextPolyLinep = nextPolyLinep->next(!end); //get the next polyline
-      destroyPolyLine(nextPolyLinep); //destroy the current polyline
+      destroyPolyLine(nextPolyLinep, arena_); //destroy the current polyline
       end = nextEnd;
       nextPolyLinep = nextNextPolyLinep;
     }
@@ -1381,6 +1933,86 @@ namespace polygon_formation {
     outVec[size] *= (isHole ? -1 : 1);
   }
 
+  template <typename Unit>
+  inline void ActiveTail<Unit>::writeOutFigure(polygon_buffer<Unit>& buffer, bool isHole, orientation_2d orient) const {
+    std::vector<Unit>& outVec = buffer.coordinates();
+    //countCoordinates counts the holes too, grow geometrically so that exact reserves stay amortized
+    std::size_t required = outVec.size() + countCoordinates();
+    if(outVec.capacity() < required)
+      outVec.reserve((std::max)(required, 2 * outVec.capacity()));
+    writeOutRing(outVec, isHole, orient);
+    buffer.close_ring();
+    if(!isHole) {
+      for(iteratorHoles itr = beginHoles(); itr != endHoles(); ++itr) {
+        (*itr)->writeOutRing(outVec, true, orient);
+        buffer.close_ring();
+      }
+    }
+    buffer.close_polygon();
+  }
+
+  template <typename Unit>
+  inline std::size_t ActiveTail<Unit>::countCoordinates() const {
+    //walk the ring like writeOutRing, the winding direction does not matter for the count
+    std::size_t count = 0;
+    const PolyLine<Unit>* lastPolyLinep = otherTailp_->tailp_;
+    const PolyLine<Unit>* polyLinep = tailp_;
+    End startEnd = TAIL;
+    while(true) {
+      count += polyLinep->numSegments();
+      if(polyLinep == lastPolyLinep)
+        break;
+      End nextStartEnd = polyLinep->endConnectivity(!startEnd);
+      polyLinep = polyLinep->next(!startEnd);
+      startEnd = nextStartEnd;
+    }
+    for(iteratorHoles itr = beginHoles(); itr != endHoles(); ++itr)
+      count += (*itr)->countCoordinates();
+    return count;
+  }
+
+  template <typename Unit>
+  inline void ActiveTail<Unit>::writeOutRing(std::vector<Unit>& outVec, bool isHole, orientation_2d orient) const {
+    //start from the same active tail as the iterator, which picks the winding direction
+    const ActiveTail<Unit>* at = this;
+    if(!isHole ^ (orient == HORIZONTAL))
+      at = otherTailp_;
+    //close the ring like the iterator does, destroyContents expects it
+    at->tailp_->joinTailToTail(*(at->otherTailp_->tailp_));
+    //when the first coordinate is not an x in the frame of orient it goes last instead, the first
+    //polyline is written without it so that the ring is only ever appended to
+    bool rotate = (at->getOrient() == HORIZONTAL) ^ (orient == HORIZONTAL);
+    Unit first = Unit();
+    const PolyLine<Unit>* lastPolyLinep = at->otherTailp_->tailp_;
+    const PolyLine<Unit>* polyLinep = at->tailp_;
+    End startEnd = TAIL;
+    while(true) {
+      End nextStartEnd = polyLinep->endConnectivity(!startEnd);
+      const PolyLine<Unit>* nextPolyLinep = polyLinep->next(!startEnd);
+      if(polyLinep == at->tailp_ && rotate) {
+        //the order of writeOut less its first coordinate
+        unsigned int size = polyLinep->numSegments();
+        if(startEnd == HEAD) {
+          first = (*polyLinep)[0];
+          for(unsigned int i = 1; i < size; ++i)
+            outVec.push_back((*polyLinep)[i]);
+        } else {
+          first = (*polyLinep)[size - 1];
+          for(unsigned int i = size - 1; i > 0; --i)
+            outVec.push_back((*polyLinep)[i - 1]);
+        }
+      } else {
+        polyLinep->writeOut(outVec, startEnd);
+      }
+      if(polyLinep == lastPolyLinep)
+        break;
+      polyLinep = nextPolyLinep;
+      startEnd = nextStartEnd;
+    }
+    if(rotate)
+      outVec.push_back(first);
+  }
+
   //no recursion to prevent max recursion depth errors
   template <typename Unit>
   inline PolyLine<Unit>* PolyLine<Unit>::writeOut(std::vector<Unit>& outVec, End startEnd) const {
@@ -1495,8 +2127,9 @@ namespace polygon_formation {
     return 0;
   }
 
-  template <class TKey, class T> inline typename std::map<TKey, T>::iterator findAtNext(std::map<TKey, T>& theMap, 
-                                                                                        typename std::map<TKey, T>::iterator pos, const TKey& key) 
+  template <class map_type> inline typename map_type::iterator findAtNext(map_type& theMap, 
+                                                                         typename map_type::iterator pos,
+                                                                         const typename map_type::key_type& key) 
   {
     if(pos == theMap.end()) return theMap.find(key);
     //if they match the mapItr is pointing to the correct position
@@ -1525,15 +2158,17 @@ namespace polygon_formation {
   // the two active tails that form the filament fracture line edges can become the new active tail pair
   // by pushing x and y onto them.  Otherwise the hole simply needs to be associated to one of the new active tails
   // with add hole
+  // New tails and their polylines are taken from arena when one is given, otherwise from the heap.
   template <typename Unit>
-  inline std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> createActiveTailsAsPair(Unit x, Unit y, bool solid, ActiveTail<Unit>* phole, bool fractureHoles) {
+  inline std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> createActiveTailsAsPair(Unit x, Unit y, bool solid, ActiveTail<Unit>* phole, bool fractureHoles,
+                                                                                 PolyLineArena<Unit>* arena = 0) {
     ActiveTail<Unit>* at1 = 0;
     ActiveTail<Unit>* at2 = 0;
     if(!phole || !fractureHoles){
-      at1 = createActiveTail<Unit>();
-      at2 = createActiveTail<Unit>();
-      (*at1) = ActiveTail<Unit>(VERTICAL, x, solid, at2);
-      (*at2) = ActiveTail<Unit>(HORIZONTAL, y, !solid, at1);
+      at1 = createActiveTail<Unit>(arena);
+      at2 = createActiveTail<Unit>(arena);
+      (*at1) = ActiveTail<Unit>(VERTICAL, x, solid, at2, arena);
+      (*at2) = ActiveTail<Unit>(HORIZONTAL, y, !solid, at1, arena);
       //provide a function through activeTail class to provide this
       at1->getTail()->joinHeadToHead(*(at2->getTail()));
 
@@ -1576,14 +2211,14 @@ namespace polygon_formation {
    *
    * NOTE: Call this only if you are sure that the $ledege$ is not in the tailMap_
    */
-  template<bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
   insertNewLeftEdgeIntoTailMap(Unit currentX, Unit yBegin, Unit yEnd,
-   typename std::map<Unit, ActiveTail<Unit> *>::iterator &hint){
+   typename tail_map_type::iterator &hint){
      ActiveTail<Unit> *currentTail = NULL;
      std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair = 
       createActiveTailsAsPair(currentX, yBegin, true, currentTail, 
-         fractureHoles_);
+         fractureHoles_, arenap_);
      currentTail = tailPair.first; 
      if(!tailMap_.empty()){
         ++hint;
@@ -1593,13 +2228,71 @@ namespace polygon_formation {
      hint = tailMap_.insert(hint, std::make_pair(yEnd, currentTail));
   }
 
-  template<bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
   closePartialSimplePolygon(Unit currentX, ActiveTail<Unit>*pfig,
       ActiveTail<Unit>*ppfig){
-     pfig->pushCoordinate(currentX);
+     if(stats_)
+       ++stats_->thresholdCuts;
+     closeFigure_(currentX, pfig, ppfig);
+  }
+
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
+  closeFigure_(Unit currentX, ActiveTail<Unit>*pfig, ActiveTail<Unit>*ppfig){
+     //pfig is the lower tail, ppfig the upper one
+     PolyLine<Unit>* lower = pfig->getTail();
+     PolyLine<Unit>* upper = ppfig->getTail();
+     //a tail that was moved along currentX at this stop is colinear with the
+     //closing edge, pushing currentX on it takes the move back instead of
+     //running the closing edge over it
+     bool lowerBack = movedAt_(lower, currentX);
+     bool upperBack = movedAt_(upper, currentX);
+     if(lowerBack || !upperBack)
+        pfig->pushCoordinate(currentX);
+     if(upperBack)
+        ppfig->pushCoordinate(currentX);
+     if(pfig->getPolyLineSize() < 4){
+        //the figure was begun at currentX, it has no area
+        lower->joinTailToTail(*upper);
+        pfig->destroyContents();
+        destroyActiveTail(ppfig);
+        destroyActiveTail(pfig);
+        return;
+     }
+     if(lowerBack && upperBack){
+        //both tails now end on currentX, they meet without another coordinate
+        if(upper->numSegments())
+           upper->popCoordinate();
+        else
+           lower->popCoordinate();
+        pfig->addPolyLineSize(-1);
+        ppfig->addPolyLineSize(-1);
+        arenap_->addVertices(-1);
+     }
+     //a tail begun at currentX can be taken back to nothing, keep it from
+     //being empty by moving the last coordinate of the other tail over, the
+     //ring is the same
+     if(!lower->numSegments()){
+        lower->pushCoordinate((*upper)[upper->numSegments() - 1]);
+        upper->popCoordinate();
+     }else if(!upper->numSegments()){
+        upper->pushCoordinate((*lower)[lower->numSegments() - 1]);
+        lower->popCoordinate();
+     }
      ActiveTail<Unit>::joinChains(pfig, ppfig, false, outputPolygons_);
   }
+
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline bool ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
+  movedAt_(const PolyLine<Unit>* tail, Unit currentX){
+     //the coordinate before the last one is the x the tail last turned at, a
+     //tail of a single coordinate turned where its head is joined
+     if(tail->numSegments() > 1)
+        return (*tail)[tail->numSegments() - 2] == currentX;
+     const PolyLine<Unit>* head = tail->next(HEAD);
+     return head && head->getEndCoord(tail->endConnectivity(HEAD)) == currentX;
+  }
   /*
    * If the invariant is maintained correctly then left edges can do the
    * following.
@@ -1617,12 +2310,12 @@ namespace polygon_formation {
    *            #######
    *               =###
    */
-  template<bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
   updatePartialSimplePolygonsWithLeftEdges(Unit currentX,
    const std::vector<interval_data<Unit> > &leftEdges, size_t vertexThreshold){
-     typename std::map<Unit, ActiveTail<Unit>* >::iterator succ, succ1;
-     typename std::map<Unit, ActiveTail<Unit>* >::iterator pred, pred1, hint;
+     typename tail_map_type::iterator succ, succ1;
+     typename tail_map_type::iterator pred, pred1, hint;
      Unit begin, end;
      ActiveTail<Unit> *pfig, *ppfig;
      std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair;
@@ -1649,13 +2342,11 @@ namespace polygon_formation {
                  assert((succ1 != tailMap_.end()) && 
                   ((succ->second)->getOtherActiveTail() == succ1->second));
                  closePartialSimplePolygon(currentX, succ1->second, succ->second);
-                 tailPair = createActiveTailsAsPair<Unit>(currentX, succ1->first,
-                     true, NULL, fractureHoles_);
 
-                 //just update the succ1 with new ActiveTail<Unit>*//
-                 succ1->second = tailPair.second;
-                 ActiveTail<Unit>::joinChains(tailPair.first, pred->second, true,
-                     outputPolygons_);
+                 //just update the succ1 with ActiveTail<Unit>* = ppfig//
+                 succ1->second = ppfig;
+                 ppfig->pushCoordinate(currentX);
+                 ppfig->pushCoordinate(succ1->first);
               }else if(bsize+2 < vertexThreshold){
                  //cut-off the upper piece () join ()//
                  pred1 = pred; ++pred1;
@@ -1679,7 +2370,7 @@ namespace polygon_formation {
                  closePartialSimplePolygon(currentX, pred->second, pred1->second);
 
                  tailPair = createActiveTailsAsPair<Unit>(currentX, succ1->first,
-                     true, NULL, fractureHoles_);
+                     true, NULL, fractureHoles_, arenap_);
                  succ1->second = tailPair.second;
                  pred1->second = tailPair.first;
                  (tailPair.first)->pushCoordinate(pred1->first);
@@ -1693,14 +2384,16 @@ namespace polygon_formation {
            tailMap_.erase(succ); tailMap_.erase(pred);
         }else if(succ == tailMap_.end() && pred != tailMap_.end()){ //CASE-2//
            //succ is missing in the map, first insert it into the map//
-           tailPair = createActiveTailsAsPair<Unit>(currentX, begin, true, NULL, 
-               fractureHoles_);
            hint = pred; ++hint;
-           hint = tailMap_.insert(hint, std::make_pair(begin, tailPair.second));
+           hint = tailMap_.insert(hint, std::make_pair(begin, (ActiveTail<Unit> *) NULL));
 
            pfig = pred->second;
            pfig_size = pfig->getPolyLineSize() + 2;
            if(pfig_size >= vertexThreshold){
+              tailPair = createActiveTailsAsPair<Unit>(currentX, begin, true, NULL,
+                  fractureHoles_, arenap_);
+              hint->second = tailPair.second;
+
               //cut-off piece from [pred, pred1] , add [begin, pred1]//
               pred1 = pred; ++pred1;
               assert((pred1 != tailMap_.end()) && 
@@ -1711,9 +2404,10 @@ namespace polygon_formation {
               pred1->second = tailPair.first;
               (tailPair.first)->pushCoordinate(pred1->first);
            }else{
-              //just join//
-              ActiveTail<Unit>::joinChains(tailPair.first, pfig, 
-                  true, outputPolygons_);
+              //just extend//
+              hint->second = pfig;
+              pfig->pushCoordinate(currentX);
+              pfig->pushCoordinate(begin);
            }
            tailMap_.erase(pred);
         }else if(succ != tailMap_.end() && pred == tailMap_.end()){ //CASE-3//
@@ -1732,7 +2426,7 @@ namespace polygon_formation {
 
                //update: we need a left edge between (succ1->first, end)//
                tailPair = createActiveTailsAsPair<Unit>(currentX, succ1->first,
-                  true, NULL, fractureHoles_);
+                  true, NULL, fractureHoles_, arenap_);
                succ1->second = tailPair.second;
                hint->second = tailPair.first;
                (tailPair.first)->pushCoordinate(end);
@@ -1750,13 +2444,13 @@ namespace polygon_formation {
      }
   }
 
-  template<bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
   updatePartialSimplePolygonsWithRightEdges(Unit currentX,
    const std::vector<interval_data<Unit> > &rightEdges, size_t vertexThreshold) 
    {
     
-     typename std::map<Unit, ActiveTail<Unit>* >::iterator succ, pred, hint;
+     typename tail_map_type::iterator succ, pred, hint;
      std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair; 
      Unit begin, end;
      size_t i = 0;
@@ -1815,7 +2509,7 @@ namespace polygon_formation {
               // between [rightEdges[j-1].get(HIGH), end]  
               Unit lbegin = rightEdges[j-1].get(HIGH);
               tailPair = createActiveTailsAsPair<Unit>(currentX, lbegin, true, NULL,
-                  fractureHoles_);
+                  fractureHoles_, arenap_);
               hint = tailMap_.insert(pred, std::make_pair(lbegin, tailPair.second));
               pred->second = tailPair.first;
               (tailPair.first)->pushCoordinate(end);
@@ -1827,9 +2521,8 @@ namespace polygon_formation {
                (end != solid_opening_end)) ? 4 : 2;
 
         if(!found_solid_opening){
-           //just close the figure, TODO: call closePartialPolygon//
-           pfig->pushCoordinate(currentX);
-           ActiveTail<Unit>::joinChains(pfig, ppfig, false, outputPolygons_);
+           //just close the figure//
+           closeFigure_(currentX, pfig, ppfig);
            hint = pred; ++hint;
         }else if(partial_fig_size+vertex_delta >= vertexThreshold){
            //close the figure and add a pseudo left-edge//
@@ -1842,7 +2535,7 @@ namespace polygon_formation {
            }else if(begin == solid_opening_begin){
               //we just need to update the succ in the tailMap_//
               tailPair = createActiveTailsAsPair<Unit>(currentX, solid_opening_begin,
-                  true, NULL, fractureHoles_);
+                  true, NULL, fractureHoles_, arenap_);
               succ->second = tailPair.second;
               hint = succ; ++hint;
               hint = tailMap_.insert(pred, std::make_pair(solid_opening_end, 
@@ -1852,7 +2545,7 @@ namespace polygon_formation {
            }else{
               //we just need to update the pred in the tailMap_//
               tailPair = createActiveTailsAsPair<Unit>(currentX, solid_opening_begin,
-                  true, NULL, fractureHoles_);
+                  true, NULL, fractureHoles_, arenap_);
               hint = tailMap_.insert(pred, std::make_pair(solid_opening_begin,
                   tailPair.second));
               pred->second = tailPair.first;
@@ -1872,14 +2565,11 @@ namespace polygon_formation {
            }
 
            if(end != solid_opening_end){
-              std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair = 
-               createActiveTailsAsPair<Unit>(currentX, solid_opening_end, false, 
-                     NULL, fractureHoles_);
+              ppfig->pushCoordinate(currentX);
+              ppfig->pushCoordinate(solid_opening_end);
+              //insert solid_opening_end//
               hint = pred; ++hint;
-              hint = tailMap_.insert(hint, std::make_pair(solid_opening_end, 
-                  tailPair.second));
-              ActiveTail<Unit>::joinChains(tailPair.first, ppfig, false, 
-                  outputPolygons_);
+              hint = tailMap_.insert(hint, std::make_pair(solid_opening_end, ppfig));
            }else{
               erase_pred = false;
            }
@@ -1899,8 +2589,8 @@ namespace polygon_formation {
  // Maintains the following invariant:
  // a. All the partial polygons formed at any state can be closed 
  //    by a single edge.
- template<bool orientT, typename Unit, typename polygon_concept_type>
- inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+ template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+ inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
  maintainPartialSimplePolygonInvariant(iterator& beginOutput, 
    iterator& endOutput, Unit currentX, const std::vector<interval_data<Unit> >& l, 
       const std::vector<interval_data<Unit> >& r, size_t vertexThreshold) {
@@ -2012,14 +2702,14 @@ namespace polygon_formation {
   //    The currentTail vertical edge turns right and is added to the horizontal edges data.
   //    The horizontal edge from the left turns upward and becomes the currentTail vertical edge
   //
-  template <bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::
+  template <bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::
   processEdges(iterator& beginOutput, iterator& endOutput, 
                Unit currentX, std::vector<interval_data<Unit> >& leftEdges, 
                std::vector<interval_data<Unit> >& rightEdges,
                size_t vertexThreshold) {
     clearOutput_();
-    typename std::map<Unit, ActiveTail<Unit>*>::iterator nextMapItr; 
+    typename tail_map_type::iterator nextMapItr; 
     //foreach edge
     unsigned int leftIndex = 0;
     unsigned int rightIndex = 0;
@@ -2030,6 +2720,8 @@ namespace polygon_formation {
     if(vertexThreshold < (std::numeric_limits<size_t>::max)()){
       maintainPartialSimplePolygonInvariant(beginOutput, endOutput, currentX,
          leftEdges, rightEdges, vertexThreshold);
+      if(stats_)
+        recordStats_(!leftEdges.empty() || !rightEdges.empty());
       return;
     }
 
@@ -2054,7 +2746,7 @@ namespace polygon_formation {
         //assert currentTail = 0 
 
         //process the bottom end of this edge
-        typename std::map<Unit, ActiveTail<Unit>*>::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(LOW));
+        typename tail_map_type::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(LOW));
         if(thisMapItr != tailMap_.end()) {
           //there is an edge in the map at the low end of this edge
           //it needs to turn upward and become the current tail
@@ -2079,7 +2771,7 @@ namespace polygon_formation {
           //if this is a trailing edge then there is space to the right of the vertical edge
           //so pass the inverse of trailingEdge to indicate solid to the right
           std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair = 
-            createActiveTailsAsPair(currentX, edge.get(LOW), !trailingEdge, currentTail, fractureHoles_);
+            createActiveTailsAsPair(currentX, edge.get(LOW), !trailingEdge, currentTail, fractureHoles_, arenap_);
           currentTail = tailPair.first;
           tailMap_.insert(nextMapItr, std::pair<Unit, ActiveTail<Unit>*>(edge.get(LOW), tailPair.second));
           // leave nextMapItr unchanged
@@ -2089,7 +2781,7 @@ namespace polygon_formation {
       if(haveNextEdge && edge.get(HIGH) == nextEdge.get(LOW)) {
         //the top of this edge is equal to the bottom of the next edge, process them both
         bottomAlreadyProcessed = true;
-        typename std::map<Unit, ActiveTail<Unit>*>::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(HIGH));
+        typename tail_map_type::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(HIGH));
         if(thisMapItr == tailMap_.end()) //assert this should never happen
           return;
         if(trailingEdge) {
@@ -2107,7 +2799,7 @@ namespace polygon_formation {
           //pass true becuase they are created at the lower left corner of some solid
           //pass null because there is no hole pointer possible
           std::pair<ActiveTail<Unit>*, ActiveTail<Unit>*> tailPair = 
-            createActiveTailsAsPair<Unit>(currentX, edge.get(HIGH), true, 0, fractureHoles_);
+            createActiveTailsAsPair<Unit>(currentX, edge.get(HIGH), true, 0, fractureHoles_, arenap_);
           currentTail = tailPair.first;
           thisMapItr->second = tailPair.second;
         } else {
@@ -2130,7 +2822,7 @@ namespace polygon_formation {
         //there is a gap between the top of this edge and the bottom of the next, process the top of this edge
         bottomAlreadyProcessed = false;
         //process the top of this edge
-        typename std::map<Unit, ActiveTail<Unit>*>::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(HIGH));
+        typename tail_map_type::iterator thisMapItr = findAtNext(tailMap_, nextMapItr, edge.get(HIGH));
         if(thisMapItr != tailMap_.end()) {
           //thisMapItr is pointing to a horizontal edge in the map at the top of this vertical edge
           //we need to join them and potentially close a figure
@@ -2182,10 +2874,23 @@ namespace polygon_formation {
     } //end while
     beginOutput = outputPolygons_.begin();
     endOutput = outputPolygons_.end();
+    if(stats_)
+      recordStats_(!leftEdges.empty() || !rightEdges.empty());
   } //end function
 
-  template<bool orientT, typename Unit, typename polygon_concept_type>
-  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type>::clearOutput_() {
+  template <bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::recordStats_(bool edges) {
+    if(edges)
+      ++stats_->scanStops;
+    stats_->peakTailMapSize = (std::max)(stats_->peakTailMapSize, (std::size_t)tailMap_.size());
+    stats_->peakLiveVertices = (std::max)(stats_->peakLiveVertices, arenap_->liveVertices());
+    stats_->polygonsEmitted += outputPolygons_.size();
+    for(std::size_t i = 0; i < outputPolygons_.size(); ++i)
+      stats_->coordinatesWritten += outputPolygons_[i].yield()->countCoordinates();
+  }
+
+  template<bool orientT, typename Unit, typename polygon_concept_type, typename tail_map_type>
+  inline void ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type, tail_map_type>::clearOutput_() {
     for(std::size_t i = 0; i < outputPolygons_.size(); ++i) {
       ActiveTail<Unit>* at1 = outputPolygons_[i].yield();
       const std::list<ActiveTail<Unit>*>& holes = at1->getHoles();
@@ -2202,6 +2907,10 @@ namespace polygon_formation {
       destroyActiveTail(at1);
     }
     outputPolygons_.clear();
+    //with no partial figure left on the scanline the whole arena can be rewound at once, so the
+    //next figures are carved contiguously from the first slab instead of from a scattered free list
+    if(arenap_->empty())
+      arenap_->reset();
   }
 
 } //polygon_formation namespace
@@ -2216,46 +2925,148 @@ namespace polygon_formation {
     typedef polygon_90_concept type;
   };
 
-  //public API to access polygon formation algorithm
-  template <typename output_container, typename iterator_type, typename concept_type>
-  unsigned int get_polygons(output_container& container, 
-      iterator_type begin, iterator_type end, orientation_2d orient, 
-      bool fracture_holes, concept_type, 
-      size_t sliceThreshold = (std::numeric_limits<size_t>::max)() ) {
-    typedef typename output_container::value_type polygon_type;
+namespace polygon_formation {
+
+  /*
+   * ContainerOutput converts each closed figure to the value type of an output container and
+   * appends it.
+   */
+  template <typename output_container>
+  class ContainerOutput {
+  private:
+    output_container& container_;
+    typename output_container::value_type poly_;
+  public:
+    inline ContainerOutput(output_container& container) : container_(container), poly_() {}
+    template <typename figure_type>
+    inline void operator()(const figure_type& figure) {
+      assign(poly_, figure);
+      container_.insert(container_.end(), poly_);
+    }
+  };
+
+  /*
+   * PolygonBufferOutput writes each closed figure straight into a polygon_buffer.
+   */
+  template <typename Unit>
+  class PolygonBufferOutput {
+  private:
+    polygon_buffer<Unit>& buffer_;
+  public:
+    inline PolygonBufferOutput(polygon_buffer<Unit>& buffer) : buffer_(buffer) {}
+    template <bool orientT>
+    inline void operator()(const PolyLineHoleData<orientT, Unit>& figure) {
+      PolyLineHoleData<orientT, Unit> view(figure);
+      view.yield()->writeOutFigure(buffer_, true, orientT ? VERTICAL : HORIZONTAL);
+    }
+    template <bool orientT>
+    inline void operator()(const PolyLinePolygonWithHolesData<orientT, Unit>& figure) {
+      PolyLinePolygonWithHolesData<orientT, Unit> view(figure);
+      view.yield()->writeOutFigure(buffer_, false, orientT ? VERTICAL : HORIZONTAL);
+    }
+    //a figure formed again by KeyholeOutput
+    inline void operator()(const polygon_90_with_holes_data<Unit>& polygon) {
+      buffer_.push_ring(polygon.begin_compact(), polygon.end_compact());
+      for(typename polygon_90_with_holes_data<Unit>::iterator_holes_type itr = polygon.begin_holes();
+          itr != polygon.end_holes(); ++itr)
+        buffer_.push_ring((*itr).begin_compact(), (*itr).end_compact());
+      buffer_.close_polygon();
+    }
+  };
+
+  /*
+   * KeyholeOutput forwards the figures of a formation with a vertex threshold to output.  That
+   * formation keeps every partial figure closable by a single edge, so the holes of a polygon
+   * with holes come out joined to its shell by slits along the scan direction.  A figure whose
+   * boundary touches itself is formed again on its own, which turns the slits back into holes;
+   * each polygon it gives has no more vertices, holes included, than the figure had.  count()
+   * is the number of polygons forwarded, which may be more than the number of figures.
+   */
+  template <typename output_functor, typename Unit>
+  class KeyholeOutput {
+  private:
+    output_functor& output_;
+    orientation_2d orient_;
+    std::vector<point_data<Unit> > points_;
+    polygon_90_data<Unit> ring_;
+    std::vector<polygon_90_with_holes_data<Unit> > polygons_;
+    unsigned int count_;
+  public:
+    inline KeyholeOutput(output_functor& output, orientation_2d orient) :
+      output_(output), orient_(orient), points_(), ring_(), polygons_(), count_(0) {}
+    inline unsigned int count() const { return count_; }
+    template <bool orientT>
+    inline void operator()(const PolyLineHoleData<orientT, Unit>& figure) {
+      ++count_;
+      output_(figure);
+    }
+    template <bool orientT>
+    inline void operator()(const PolyLinePolygonWithHolesData<orientT, Unit>& figure) {
+      points_.assign(figure.begin(), figure.end());
+      std::sort(points_.begin(), points_.end());
+      if(std::adjacent_find(points_.begin(), points_.end()) == points_.end()) {
+        ++count_;
+        output_(figure);
+        return;
+      }
+      ring_.set_compact(figure.begin_compact(), figure.end_compact());
+      polygon_90_set_data<Unit> piece(orient_);
+      piece.insert(ring_);
+      piece.clean();
+      polygons_.clear();
+      piece.get(polygons_);
+      count_ += (unsigned int)polygons_.size();
+      for(std::size_t i = 0; i < polygons_.size(); ++i)
+        output_(polygons_[i]);
+    }
+  };
+
+  template <typename scanline_type, typename iterator_type, typename output_functor>
+  inline unsigned int formPolygons(scanline_type& scanline, iterator_type begin, iterator_type end,
+                                   size_t sliceThreshold, output_functor& output);
+
+  /*
+   * formPolygonsKeepingHoles is formPolygons for an output that keeps the holes of its polygons,
+   * with a vertex threshold the figures go through KeyholeOutput to get their holes back.  Returns
+   * the number of polygons output.
+   */
+  template <typename scanline_type, typename iterator_type, typename output_functor>
+  inline unsigned int formPolygonsKeepingHoles(scanline_type& scanline, iterator_type begin, iterator_type end,
+                                               size_t sliceThreshold, output_functor& output,
+                                               orientation_2d orient) {
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type Unit;
+    if(sliceThreshold == (std::numeric_limits<size_t>::max)())
+      return formPolygons(scanline, begin, end, sliceThreshold, output);
+    KeyholeOutput<output_functor, Unit> keyholeOutput(output, orient);
+    formPolygons(scanline, begin, end, sliceThreshold, keyholeOutput);
+    return keyholeOutput.count();
+  }
+
+  /*
+   * formPolygons drives a scanline over sorted polygon_90_set_data vertices in [begin, end),
+   * collecting the vertical edges of every scan stop and handing each figure the scanline
+   * closes to output.  Returns the number of figures output.
+   */
+  template <typename scanline_type, typename iterator_type, typename output_functor>
+  inline unsigned int formPolygons(scanline_type& scanline, iterator_type begin, iterator_type end,
+                                   size_t sliceThreshold, output_functor& output) {
     typedef typename std::iterator_traits<iterator_type>::value_type::first_type coordinate_type;
-    polygon_type poly;
     unsigned int countPolygons = 0;
-    typedef typename geometry_concept<polygon_type>::type polygon_concept_type;
-    polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_concept_type> scanlineToPolygonItrsV(fracture_holes);
-    polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_concept_type> scanlineToPolygonItrsH(fracture_holes);
     std::vector<interval_data<coordinate_type> > leftEdges;
     std::vector<interval_data<coordinate_type> > rightEdges;
     coordinate_type prevPos = (std::numeric_limits<coordinate_type>::max)();
     coordinate_type prevY = (std::numeric_limits<coordinate_type>::max)();
     int count = 0;
+    typename scanline_type::iterator itrPoly, itrPolyEnd;
     for(iterator_type itr = begin;
         itr != end; ++ itr) {
       coordinate_type pos = (*itr).first;
       if(pos != prevPos) {
-        if(orient == VERTICAL) {
-          typename polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_concept_type>::iterator itrPoly, itrPolyEnd;
-           scanlineToPolygonItrsV.processEdges(itrPoly, itrPolyEnd, prevPos, 
-               leftEdges, rightEdges, sliceThreshold);
-          for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
-            ++countPolygons;
-            assign(poly, *itrPoly);
-            container.insert(container.end(), poly);
-          }
-        } else {
-          typename polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_concept_type>::iterator itrPoly, itrPolyEnd;
-          scanlineToPolygonItrsH.processEdges(itrPoly, itrPolyEnd, prevPos, 
-               leftEdges, rightEdges, sliceThreshold);
-          for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
-            ++countPolygons;
-            assign(poly, *itrPoly);
-            container.insert(container.end(), poly);
-          }
+        scanline.processEdges(itrPoly, itrPolyEnd, prevPos, 
+            leftEdges, rightEdges, sliceThreshold);
+        for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
+          ++countPolygons;
+          output(*itrPoly);
         }
         leftEdges.clear();
         rightEdges.clear();
@@ -2285,27 +3096,404 @@ namespace polygon_formation {
       prevY = y;
       count += (*itr).second.second;
     }
-    if(orient == VERTICAL) {
-      typename polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_concept_type>::iterator itrPoly, itrPolyEnd;
-      scanlineToPolygonItrsV.processEdges(itrPoly, itrPolyEnd, prevPos, leftEdges, rightEdges, sliceThreshold);
-      for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
-        ++countPolygons;
-        assign(poly, *itrPoly);
-        container.insert(container.end(), poly);
+    scanline.processEdges(itrPoly, itrPolyEnd, prevPos, leftEdges, rightEdges, sliceThreshold);
+    for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
+      ++countPolygons;
+      output(*itrPoly);
+    }
+    return countPolygons;
+  }
+
+  /*
+   * Slab partitioned formation.  The sorted vertices are split at scan stops into slabs that are
+   * formed independently: a slab opens with the coverage profile left by all the slabs before it,
+   * given as vertices at its first scan stop, and is closed by the negated profile at the first
+   * scan stop of the next slab.  Each slab is then a self contained vertex sequence whose figures
+   * are the input cut at the slab boundaries.
+   *
+   * A profile is a list of (y, count) sorted by y with no zero counts, the coverage at y is the sum
+   * of the counts at or below y.
+   */
+
+  //result = a + b, for profiles a and b
+  template <typename Unit>
+  inline void addProfiles(std::vector<std::pair<Unit, int> >& result,
+                          const std::vector<std::pair<Unit, int> >& a,
+                          const std::vector<std::pair<Unit, int> >& b) {
+    result.clear();
+    result.reserve(a.size() + b.size());
+    std::size_t i = 0, j = 0;
+    while(i < a.size() || j < b.size()) {
+      std::pair<Unit, int> element;
+      if(j == b.size() || (i < a.size() && a[i].first < b[j].first)) {
+        element = a[i++];
+      } else if(i == a.size() || b[j].first < a[i].first) {
+        element = b[j++];
+      } else {
+        element = a[i++];
+        element.second += b[j++].second;
       }
-    } else {
-      typename polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_concept_type>::iterator itrPoly, itrPolyEnd;
-      scanlineToPolygonItrsH.processEdges(itrPoly, itrPolyEnd, prevPos, leftEdges, rightEdges,  sliceThreshold);
+      if(element.second != 0)
+        result.push_back(element);
+    }
+  }
 
-      for( ; itrPoly != itrPolyEnd; ++ itrPoly) {
-        ++countPolygons;
-        assign(poly, *itrPoly);
-        container.insert(container.end(), poly);
+  //computes the net profile of the vertices of each slab, slab k is [bounds[k], bounds[k+1])
+  template <typename iterator_type, typename Unit>
+  class SlabProfileTask {
+  private:
+    const std::vector<iterator_type>& bounds_;
+    std::vector<std::vector<std::pair<Unit, int> > >& profiles_;
+  public:
+    inline SlabProfileTask(const std::vector<iterator_type>& bounds,
+                           std::vector<std::vector<std::pair<Unit, int> > >& profiles) :
+      bounds_(bounds), profiles_(profiles) {}
+    inline void operator()(std::size_t k) {
+      std::vector<std::pair<Unit, int> > elements;
+      elements.reserve(bounds_[k + 1] - bounds_[k]);
+      for(iterator_type itr = bounds_[k]; itr != bounds_[k + 1]; ++itr)
+        elements.push_back(std::make_pair((*itr).second.first, (*itr).second.second));
+      polygon_sort(elements.begin(), elements.end());
+      std::vector<std::pair<Unit, int> >& profile = profiles_[k];
+      profile.clear();
+      for(std::size_t i = 0; i < elements.size(); ++i) {
+        if(!profile.empty() && profile.back().first == elements[i].first)
+          profile.back().second += elements[i].second;
+        else
+          profile.push_back(elements[i]);
+        if(profile.back().second == 0)
+          profile.pop_back();
       }
     }
+  };
+
+  /*
+   * SlabOutput keeps the figures of one slab.  When stitching, figures that reach a slab boundary
+   * go to the boundary set instead, to be formed again with their neighbors across the boundary.
+   */
+  template <typename polygon_type, typename Unit>
+  class SlabOutput {
+  private:
+    std::vector<polygon_type>& figures_;
+    polygon_90_set_data<Unit>* boundary_;
+    orientation_2d orient_;
+    Unit low_, high_;
+    bool hasLow_, hasHigh_;
+    polygon_type poly_;
+  public:
+    inline SlabOutput(std::vector<polygon_type>& figures, polygon_90_set_data<Unit>* boundary,
+                      orientation_2d orient, Unit low, Unit high, bool hasLow, bool hasHigh) :
+      figures_(figures), boundary_(boundary), orient_(orient), low_(low), high_(high),
+      hasLow_(hasLow), hasHigh_(hasHigh), poly_() {}
+    template <typename figure_type>
+    inline void operator()(const figure_type& figure) {
+      assign(poly_, figure);
+      if(boundary_) {
+        rectangle_data<Unit> box;
+        extents(box, poly_);
+        interval_data<Unit> span = box.get(orient_.get_perpendicular());
+        if((hasLow_ && span.low() == low_) || (hasHigh_ && span.high() == high_)) {
+          boundary_->insert(poly_);
+          return;
+        }
+      }
+      figures_.push_back(poly_);
+    }
+  };
+
+  //forms slab k from its own vertices between the opening profile k and the closing profile k + 1
+  template <bool orientT, typename iterator_type, typename polygon_type, typename polygon_concept_type>
+  class SlabFormationTask {
+  private:
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type Unit;
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+    const std::vector<iterator_type>& bounds_;
+    const std::vector<std::vector<std::pair<Unit, int> > >& profiles_;
+    std::vector<std::vector<polygon_type> >& figures_;
+    std::vector<polygon_90_set_data<Unit> >* boundaries_;
+    std::vector<unsigned int>& counts_;
+    orientation_2d orient_;
+    bool fractureHoles_;
+    size_t sliceThreshold_;
+  public:
+    inline SlabFormationTask(const std::vector<iterator_type>& bounds,
+                             const std::vector<std::vector<std::pair<Unit, int> > >& profiles,
+                             std::vector<std::vector<polygon_type> >& figures,
+                             std::vector<polygon_90_set_data<Unit> >* boundaries,
+                             std::vector<unsigned int>& counts, orientation_2d orient,
+                             bool fractureHoles, size_t sliceThreshold) :
+      bounds_(bounds), profiles_(profiles), figures_(figures), boundaries_(boundaries),
+      counts_(counts), orient_(orient), fractureHoles_(fractureHoles), sliceThreshold_(sliceThreshold) {}
+    inline void operator()(std::size_t k) {
+      std::size_t numSlabs = bounds_.size() - 1;
+      iterator_type begin = bounds_[k];
+      iterator_type end = bounds_[k + 1];
+      Unit low = (*begin).first;
+      Unit high = k + 1 < numSlabs ? (*end).first : low;
+      std::vector<vertex_type> vertices;
+      const std::vector<std::pair<Unit, int> >& opening = profiles_[k];
+      iterator_type firstStop = begin;
+      while(firstStop != end && (*firstStop).first == low)
+        ++firstStop;
+      vertices.reserve((end - begin) + opening.size() + (k + 1 < numSlabs ? profiles_[k + 1].size() : 0));
+      //the opening profile and the first scan stop of the slab are merged on y
+      iterator_type itr = begin;
+      for(std::size_t i = 0; i < opening.size(); ++i) {
+        for( ; itr != firstStop && (*itr).second.first < opening[i].first; ++itr)
+          vertices.push_back(*itr);
+        vertices.push_back(vertex_type(low, opening[i]));
+      }
+      vertices.insert(vertices.end(), itr, end);
+      if(k + 1 < numSlabs) {
+        const std::vector<std::pair<Unit, int> >& closing = profiles_[k + 1];
+        for(std::size_t i = 0; i < closing.size(); ++i)
+          vertices.push_back(vertex_type(high, std::make_pair(closing[i].first, -closing[i].second)));
+      }
+      polygon_90_set_data<Unit>* boundary = boundaries_ ? &(*boundaries_)[k] : 0;
+      SlabOutput<polygon_type, Unit> output(figures_[k], boundary, orient_, low, high, k > 0, k + 1 < numSlabs);
+      PolyLineArena<Unit> arena;
+      ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type> scanline(fractureHoles_, &arena);
+      if(fractureHoles_)
+        counts_[k] = formPolygons(scanline, vertices.begin(), vertices.end(), sliceThreshold_, output);
+      else
+        counts_[k] = formPolygonsKeepingHoles(scanline, vertices.begin(), vertices.end(), sliceThreshold_,
+                                              output, orient_);
+      //cleaning the boundary set here keeps its sort on the thread of the slab
+      if(boundary)
+        boundary->clean();
+    }
+  };
+
+  //Appends the clean vertices of the boundary sets of the slabs in slab order.  The sets of two
+  //slabs only share the scan stop of the boundary between them, where the figures of both sides
+  //are merged on y and their counts summed, so the result is clean without a boolean pass.
+  template <typename Unit>
+  inline void stitchBoundaries(std::vector<std::pair<Unit, std::pair<Unit, int> > >& stitched,
+                               const std::vector<polygon_90_set_data<Unit> >& boundaries) {
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+    typedef typename polygon_90_set_data<Unit>::iterator_type iterator_type;
+    std::size_t size = 0;
+    for(std::size_t k = 0; k < boundaries.size(); ++k)
+      size += boundaries[k].size();
+    stitched.reserve(size);
+    std::vector<vertex_type> shared;
+    for(std::size_t k = 0; k < boundaries.size(); ++k) {
+      if(boundaries[k].empty())
+        continue;
+      iterator_type itr = boundaries[k].begin();
+      iterator_type end = boundaries[k].end();
+      Unit stop = (*itr).first;
+      std::size_t first = stitched.size();
+      while(first > 0 && stitched[first - 1].first == stop)
+        --first;
+      if(first < stitched.size()) {
+        iterator_type stopEnd = itr;
+        while(stopEnd != end && (*stopEnd).first == stop)
+          ++stopEnd;
+        shared.clear();
+        std::merge(stitched.begin() + first, stitched.end(), itr, stopEnd, std::back_inserter(shared));
+        stitched.resize(first);
+        for(std::size_t i = 0; i < shared.size(); ) {
+          vertex_type vertex(shared[i].first, std::make_pair(shared[i].second.first, 0));
+          for( ; i < shared.size() && shared[i].second.first == vertex.second.first; ++i)
+            vertex.second.second += shared[i].second.second;
+          if(vertex.second.second != 0)
+            stitched.push_back(vertex);
+        }
+        itr = stopEnd;
+      }
+      stitched.insert(stitched.end(), itr, end);
+    }
+  }
+
+  /*
+   * formPolygonsInSlabs splits [begin, end) into up to numSlabs slabs of about the same number of
+   * vertices and forms them in parallel.  Figures reaching a slab boundary are cut there, or when
+   * stitch is set, formed again together in one pass once all slabs are done.  Returns the number
+   * of figures appended to container.
+   *
+   * Stitching costs a serial formation of the figures reaching a boundary on top of the parallel
+   * slab pass; their vertices are sorted in the slabs and put together in linear time.  When one
+   * figure spans the slabs, like a mesh across the die, that is all of the input and stitching is
+   * slower than forming serially, so such input is better formed serially or cut.
+   */
+  template <bool orientT, typename output_container, typename iterator_type, typename polygon_concept_type>
+  inline unsigned int formPolygonsInSlabs(output_container& container, iterator_type begin, iterator_type end,
+                                          orientation_2d orient, bool fractureHoles, polygon_concept_type,
+                                          std::size_t numSlabs, bool stitch, size_t sliceThreshold) {
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type Unit;
+    typedef typename output_container::value_type polygon_type;
+    std::size_t size = end - begin;
+    if(numSlabs == 0) numSlabs = 1;
+    //slabs start at scan stops, so a slab may be bigger than size / numSlabs or be dropped
+    std::vector<iterator_type> bounds(1, begin);
+    for(std::size_t k = 1; k < numSlabs; ++k) {
+      iterator_type itr = begin + (size * k) / numSlabs;
+      if(itr <= bounds.back()) continue;
+      while(itr != end && (*itr).first == (*(itr - 1)).first)
+        ++itr;
+      if(itr != end && bounds.back() < itr)
+        bounds.push_back(itr);
+    }
+    bounds.push_back(end);
+    numSlabs = bounds.size() - 1;
+    if(size == 0) return 0;
+
+    //profiles[k] is the coverage at the start of slab k, the sum of the net profiles of all slabs before it
+    std::vector<std::vector<std::pair<Unit, int> > > netProfiles(numSlabs);
+    SlabProfileTask<iterator_type, Unit> profileTask(bounds, netProfiles);
+    parallel_for(numSlabs - 1, 0, profileTask);
+    std::vector<std::vector<std::pair<Unit, int> > > profiles(numSlabs);
+    for(std::size_t k = 1; k < numSlabs; ++k)
+      addProfiles(profiles[k], profiles[k - 1], netProfiles[k - 1]);
+    netProfiles.clear();
+
+    std::vector<std::vector<polygon_type> > figures(numSlabs);
+    std::vector<polygon_90_set_data<Unit> > boundaries;
+    if(stitch && numSlabs > 1)
+      boundaries.resize(numSlabs, polygon_90_set_data<Unit>(orient));
+    std::vector<unsigned int> counts(numSlabs, 0);
+    SlabFormationTask<orientT, iterator_type, polygon_type, polygon_concept_type>
+      formationTask(bounds, profiles, figures, boundaries.empty() ? 0 : &boundaries, counts,
+                    orient, fractureHoles, sliceThreshold);
+    parallel_for(numSlabs, 0, formationTask);
+
+    unsigned int countPolygons = 0;
+    for(std::size_t k = 0; k < numSlabs; ++k) {
+      container.insert(container.end(), figures[k].begin(), figures[k].end());
+      countPolygons += figures[k].size();
+    }
+    if(!boundaries.empty()) {
+      std::vector<std::pair<Unit, std::pair<Unit, int> > > stitched;
+      stitchBoundaries(stitched, boundaries);
+      boundaries.clear();
+      PolyLineArena<Unit> arena;
+      ScanLineToPolygonItrs<orientT, Unit, polygon_concept_type> scanline(fractureHoles, &arena);
+      ContainerOutput<output_container> output(container);
+      if(fractureHoles)
+        countPolygons += formPolygons(scanline, stitched.begin(), stitched.end(), sliceThreshold, output);
+      else
+        countPolygons += formPolygonsKeepingHoles(scanline, stitched.begin(), stitched.end(), sliceThreshold,
+                                                  output, orient);
+    }
     return countPolygons;
   }
 
+} //polygon_formation namespace
+
+  //public API to access polygon formation algorithm
+  //partial figures are allocated from arena, a polygon_formation::PolyLineArena<coordinate_type>
+  //that the caller owns and may reuse across calls; it must be empty when passed in
+  //stats, when given, is updated at every scan stop, see polygon_formation::FormationStats
+  template <typename output_container, typename iterator_type, typename concept_type>
+  unsigned int get_polygons(output_container& container, 
+      iterator_type begin, iterator_type end, orientation_2d orient, 
+      bool fracture_holes, concept_type, size_t sliceThreshold,
+      polygon_formation::PolyLineArena<typename std::iterator_traits<iterator_type>::value_type::first_type>& arena,
+      polygon_formation::FormationStats* stats = 0) {
+    typedef typename output_container::value_type polygon_type;
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type coordinate_type;
+    typedef typename geometry_concept<polygon_type>::type polygon_concept_type;
+    polygon_formation::ContainerOutput<output_container> output(container);
+    if(orient == VERTICAL) {
+      polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_concept_type> scanlineToPolygonItrsV(fracture_holes, &arena);
+      scanlineToPolygonItrsV.setStats(stats);
+      if(fracture_holes)
+        return polygon_formation::formPolygons(scanlineToPolygonItrsV, begin, end, sliceThreshold, output);
+      return polygon_formation::formPolygonsKeepingHoles(scanlineToPolygonItrsV, begin, end, sliceThreshold, output, orient);
+    }
+    polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_concept_type> scanlineToPolygonItrsH(fracture_holes, &arena);
+    scanlineToPolygonItrsH.setStats(stats);
+    if(fracture_holes)
+      return polygon_formation::formPolygons(scanlineToPolygonItrsH, begin, end, sliceThreshold, output);
+    return polygon_formation::formPolygonsKeepingHoles(scanlineToPolygonItrsH, begin, end, sliceThreshold, output, orient);
+  }
+
+  //public API to access polygon formation algorithm writing into a polygon_buffer, polygons with
+  //holes unless fracture_holes is set
+  template <typename coordinate_type, typename iterator_type, typename concept_type>
+  unsigned int get_polygons(polygon_buffer<coordinate_type>& buffer,
+      iterator_type begin, iterator_type end, orientation_2d orient,
+      bool fracture_holes, concept_type,
+      size_t sliceThreshold = (std::numeric_limits<size_t>::max)(),
+      polygon_formation::FormationStats* stats = 0) {
+    polygon_formation::PolyLineArena<coordinate_type> arena;
+    polygon_formation::PolygonBufferOutput<coordinate_type> output(buffer);
+    if(fracture_holes) {
+      if(orient == VERTICAL) {
+        polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_90_concept> scanlineToPolygonItrsV(true, &arena);
+        scanlineToPolygonItrsV.setStats(stats);
+        return polygon_formation::formPolygons(scanlineToPolygonItrsV, begin, end, sliceThreshold, output);
+      }
+      polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_90_concept> scanlineToPolygonItrsH(true, &arena);
+      scanlineToPolygonItrsH.setStats(stats);
+      return polygon_formation::formPolygons(scanlineToPolygonItrsH, begin, end, sliceThreshold, output);
+    }
+    if(orient == VERTICAL) {
+      polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_90_with_holes_concept> scanlineToPolygonItrsV(false, &arena);
+      scanlineToPolygonItrsV.setStats(stats);
+      return polygon_formation::formPolygonsKeepingHoles(scanlineToPolygonItrsV, begin, end, sliceThreshold, output, orient);
+    }
+    polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_90_with_holes_concept> scanlineToPolygonItrsH(false, &arena);
+    scanlineToPolygonItrsH.setStats(stats);
+    return polygon_formation::formPolygonsKeepingHoles(scanlineToPolygonItrsH, begin, end, sliceThreshold, output, orient);
+  }
+
+  //public API to access polygon formation algorithm
+  template <typename output_container, typename iterator_type, typename concept_type>
+  unsigned int get_polygons(output_container& container, 
+      iterator_type begin, iterator_type end, orientation_2d orient, 
+      bool fracture_holes, concept_type tag, 
+      size_t sliceThreshold = (std::numeric_limits<size_t>::max)(),
+      polygon_formation::FormationStats* stats = 0) {
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type coordinate_type;
+    polygon_formation::PolyLineArena<coordinate_type> arena;
+    return get_polygons(container, begin, end, orient, fracture_holes, tag, sliceThreshold, arena, stats);
+  }
+
+  //public API to run polygon formation in parallel over slabs of the sorted vertices [begin, end),
+  //which must be random access; figures crossing a slab boundary are stitched back together when
+  //stitch is set, otherwise they are cut at the boundary like the figures of a vertex threshold.
+  //The stitched figures are formed again serially, see formPolygonsInSlabs for the cost.
+  //Slabs run on threads only when BOOST_POLYGON_USE_THREADS is defined, see parallel_for
+  template <typename output_container, typename iterator_type, typename concept_type>
+  unsigned int get_polygons_parallel(output_container& container,
+      iterator_type begin, iterator_type end, orientation_2d orient,
+      bool fracture_holes, concept_type, std::size_t num_slabs, bool stitch = true,
+      size_t sliceThreshold = (std::numeric_limits<size_t>::max)() ) {
+    typedef typename output_container::value_type polygon_type;
+    typedef typename geometry_concept<polygon_type>::type polygon_concept_type;
+    if(orient == VERTICAL)
+      return polygon_formation::formPolygonsInSlabs<true>(container, begin, end, orient, fracture_holes,
+          polygon_concept_type(), num_slabs, stitch, sliceThreshold);
+    return polygon_formation::formPolygonsInSlabs<false>(container, begin, end, orient, fracture_holes,
+        polygon_concept_type(), num_slabs, stitch, sliceThreshold);
+  }
+
+  //public API to stream the output of polygon formation instead of collecting it in a container
+  //sink is called with a view of each figure, a polygon_formation::PolyLineHoleData for the
+  //polygon concepts or a PolyLinePolygonWithHolesData for the with holes concepts, as soon as the
+  //scan stop that closes the figure is processed; the view is only valid for the duration of the
+  //call.  Only the figures closed at one scan stop are held, so with a vertex threshold memory is
+  //bounded by the scanline width rather than by the output size; the holes of such figures stay
+  //joined to their shell by slits, see polygon_formation::KeyholeOutput
+  //concept_type is a polygon concept, or a polygon type whose geometry_concept gives it
+  template <typename sink_type, typename iterator_type, typename concept_type>
+  unsigned int get_polygons_to_sink(sink_type& sink,
+      iterator_type begin, iterator_type end, orientation_2d orient,
+      bool fracture_holes, concept_type,
+      size_t sliceThreshold = (std::numeric_limits<size_t>::max)() ) {
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type coordinate_type;
+    typedef typename polygon_formation::SinkConcept<concept_type>::type polygon_concept_type;
+    polygon_formation::PolyLineArena<coordinate_type> arena;
+    if(orient == VERTICAL) {
+      polygon_formation::ScanLineToPolygonItrs<true, coordinate_type, polygon_concept_type> scanlineToPolygonItrsV(fracture_holes, &arena);
+      return polygon_formation::formPolygons(scanlineToPolygonItrsV, begin, end, sliceThreshold, sink);
+    }
+    polygon_formation::ScanLineToPolygonItrs<false, coordinate_type, polygon_concept_type> scanlineToPolygonItrsH(fracture_holes, &arena);
+    return polygon_formation::formPolygons(scanlineToPolygonItrsH, begin, end, sliceThreshold, sink);
+  }
+
 }
 }
 #endif
@@ -0,0 +1,221 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_RADIX_SORT_HPP
+#define BOOST_POLYGON_POLYGON_RADIX_SORT_HPP
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "parallel_for.hpp"
+
+namespace boost { namespace polygon{
+
+  template <typename T>
+  class point_data;
+
+  //number of threads the radix sort of polygon_sort may use, 1 by default and 0 for one per
+  //hardware thread; it only has an effect when BOOST_POLYGON_USE_THREADS is defined
+  inline std::size_t& polygon_sort_threads() {
+    static std::size_t threads = 1;
+    return threads;
+  }
+
+  //Describes value types that polygon_sort can radix sort when no predicate is given: the
+  //integer keys of a value, key(value, 0) being the most significant, must order values as
+  //their operator< does.  Not enabled for anything but the vertex and edge data of the sets.
+  template <typename value_type>
+  struct polygon_radix_sort_traits {
+    static const bool enabled = false;
+    static const int num_keys = 0;
+    static inline polygon_long_long_type key(const value_type&, int) { return 0; }
+  };
+
+  //integral coordinates that fit the keys, which are long long
+  template <typename Unit>
+  struct polygon_radix_sort_unit {
+    static const bool enabled = std::numeric_limits<Unit>::is_integer &&
+      (std::numeric_limits<Unit>::is_signed || sizeof(Unit) < sizeof(polygon_long_long_type));
+  };
+
+  //the (major, (minor, count)) vertices of polygon_90_set_data
+  template <typename Unit>
+  struct polygon_radix_sort_traits<std::pair<Unit, std::pair<Unit, int> > > {
+    static const bool enabled = polygon_radix_sort_unit<Unit>::enabled;
+    static const int num_keys = 3;
+    static inline polygon_long_long_type key(const std::pair<Unit, std::pair<Unit, int> >& value, int i) {
+      if(i == 0) return value.first;
+      if(i == 1) return value.second.first;
+      return value.second.second;
+    }
+  };
+
+  //the (minor, count) pairs the 90 vertices are summed up by
+  template <typename Unit>
+  struct polygon_radix_sort_traits<std::pair<Unit, int> > {
+    static const bool enabled = polygon_radix_sort_unit<Unit>::enabled;
+    static const int num_keys = 2;
+    static inline polygon_long_long_type key(const std::pair<Unit, int>& value, int i) {
+      if(i == 0) return value.first;
+      return value.second;
+    }
+  };
+
+  //the ((begin, end), count) half edges of polygon_set_data
+  template <typename Unit>
+  struct polygon_radix_sort_traits<std::pair<std::pair<point_data<Unit>, point_data<Unit> >, int> > {
+    static const bool enabled = polygon_radix_sort_unit<Unit>::enabled;
+    static const int num_keys = 5;
+    static inline polygon_long_long_type key(const std::pair<std::pair<point_data<Unit>, point_data<Unit> >, int>& value,
+                                             int i) {
+      switch(i) {
+      case 0: return value.first.first.x();
+      case 1: return value.first.first.y();
+      case 2: return value.first.second.x();
+      case 3: return value.first.second.y();
+      default: return value.second;
+      }
+    }
+  };
+
+  //One counting pass of the radix sort over a chunk of the source, on the digit of a key at
+  //shift bits after the minimum of the key is subtracted.  The histogram of every chunk is
+  //taken first, then every chunk is scattered to the offsets computed from all histograms, so
+  //that the chunks can be processed on separate threads and the sort stays stable.
+  template <typename traits_type, typename src_iterator, typename dst_iterator>
+  class RadixSortPass {
+  public:
+    static const std::size_t digit_bits = 11;
+    static const std::size_t num_buckets = 1 << digit_bits;
+  private:
+    src_iterator src_;
+    dst_iterator dst_;
+    std::size_t size_;
+    std::size_t numChunks_;
+    int key_;
+    polygon_ulong_long_type min_;
+    std::size_t shift_;
+    bool scatter_;
+    std::vector<std::size_t>& offsets_; //num_buckets per chunk
+  public:
+    inline RadixSortPass(src_iterator src, dst_iterator dst, std::size_t size, std::size_t numChunks,
+                         int key, polygon_ulong_long_type minKey, std::size_t shift,
+                         std::vector<std::size_t>& offsets) :
+      src_(src), dst_(dst), size_(size), numChunks_(numChunks), key_(key), min_(minKey), shift_(shift),
+      scatter_(false), offsets_(offsets) {}
+
+    inline std::size_t digit(std::size_t index) const {
+      polygon_ulong_long_type key = (polygon_ulong_long_type)traits_type::key(*(src_ + index), key_);
+      return (std::size_t)((key - min_) >> shift_) & (num_buckets - 1);
+    }
+
+    inline void operator()(std::size_t chunk) {
+      std::size_t begin = size_ * chunk / numChunks_;
+      std::size_t end = size_ * (chunk + 1) / numChunks_;
+      std::size_t* offsets = &offsets_[chunk * num_buckets];
+      if(scatter_) {
+        for(std::size_t i = begin; i < end; ++i)
+          *(dst_ + offsets[digit(i)]++) = *(src_ + i);
+      } else {
+        std::fill(offsets, offsets + num_buckets, 0);
+        for(std::size_t i = begin; i < end; ++i)
+          ++offsets[digit(i)];
+      }
+    }
+
+    //counts per chunk to the first destination of every bucket in every chunk
+    inline void run(std::size_t numThreads) {
+      scatter_ = false;
+      parallel_for(numChunks_, numThreads, *this);
+      std::size_t total = 0;
+      for(std::size_t bucket = 0; bucket < num_buckets; ++bucket) {
+        for(std::size_t chunk = 0; chunk < numChunks_; ++chunk) {
+          std::size_t count = offsets_[chunk * num_buckets + bucket];
+          offsets_[chunk * num_buckets + bucket] = total;
+          total += count;
+        }
+      }
+      scatter_ = true;
+      parallel_for(numChunks_, numThreads, *this);
+    }
+  };
+
+  //LSD radix sort of [first, last) by the keys of traits_type, with a buffer of the size of the
+  //range; passes are only made over the digits in which the keys of the range differ
+  template <typename traits_type, typename iterator_type>
+  inline void polygon_radix_sort(iterator_type first, iterator_type last) {
+    typedef typename std::iterator_traits<iterator_type>::value_type value_type;
+    typedef typename std::vector<value_type>::iterator buffer_iterator;
+    typedef RadixSortPass<traits_type, iterator_type, buffer_iterator> to_buffer_pass;
+    typedef RadixSortPass<traits_type, buffer_iterator, iterator_type> from_buffer_pass;
+    std::size_t size = last - first;
+    if(size < 1024) {
+      std::sort(first, last);
+      return;
+    }
+    const int num_keys = traits_type::num_keys;
+    polygon_long_long_type minKeys[num_keys];
+    polygon_long_long_type maxKeys[num_keys];
+    for(int k = 0; k < num_keys; ++k)
+      minKeys[k] = maxKeys[k] = traits_type::key(*first, k);
+    for(iterator_type itr = first; itr != last; ++itr) {
+      for(int k = 0; k < num_keys; ++k) {
+        polygon_long_long_type key = traits_type::key(*itr, k);
+        if(key < minKeys[k]) minKeys[k] = key;
+        if(maxKeys[k] < key) maxKeys[k] = key;
+      }
+    }
+    std::size_t numThreads = polygon_sort_threads();
+    std::size_t numChunks = 1;
+#ifdef BOOST_POLYGON_USE_THREADS
+    if(numThreads == 0)
+      numThreads = std::thread::hardware_concurrency();
+    numChunks = (std::min)(numThreads, size / 32768);
+    if(numChunks == 0)
+      numChunks = 1;
+#endif
+    std::vector<value_type> buffer;
+    std::vector<std::size_t> offsets(numChunks * to_buffer_pass::num_buckets);
+    bool inBuffer = false;
+    for(int k = num_keys - 1; k >= 0; --k) {
+      polygon_ulong_long_type minKey = (polygon_ulong_long_type)minKeys[k];
+      polygon_ulong_long_type range = (polygon_ulong_long_type)maxKeys[k] - minKey;
+      for(std::size_t shift = 0; shift < sizeof(polygon_ulong_long_type) * 8 && (range >> shift) != 0;
+          shift += to_buffer_pass::digit_bits) {
+        if(buffer.empty())
+          buffer.resize(size);
+        if(inBuffer)
+          from_buffer_pass(buffer.begin(), first, size, numChunks, k, minKey, shift, offsets).run(numThreads);
+        else
+          to_buffer_pass(first, buffer.begin(), size, numChunks, k, minKey, shift, offsets).run(numThreads);
+        inBuffer = !inBuffer;
+      }
+    }
+    if(inBuffer)
+      std::copy(buffer.begin(), buffer.end(), first);
+  }
+
+  template <bool enabled>
+  struct polygon_radix_sort_dispatch {
+    template <typename iterator_type>
+    static inline void sort(iterator_type first, iterator_type last) {
+      std::sort(first, last);
+    }
+  };
+
+  template <>
+  struct polygon_radix_sort_dispatch<true> {
+    template <typename iterator_type>
+    static inline void sort(iterator_type first, iterator_type last) {
+      polygon_radix_sort<polygon_radix_sort_traits<typename std::iterator_traits<iterator_type>::value_type> >(first, last);
+    }
+  };
+
+}
+}
+#endif
@@ -13,8 +13,11 @@
 #endif
 
 #include <algorithm>
+#include <iterator>
+#include "polygon_radix_sort.hpp"
 
-//! @brief polygon_sort_adaptor default implementation that calls std::sort
+//! @brief polygon_sort_adaptor default implementation that calls std::sort, or a
+// radix sort for the vertex and edge data of the sets on integer coordinates
 namespace boost {
   namespace polygon {
 
@@ -27,12 +30,19 @@ namespace boost {
     template<typename T>
     struct polygon_sort_adaptor {
       //! @brief wrapper that mimics std::sort() function and takes
-      // the same arguments
+      // the same arguments; ranges of the vertex and edge data of the sets
+      // on integer coordinates are radix sorted, see polygon_radix_sort_traits,
+      // unless BOOST_POLYGON_NO_RADIX_SORT is defined
       template<typename RandomAccessIterator_Type>
       static void sort(RandomAccessIterator_Type _First,
                        RandomAccessIterator_Type _Last)
       {
+#ifdef BOOST_POLYGON_NO_RADIX_SORT
          std::sort(_First, _Last);
+#else
+         typedef typename std::iterator_traits<RandomAccessIterator_Type>::value_type value_type;
+         polygon_radix_sort_dispatch<polygon_radix_sort_traits<value_type>::enabled>::sort(_First, _Last);
+#endif
       }
       //! @brief wrapper that mimics std::sort() function overload and takes
       // the same arguments
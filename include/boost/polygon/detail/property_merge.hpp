@@ -51,13 +51,169 @@ public:
   inline void high(coordinate_type value) { high_ = value; }
 };
 
+//The property counts of merge_scanline on the scanline, which are sorted vectors of property
+//and count and give the property sets of the result keys, std::set or std::vector of property
+template <typename property_type, typename keytype>
+struct property_merge_counts {
+  typedef keytype property_set;
+  typedef std::vector<std::pair<property_type, int> > property_map;
+
+  template <typename T>
+  struct lessPropertyCount {
+    lessPropertyCount() {}
+    bool operator()(const T& a, const T& b) {
+      return a.first < b.first;
+    }
+  };
+
+  static inline void mergeProperty(property_map& lvalue, const std::pair<property_type, int>& rvalue) {
+    typename property_map::iterator itr = std::lower_bound(lvalue.begin(), lvalue.end(), rvalue,
+                                                          lessPropertyCount<std::pair<property_type, int> >());
+    if(itr == lvalue.end() ||
+       (*itr).first != rvalue.first) {
+      lvalue.insert(itr, rvalue);
+    } else {
+      (*itr).second += rvalue.second;
+      if((*itr).second == 0)
+        lvalue.erase(itr);
+    }
+  }
+
+  static inline void mergeCount(property_map& lvalue, const property_map& rvalue, property_map& tmpVector) {
+    typename property_map::iterator litr = lvalue.begin();
+    typename property_map::const_iterator ritr = rvalue.begin();
+    tmpVector.clear();
+    while(litr != lvalue.end() && ritr != rvalue.end()) {
+      if((*litr).first <= (*ritr).first) {
+        if(!tmpVector.empty() &&
+           (*litr).first == tmpVector.back().first) {
+          tmpVector.back().second += (*litr).second;
+        } else {
+          tmpVector.push_back(*litr);
+        }
+        ++litr;
+      } else if((*ritr).first <= (*litr).first) {
+        if(!tmpVector.empty() &&
+           (*ritr).first == tmpVector.back().first) {
+          tmpVector.back().second += (*ritr).second;
+        } else {
+          tmpVector.push_back(*ritr);
+        }
+        ++ritr;
+      }
+    }
+    while(litr != lvalue.end()) {
+      if(!tmpVector.empty() &&
+         (*litr).first == tmpVector.back().first) {
+        tmpVector.back().second += (*litr).second;
+      } else {
+        tmpVector.push_back(*litr);
+      }
+      ++litr;
+    }
+    while(ritr != rvalue.end()) {
+      if(!tmpVector.empty() &&
+         (*ritr).first == tmpVector.back().first) {
+        tmpVector.back().second += (*ritr).second;
+      } else {
+        tmpVector.push_back(*ritr);
+      }
+      ++ritr;
+    }
+    lvalue.clear();
+    for(std::size_t i = 0; i < tmpVector.size(); ++i) {
+      if(tmpVector[i].second != 0) {
+        lvalue.push_back(tmpVector[i]);
+      }
+    }
+  }
+
+  static inline void setProperty(property_set& pset, const property_map& pmap) {
+    for(typename property_map::const_iterator itr = pmap.begin(); itr != pmap.end(); ++itr) {
+      if((*itr).second > 0) {
+        pset.insert(pset.end(), (*itr).first);
+      }
+    }
+  }
+
+  static inline bool empty(const property_set& pset) { return pset.empty(); }
+};
+
+//Counts of the properties 0 to 63 in a fixed array, with a mask of the properties whose count
+//is not zero and a mask of those whose count is positive.  Only the counts of properties in the
+//nonzero mask are ever touched, so a change costs the properties it changes.
+class property_mask_count {
+public:
+  polygon_ulong_long_type nonzero;
+  polygon_ulong_long_type positive;
+  int count[64];
+
+  inline property_mask_count() : nonzero(0), positive(0), count() {}
+  //use builtin assign and copy
+  inline bool empty() const { return nonzero == 0; }
+  inline void clear() {
+    for(int i = 0; nonzero; ++i, nonzero >>= 1)
+      if(nonzero & 1) count[i] = 0;
+    positive = 0;
+  }
+  inline void add(int property, int value) {
+    polygon_ulong_long_type bit = (polygon_ulong_long_type)1 << property;
+    int& c = count[property];
+    c += value;
+    if(c != 0) nonzero |= bit;
+    else nonzero &= ~bit;
+    if(c > 0) positive |= bit;
+    else positive &= ~bit;
+  }
+  inline void add(const property_mask_count& that) {
+    polygon_ulong_long_type bits = that.nonzero;
+    for(int i = 0; bits; ++i, bits >>= 1)
+      if(bits & 1) add(i, that.count[i]);
+  }
+  inline bool operator==(const property_mask_count& that) const {
+    if(nonzero != that.nonzero || positive != that.positive) return false;
+    polygon_ulong_long_type bits = nonzero;
+    for(int i = 0; bits; ++i, bits >>= 1)
+      if((bits & 1) && count[i] != that.count[i]) return false;
+    return true;
+  }
+  inline bool operator!=(const property_mask_count& that) const { return !((*this) == that); }
+};
+
+//The property counts of merge_scanline for results keyed by a mask of properties, where the
+//properties are the integers 0 to 63 and bit i of a key is set if property i is in its set.
+//A property outside 0 to 63 has no bit in a key, its geometry is left out of the result.
+template <typename property_type>
+struct property_merge_counts<property_type, polygon_ulong_long_type> {
+  typedef polygon_ulong_long_type property_set;
+  typedef property_mask_count property_map;
+
+  static inline void mergeProperty(property_map& lvalue, const std::pair<property_type, int>& rvalue) {
+    //negative properties convert to values past 63 as well
+    if((polygon_ulong_long_type)rvalue.first >= 64)
+      return;
+    lvalue.add((int)rvalue.first, rvalue.second);
+  }
+
+  static inline void mergeCount(property_map& lvalue, const property_map& rvalue, property_map&) {
+    lvalue.add(rvalue);
+  }
+
+  static inline void setProperty(property_set& pset, const property_map& pmap) {
+    pset |= pmap.positive;
+  }
+
+  static inline bool empty(const property_set& pset) { return pset == 0; }
+};
+
 template <typename coordinate_type, typename property_type, typename polygon_set_type, typename keytype = std::set<property_type> >
 class merge_scanline {
 public:
   //definitions
 
-  typedef keytype property_set;
-  typedef std::vector<std::pair<property_type, int> > property_map;
+  typedef property_merge_counts<property_type, keytype> counts;
+  typedef typename counts::property_set property_set;
+  typedef typename counts::property_map property_map;
   typedef std::pair<property_merge_point<coordinate_type>, std::pair<property_type, int> > vertex_property;
   typedef std::pair<property_merge_point<coordinate_type>, property_map> vertex_data;
   typedef std::vector<vertex_property> property_merge_data;
@@ -164,31 +320,10 @@ private:
     }
   };
 
-  template <typename T>
-  struct lessPropertyCount {
-    lessPropertyCount() {}
-    bool operator()(const T& a, const T& b) {
-      return a.first < b.first;
-    }
-  };
-
   //private static member functions
 
   static inline void mergeProperty(property_map& lvalue, std::pair<property_type, int>& rvalue) {
-    typename property_map::iterator itr = std::lower_bound(lvalue.begin(), lvalue.end(), rvalue,
-                                                          lessPropertyCount<std::pair<property_type, int> >());
-    if(itr == lvalue.end() ||
-       (*itr).first != rvalue.first) {
-      lvalue.insert(itr, rvalue);
-    } else {
-      (*itr).second += rvalue.second;
-      if((*itr).second == 0)
-        lvalue.erase(itr);
-    }
-//     if(assertSorted(lvalue)) {
-//       std::cout << "in mergeProperty\n";
-//       exit(0);
-//     }
+    counts::mergeProperty(lvalue, rvalue);
   }
 
 //   static inline bool assertSorted(property_map& pset) {
@@ -211,11 +346,7 @@ private:
 //   }
 
   static inline void setProperty(property_set& pset, property_map& pmap) {
-    for(typename property_map::iterator itr = pmap.begin(); itr != pmap.end(); ++itr) {
-      if((*itr).second > 0) {
-        pset.insert(pset.end(), (*itr).first);
-      }
-    }
+    counts::setProperty(pset, pmap);
   }
 
   //private data members
@@ -231,56 +362,7 @@ private:
   //private member functions
 
   inline void mergeCount(property_map& lvalue, property_map& rvalue) {
-    typename property_map::iterator litr = lvalue.begin();
-    typename property_map::iterator ritr = rvalue.begin();
-    tmpVector.clear();
-    while(litr != lvalue.end() && ritr != rvalue.end()) {
-      if((*litr).first <= (*ritr).first) {
-        if(!tmpVector.empty() &&
-           (*litr).first == tmpVector.back().first) {
-          tmpVector.back().second += (*litr).second;
-        } else {
-          tmpVector.push_back(*litr);
-        }
-        ++litr;
-      } else if((*ritr).first <= (*litr).first) {
-        if(!tmpVector.empty() &&
-           (*ritr).first == tmpVector.back().first) {
-          tmpVector.back().second += (*ritr).second;
-        } else {
-          tmpVector.push_back(*ritr);
-        }
-        ++ritr;
-      }
-    }
-    while(litr != lvalue.end()) {
-      if(!tmpVector.empty() &&
-         (*litr).first == tmpVector.back().first) {
-        tmpVector.back().second += (*litr).second;
-      } else {
-        tmpVector.push_back(*litr);
-      }
-      ++litr;
-    }
-    while(ritr != rvalue.end()) {
-      if(!tmpVector.empty() &&
-         (*ritr).first == tmpVector.back().first) {
-        tmpVector.back().second += (*ritr).second;
-      } else {
-        tmpVector.push_back(*ritr);
-      }
-      ++ritr;
-    }
-    lvalue.clear();
-    for(std::size_t i = 0; i < tmpVector.size(); ++i) {
-      if(tmpVector[i].second != 0) {
-        lvalue.push_back(tmpVector[i]);
-      }
-    }
-//     if(assertSorted(lvalue)) {
-//       std::cout << "in mergeCount\n";
-//       exit(0);
-//     }
+    counts::mergeCount(lvalue, rvalue, tmpVector);
   }
 
   inline void processVertex(edge_property_vector& output) {
@@ -559,7 +641,7 @@ private:
     for(std::size_t i = 0; i < output.size(); ++i) {
       edge_property& edge = output[i];
       //edge.second.first is the property set on the left of the edge
-      if(!edge.second.first.empty()) {
+      if(!counts::empty(edge.second.first)) {
         typename Result::iterator itr = result.find(edge.second.first);
         if(itr == result.end()) {
           std::pair<property_set, polygon_set_type> element(edge.second.first, polygon_set_type(VERTICAL));
@@ -568,7 +650,7 @@ private:
         std::pair<interval_data<coordinate_type>, int> element2(interval_data<coordinate_type>(edge.first.low(), edge.first.high()), -1); //right edge of figure
         (*itr).second.insert(x, element2);
       }
-      if(!edge.second.second.empty()) {
+      if(!counts::empty(edge.second.second)) {
         //edge.second.second is the property set on the right of the edge
         typename Result::iterator itr = result.find(edge.second.second);
         if(itr == result.end()) {
@@ -10,6 +10,15 @@
 namespace boost { namespace polygon{
 
 namespace rectangle_formation {
+  /*
+   * ScanLineToRects slices the region swept by a scanline into rectangles.  The scanline holds the
+   * maximal intervals of the region under it, each with the coordinate its rectangle began at, in a
+   * polygon_formation::FlatTailMap keyed by the low end of the interval, so open rectangles live in
+   * a few contiguous blocks rather than one tree node each.  An edge ends the rectangles of the
+   * intervals it touches and the coverage of those intervals toggled by the edge gives the intervals
+   * whose rectangles begin at the current scan stop, which replace them in one splice.  Intervals
+   * no edge touches run on, and ending an interval that began at the current stop outputs nothing.
+   */
   template <class T>
   class ScanLineToRects {
   public:
@@ -17,20 +26,21 @@ namespace rectangle_formation {
     typedef typename rectangle_traits<T>::coordinate_type coordinate_type;
     typedef rectangle_data<coordinate_type> scan_rect_type;
   private:
-
-    typedef std::set<scan_rect_type, less_rectangle_concept<scan_rect_type, scan_rect_type> > ScanData;
+    //low end of an interval to its high end and the coordinate its rectangle began at
+    typedef polygon_formation::FlatTailMap<coordinate_type, std::pair<coordinate_type, coordinate_type> > ScanData;
     ScanData scanData_;
-    bool haveCurrentRect_;
-    scan_rect_type currentRect_;
+    //ends of the edge and of the intervals it touches
+    std::vector<coordinate_type> toggles_;
+    std::vector<typename ScanData::value_type> intervals_;
+    scan_rect_type model_;
     orientation_2d orient_;
-    typename rectangle_traits<T>::coordinate_type currentCoordinate_;
+    coordinate_type currentCoordinate_;
   public:
-    inline ScanLineToRects() : scanData_(), haveCurrentRect_(), currentRect_(), orient_(), currentCoordinate_() {}
+    inline ScanLineToRects() : scanData_(), toggles_(), intervals_(), model_(), orient_(), currentCoordinate_() {}
 
     inline ScanLineToRects(orientation_2d orient, rectangle_type model) :
-      scanData_(orientation_2d(orient.to_int() ? VERTICAL : HORIZONTAL)),
-      haveCurrentRect_(false), currentRect_(), orient_(orient), currentCoordinate_() {
-      assign(currentRect_, model);
+      scanData_(), toggles_(), intervals_(), model_(), orient_(orient), currentCoordinate_() {
+      assign(model_, model);
       currentCoordinate_ = (std::numeric_limits<coordinate_type>::max)();
     }
 
@@ -38,194 +48,120 @@ namespace rectangle_formation {
     inline ScanLineToRects& processEdge(CT& rectangles, const interval_data<coordinate_type>& edge);
 
     inline ScanLineToRects& nextMajorCoordinate(coordinate_type currentCoordinate) {
-      if(haveCurrentRect_) {
-        scanData_.insert(scanData_.end(), currentRect_);
-        haveCurrentRect_ = false;
-      }
       currentCoordinate_ = currentCoordinate;
       return *this;
     }
 
-  };
-
-  template <class CT, class ST, class rectangle_type, typename interval_type, typename coordinate_type> inline CT&
-  processEdge_(CT& rectangles, ST& scanData, const interval_type& edge,
-               bool& haveCurrentRect, rectangle_type& currentRect, coordinate_type currentCoordinate, orientation_2d orient)
-  {
-    typedef typename CT::value_type result_type;
-    bool edgeProcessed = false;
-    if(!scanData.empty()) {
-
-      //process all rectangles in the scanData that touch the edge
-      typename ST::iterator dataIter = scanData.lower_bound(rectangle_type(edge, edge));
-      //decrement beginIter until its low is less than edge's low
-      while((dataIter == scanData.end() || (*dataIter).get(orient).get(LOW) > edge.get(LOW)) &&
-            dataIter != scanData.begin())
-        {
-          --dataIter;
-        }
-      //process each rectangle until the low end of the rectangle
-      //is greater than the high end of the edge
-      while(dataIter != scanData.end() &&
-            (*dataIter).get(orient).get(LOW) <= edge.get(HIGH))
-        {
-          const rectangle_type& rect = *dataIter;
-          //if the rectangle data intersects the edge at all
-          if(rect.get(orient).get(HIGH) >= edge.get(LOW)) {
-            if(contains(rect.get(orient), edge, true)) {
-              //this is a closing edge
-              //we need to write out the intersecting rectangle and
-              //insert between 0 and 2 rectangles into the scanData
-              //write out rectangle
-              rectangle_type tmpRect = rect;
-
-              if(rect.get(orient.get_perpendicular()).get(LOW) < currentCoordinate) {
-                //set the high coordinate perpedicular to slicing orientation
-                //to the current coordinate of the scan event
-                tmpRect.set(orient.get_perpendicular().get_direction(HIGH),
-                            currentCoordinate);
-                result_type result;
-                assign(result, tmpRect);
-                rectangles.insert(rectangles.end(), result);
-              }
-              //erase the rectangle from the scan data
-              typename ST::iterator nextIter = dataIter;
-              ++nextIter;
-              scanData.erase(dataIter);
-              if(tmpRect.get(orient).get(LOW) < edge.get(LOW)) {
-                //insert a rectangle for the overhang of the bottom
-                //of the rectangle back into scan data
-                rectangle_type lowRect(tmpRect);
-                lowRect.set(orient.get_perpendicular(), interval_data<coordinate_type>(currentCoordinate,
-                                                                currentCoordinate));
-                lowRect.set(orient.get_direction(HIGH), edge.get(LOW));
-                scanData.insert(nextIter, lowRect);
-              }
-              if(tmpRect.get(orient).get(HIGH) > edge.get(HIGH)) {
-                //insert a rectangle for the overhang of the top
-                //of the rectangle back into scan data
-                rectangle_type highRect(tmpRect);
-                highRect.set(orient.get_perpendicular(), interval_data<coordinate_type>(currentCoordinate,
-                                                                 currentCoordinate));
-                highRect.set(orient.get_direction(LOW), edge.get(HIGH));
-                scanData.insert(nextIter, highRect);
-              }
-              //we are done with this edge
-              edgeProcessed = true;
-              break;
-            } else {
-              //it must be an opening edge
-              //assert that rect does not overlap the edge but only touches
-              //write out rectangle
-              rectangle_type tmpRect = rect;
-              //set the high coordinate perpedicular to slicing orientation
-              //to the current coordinate of the scan event
-              if(tmpRect.get(orient.get_perpendicular().get_direction(LOW)) < currentCoordinate) {
-                tmpRect.set(orient.get_perpendicular().get_direction(HIGH),
-                            currentCoordinate);
-                result_type result;
-                assign(result, tmpRect);
-                rectangles.insert(rectangles.end(), result);
-              }
-              //erase the rectangle from the scan data
-              typename ST::iterator nextIter = dataIter;
-              ++nextIter;
-              scanData.erase(dataIter);
-              dataIter = nextIter;
-              if(haveCurrentRect) {
-                if(currentRect.get(orient).get(HIGH) >= edge.get(LOW)){
-                  if(!edgeProcessed && currentRect.get(orient.get_direction(HIGH)) > edge.get(LOW)){
-                    rectangle_type tmpRect2(currentRect);
-                    tmpRect2.set(orient.get_direction(HIGH), edge.get(LOW));
-                    scanData.insert(nextIter, tmpRect2);
-                    if(currentRect.get(orient.get_direction(HIGH)) > edge.get(HIGH)) {
-                      currentRect.set(orient, interval_data<coordinate_type>(edge.get(HIGH), currentRect.get(orient.get_direction(HIGH))));
-                    } else {
-                      haveCurrentRect = false;
-                    }
-                  } else {
-                    //extend the top of current rect
-                    currentRect.set(orient.get_direction(HIGH),
-                                    (std::max)(edge.get(HIGH),
-                                               tmpRect.get(orient.get_direction(HIGH))));
-                  }
-                } else {
-                  //insert current rect into the scanData
-                  scanData.insert(nextIter, currentRect);
-                  //create a new current rect
-                  currentRect.set(orient.get_perpendicular(), interval_data<coordinate_type>(currentCoordinate,
-                                                                      currentCoordinate));
-                  currentRect.set(orient, interval_data<coordinate_type>((std::min)(tmpRect.get(orient).get(LOW),
-                                                       edge.get(LOW)),
-                                                                         (std::max)(tmpRect.get(orient).get(HIGH),
-                                                       edge.get(HIGH))));
-                }
-              } else {
-                haveCurrentRect = true;
-                currentRect.set(orient.get_perpendicular(), interval_data<coordinate_type>(currentCoordinate,
-                                                                    currentCoordinate));
-                currentRect.set(orient, interval_data<coordinate_type>((std::min)(tmpRect.get(orient).get(LOW),
-                                                     edge.get(LOW)),
-                                                                       (std::max)(tmpRect.get(orient).get(HIGH),
-                                                     edge.get(HIGH))));
-              }
-              //skip to nextIter position
-              edgeProcessed = true;
-              continue;
-            }
-            //edgeProcessed = true;
-          }
-          ++dataIter;
-        } //end while edge intersects rectangle data
-
-    }
-    if(!edgeProcessed) {
-      if(haveCurrentRect) {
-        if(currentRect.get(orient.get_perpendicular().get_direction(HIGH))
-           == currentCoordinate &&
-           currentRect.get(orient.get_direction(HIGH)) >= edge.get(LOW))
-          {
-            if(currentRect.get(orient.get_direction(HIGH)) > edge.get(LOW)){
-              rectangle_type tmpRect(currentRect);
-              tmpRect.set(orient.get_direction(HIGH), edge.get(LOW));
-              scanData.insert(scanData.end(), tmpRect);
-              if(currentRect.get(orient.get_direction(HIGH)) > edge.get(HIGH)) {
-                currentRect.set(orient,
-                                interval_data<coordinate_type>(edge.get(HIGH),
-                                         currentRect.get(orient.get_direction(HIGH))));
-                return rectangles;
-              } else {
-                haveCurrentRect = false;
-                return rectangles;
-              }
-            }
-            //extend current rect
-            currentRect.set(orient.get_direction(HIGH), edge.get(HIGH));
-            return rectangles;
-          }
-        scanData.insert(scanData.end(), currentRect);
-        haveCurrentRect = false;
-      }
-      rectangle_type tmpRect(currentRect);
-      tmpRect.set(orient.get_perpendicular(), interval_data<coordinate_type>(currentCoordinate,
-                                                      currentCoordinate));
-      tmpRect.set(orient, edge);
-      scanData.insert(tmpRect);
-      return rectangles;
+  private:
+    template <typename CT>
+    inline void endRect_(CT& rectangles, coordinate_type low, coordinate_type high, coordinate_type begin) {
+      if(begin == currentCoordinate_)
+        return;
+      scan_rect_type rect(model_);
+      rect.set(orient_, interval_data<coordinate_type>(low, high));
+      rect.set(orient_.get_perpendicular(), interval_data<coordinate_type>(begin, currentCoordinate_));
+      typename CT::value_type result;
+      assign(result, rect);
+      rectangles.insert(rectangles.end(), result);
     }
-    return rectangles;
-
-  }
+  };
 
   template <class T>
   template <class CT>
   inline
   ScanLineToRects<T>& ScanLineToRects<T>::processEdge(CT& rectangles, const interval_data<coordinate_type>& edge)
   {
-    processEdge_(rectangles, scanData_, edge, haveCurrentRect_, currentRect_, currentCoordinate_, orient_);
+    //the interval before the edge touches it only if it reaches the low end of the edge
+    typename ScanData::iterator first = scanData_.lower_bound(edge.low());
+    if(first != scanData_.begin()) {
+      typename ScanData::iterator prev = first;
+      --prev;
+      if((*prev).second.first >= edge.low())
+        first = prev;
+    }
+    if(first == scanData_.end() || (*first).first > edge.high()) {
+      //an edge that touches nothing opens an interval of its own
+      scanData_.insert(std::make_pair(edge.low(), std::make_pair(edge.high(), currentCoordinate_)));
+      return *this;
+    }
+    toggles_.clear();
+    std::size_t count = 0;
+    for(typename ScanData::iterator itr = first; itr != scanData_.end() && (*itr).first <= edge.high(); ++itr) {
+      endRect_(rectangles, (*itr).first, (*itr).second.first, (*itr).second.second);
+      toggles_.push_back((*itr).first);
+      toggles_.push_back((*itr).second.first);
+      ++count;
+    }
+    //the ends of the intervals are in order already, insert the ends of the edge among them
+    toggles_.push_back(edge.low());
+    toggles_.push_back(edge.high());
+    for(std::size_t i = toggles_.size() - 2; i < toggles_.size(); ++i)
+      for(std::size_t j = i; j > 0 && toggles_[j] < toggles_[j - 1]; --j)
+        std::swap(toggles_[j], toggles_[j - 1]);
+    //an end seen an odd number of times toggles the coverage
+    intervals_.clear();
+    bool covered = false;
+    for(std::size_t i = 0; i < toggles_.size(); ) {
+      std::size_t j = i + 1;
+      while(j < toggles_.size() && toggles_[j] == toggles_[i]) ++j;
+      if((j - i) % 2) {
+        if(covered)
+          intervals_.back().second.first = toggles_[i];
+        else
+          intervals_.push_back(std::make_pair(toggles_[i], std::make_pair(toggles_[i], currentCoordinate_)));
+        covered = !covered;
+      }
+      i = j;
+    }
+    scanData_.replace(first, count, intervals_.begin(), intervals_.end());
     return *this;
   }
 
+  //output of ScanLineToRects that hands each rectangle to sink instead of collecting it
+  template <typename sink_type, typename Unit>
+  class SinkOutput {
+  public:
+    typedef rectangle_data<Unit> value_type;
+    typedef int iterator;
+  private:
+    sink_type& sink_;
+  public:
+    inline explicit SinkOutput(sink_type& sink) : sink_(sink) {}
+    inline iterator end() const { return 0; }
+    inline void insert(iterator, const value_type& rectangle) { sink_(rectangle); }
+  };
+
+  //adds up the area of the rectangles it is given
+  template <typename area_type>
+  struct AreaSum {
+    area_type area;
+    inline AreaSum() : area(0) {}
+    template <typename rectangle_type>
+    inline void operator()(const rectangle_type& rectangle) {
+      area += (area_type)::boost::polygon::area(rectangle);
+    }
+  };
+
+  //drives scanline over sorted polygon_90_set_data vertices in [begin, end), output gets the rectangles
+  template <typename output_container, typename iterator_type, typename Unit>
+  inline void formRectangles(output_container& output, iterator_type begin, iterator_type end,
+                             ScanLineToRects<rectangle_data<Unit> >& scanlineToRects) {
+    Unit prevPos = (std::numeric_limits<Unit>::max)();
+    for(iterator_type itr = begin;
+        itr != end; ++ itr) {
+      Unit pos = (*itr).first;
+      if(pos != prevPos) {
+        scanlineToRects.nextMajorCoordinate(pos);
+        prevPos = pos;
+      }
+      Unit lowy = (*itr).second.first;
+      iterator_type tmp_itr = itr;
+      ++itr;
+      Unit highy = (*itr).second.first;
+      scanlineToRects.processEdge(output, interval_data<Unit>(lowy, highy));
+      if(abs((*itr).second.second) > 1) itr = tmp_itr; //next edge begins from this vertex
+    }
+  }
 
 } //namespace rectangle_formation
 
@@ -244,22 +180,20 @@ namespace rectangle_formation {
     typedef typename output_container::value_type rectangle_type;
     typedef typename get_coordinate_type_for_rectangles<rectangle_type, typename geometry_concept<rectangle_type>::type>::type Unit;
     rectangle_data<Unit> model;
-    Unit prevPos = (std::numeric_limits<Unit>::max)();
     rectangle_formation::ScanLineToRects<rectangle_data<Unit> > scanlineToRects(orient, model);
-    for(iterator_type itr = begin;
-        itr != end; ++ itr) {
-      Unit pos = (*itr).first;
-      if(pos != prevPos) {
-        scanlineToRects.nextMajorCoordinate(pos);
-        prevPos = pos;
-      }
-      Unit lowy = (*itr).second.first;
-      iterator_type tmp_itr = itr;
-      ++itr;
-      Unit highy = (*itr).second.first;
-      scanlineToRects.processEdge(output, interval_data<Unit>(lowy, highy));
-      if(abs((*itr).second.second) > 1) itr = tmp_itr; //next edge begins from this vertex
-    }
+    rectangle_formation::formRectangles(output, begin, end, scanlineToRects);
+  }
+
+  //public API to stream the rectangles form_rectangles slices the sorted vertices [begin, end) into,
+  //sink is called with a rectangle_data as soon as the scan stop that ends the rectangle is
+  //processed, so the rectangles are never collected and memory is bounded by the scanline
+  template <typename sink_type, typename iterator_type>
+  void get_rectangles_to_sink(sink_type& sink, iterator_type begin, iterator_type end, orientation_2d orient) {
+    typedef typename std::iterator_traits<iterator_type>::value_type::first_type Unit;
+    rectangle_data<Unit> model;
+    rectangle_formation::ScanLineToRects<rectangle_data<Unit> > scanlineToRects(orient, model);
+    rectangle_formation::SinkOutput<sink_type, Unit> output(sink);
+    rectangle_formation::formRectangles(output, begin, end, scanlineToRects);
   }
 }
 }
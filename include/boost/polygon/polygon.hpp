@@ -44,11 +44,13 @@
 #include "polygon_90_with_holes_data.hpp"
 #include "polygon_45_with_holes_data.hpp"
 #include "polygon_with_holes_data.hpp"
+#include "polygon_buffer.hpp"
 #include "polygon_traits.hpp"
 
 //manhattan boolean algorithms
 #include "detail/boolean_op.hpp"
 #include "detail/polygon_formation.hpp"
+#include "detail/boolean_op_tiles.hpp"
 #include "detail/rectangle_formation.hpp"
 #include "detail/max_cover.hpp"
 #include "detail/property_merge.hpp"
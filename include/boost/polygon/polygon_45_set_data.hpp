@@ -126,17 +126,24 @@ namespace boost { namespace polygon{
 
     template <typename coordinate_type_2>
     inline void insert(const polygon_90_set_data<coordinate_type_2>& polygon_set, bool is_hole = false) {
-      if(polygon_set.orient() == VERTICAL) {
-        for(typename polygon_90_set_data<coordinate_type_2>::iterator_type itr = polygon_set.begin();
-            itr != polygon_set.end(); ++itr) {
+      if(polygon_set.compacted())
+        insert_90_vertices(polygon_set.begin_compact(), polygon_set.end_compact(), polygon_set.orient(), is_hole);
+      else
+        insert_90_vertices(polygon_set.begin(), polygon_set.end(), polygon_set.orient(), is_hole);
+    }
+
+    //the (major, (minor, count)) vertices of a polygon_90_set_data in orientation orient
+    template <typename iT>
+    inline void insert_90_vertices(iT begin_vertices, iT end_vertices, orientation_2d orient, bool is_hole) {
+      if(orient == VERTICAL) {
+        for(iT itr = begin_vertices; itr != end_vertices; ++itr) {
           Vertex45Compact vertex_45(point_data<Unit>((*itr).first, (*itr).second.first), 2, (*itr).second.second);
           vertex_45.count[1] = (*itr).second.second;
           if(is_hole) vertex_45.count[1] *= - 1;
           insert_clean(vertex_45, is_hole);
         }
       } else {
-        for(typename polygon_90_set_data<coordinate_type_2>::iterator_type itr = polygon_set.begin();
-            itr != polygon_set.end(); ++itr) {
+        for(iT itr = begin_vertices; itr != end_vertices; ++itr) {
           Vertex45Compact vertex_45(point_data<Unit>((*itr).second.first, (*itr).first), 2, (*itr).second.second);
           vertex_45.count[1] = (*itr).second.second;
           if(is_hole) vertex_45.count[1] *= - 1;
@@ -152,6 +159,13 @@ namespace boost { namespace polygon{
       get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type());
     }
 
+    //figures are cut with vertical edges once they reach vthreshold vertices, the vertices of their
+    //holes included, so a polygon can only exceed vthreshold by what one scan stop adds to it
+    template <typename output_container>
+    inline void get(output_container& output, size_t vthreshold) const {
+      get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type(), vthreshold);
+    }
+
     inline bool has_error_data() const { return !error_data_.empty(); }
     inline std::size_t error_count() const { return error_data_.size() / 4; }
     inline void get_error_data(polygon_45_set_data& p) const {
@@ -226,6 +240,15 @@ namespace boost { namespace polygon{
       unsorted_ = true;
     }
 
+    //set_clean of the vertices of a range, which must be sorted and clean already
+    template <typename input_iterator_type>
+    void set_clean(input_iterator_type input_begin, input_iterator_type input_end) {
+      clear();
+      reserve(std::distance(input_begin, input_end));
+      for( ; input_begin != input_end; ++input_begin)
+        insert_clean(*input_begin);
+    }
+
     void set_clean(const value_type& value) {
       data_ = value;
       dirty_ = false;
@@ -350,25 +373,29 @@ namespace boost { namespace polygon{
   private:
     //functions
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_45_concept tag) const {
-      get_fracture(output, true, tag);
+    void get_dispatch(output_container& output, polygon_45_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, true, tag, vthreshold);
     }
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_45_with_holes_concept tag) const {
-      get_fracture(output, false, tag);
+    void get_dispatch(output_container& output, polygon_45_with_holes_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, false, tag, vthreshold);
     }
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_concept tag) const {
-      get_fracture(output, true, tag);
+    void get_dispatch(output_container& output, polygon_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, true, tag, vthreshold);
     }
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_with_holes_concept tag) const {
-      get_fracture(output, false, tag);
+    void get_dispatch(output_container& output, polygon_with_holes_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, false, tag, vthreshold);
     }
     template <typename output_container, typename concept_type>
-    void get_fracture(output_container& container, bool fracture_holes, concept_type ) const {
+    void get_fracture(output_container& container, bool fracture_holes, concept_type, size_t vthreshold) const {
       clean();
-      typename polygon_45_formation<Unit>::Polygon45Formation pf(fracture_holes);
+      typename polygon_45_formation<Unit>::Polygon45Formation pf(fracture_holes, vthreshold);
       //std::cout << "FORMING POLYGONS\n";
       pf.scan(container, data_.begin(), data_.end());
     }
@@ -0,0 +1,233 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_90_EXTERNAL_SET_DATA_HPP
+#define BOOST_POLYGON_POLYGON_90_EXTERNAL_SET_DATA_HPP
+#include "polygon.hpp"
+#include "detail/polygon_90_external_run.hpp"
+
+namespace boost { namespace polygon{
+
+  /*
+   * polygon_90_external_set_data is a polygon_90_set_data for sets that do not fit in memory.
+   * Inserted vertices are buffered and, every buffer_size vertices, sorted, cleaned and spilled
+   * to a temporary file as a sorted run.  clean merges the runs into a single clean run, and the
+   * booleans and get stream clean runs through buffers of about buffer_size vertices in all, so
+   * memory is bounded by the buffers and the scanline of the sweep, the output of get aside.
+   * The temporary files are removed with the set.  I/O failures throw std::runtime_error.
+   */
+  template <typename T>
+  class polygon_90_external_set_data {
+  public:
+    typedef T coordinate_type;
+    typedef std::pair<coordinate_type, std::pair<coordinate_type, int> > vertex_type;
+  private:
+    typedef external_sort::VertexRun<coordinate_type> run_type;
+    typedef external_sort::RunReader<coordinate_type> reader_type;
+    typedef external_sort::RunMerge<coordinate_type> merge_type;
+    orientation_2d orient_;
+    std::size_t bufferSize_;
+    mutable std::vector<vertex_type> buffer_;
+    mutable std::vector<run_type*> runs_;
+    mutable bool dirty_;
+    polygon_90_external_set_data(const polygon_90_external_set_data&);
+    polygon_90_external_set_data& operator=(const polygon_90_external_set_data&);
+  public:
+    // constructor, buffer_size is the number of vertices held in memory at a time
+    inline explicit polygon_90_external_set_data(orientation_2d orient = HORIZONTAL, std::size_t buffer_size = 1 << 20) :
+      orient_(orient), bufferSize_(buffer_size < 1024 ? 1024 : buffer_size), buffer_(), runs_(), dirty_(false) {}
+
+    inline ~polygon_90_external_set_data() { clear(); }
+
+    inline orientation_2d orient() const { return orient_; }
+
+    inline void clear() {
+      for(std::size_t i = 0; i < runs_.size(); ++i)
+        delete runs_[i];
+      runs_.clear();
+      std::vector<vertex_type>().swap(buffer_);
+      dirty_ = false;
+    }
+
+    inline void insert(const vertex_type& vertex, bool is_hole = false, orientation_2d orient = HORIZONTAL) {
+      if(buffer_.size() == bufferSize_)
+        spill_();
+      dirty_ = true;
+      buffer_.push_back(vertex);
+      if(orient != orient_) std::swap(buffer_.back().first, buffer_.back().second.first);
+      if(is_hole) buffer_.back().second.second *= -1;
+    }
+
+    template <typename geometry_type>
+    inline void insert(const geometry_type& geometry_object, bool is_hole = false) {
+      iterator_geometry_to_set<typename geometry_concept<geometry_type>::type, geometry_type>
+        begin_input(geometry_object, LOW, orient_, is_hole), end_input(geometry_object, HIGH, orient_, is_hole);
+      for( ; begin_input != end_input; ++begin_input)
+        insert(*begin_input, false, orient_);
+    }
+
+    inline void insert(const polygon_90_set_data<coordinate_type>& polygon_set) {
+      if(polygon_set.compacted())
+        insert_vertices_(polygon_set.begin_compact(), polygon_set.end_compact(), polygon_set.orient());
+      else
+        insert_vertices_(polygon_set.begin(), polygon_set.end(), polygon_set.orient());
+    }
+
+    //merges the runs into a single clean run
+    inline void clean() const {
+      if(!dirty_)
+        return;
+      spill_();
+      dirty_ = false;
+      if(runs_.size() < 2)
+        return; //a single run was cleaned when it was spilled
+      run_type* output = new run_type();
+      try {
+        merge_type merge(runs_, bufferSize_);
+        external_sort::SourceIterator<merge_type> end;
+        sweep_(*output, external_sort::SourceIterator<merge_type>(merge), end, end, end,
+               boolean_op::BinaryCount<boolean_op::BinaryOr>(), bufferSize_ / 2);
+      } catch(...) {
+        delete output;
+        throw;
+      }
+      replace_(output);
+    }
+
+    //number of vertices, which cleans the set
+    inline polygon_ulong_long_type size() const {
+      clean();
+      return runs_.empty() ? 0 : runs_[0]->size();
+    }
+
+    inline bool empty() const { return size() == 0; }
+
+    //bytes of vertices held in memory between calls
+    inline std::size_t memory() const { return buffer_.capacity() * sizeof(vertex_type); }
+
+    //Sets this to the boolean of the sets a and b, which have the orientation of this set and may be
+    //this set, as polygon_90_set_data::applyBooleanBinaryOp does with defaultCount, for example
+    //boolean_op::BinaryCount<boolean_op::BinaryAnd>() for their intersection
+    template <class T2>
+    inline void applyBooleanBinaryOp(const polygon_90_external_set_data& a, const polygon_90_external_set_data& b,
+                                     T2 defaultCount) {
+      a.clean();
+      b.clean();
+      run_type* output = new run_type();
+      try {
+        reader_type readerA(a.runs_.empty() ? 0 : a.runs_[0], bufferSize_ / 3);
+        reader_type readerB(b.runs_.empty() ? 0 : b.runs_[0], bufferSize_ / 3);
+        external_sort::SourceIterator<reader_type> end;
+        sweep_(*output, external_sort::SourceIterator<reader_type>(readerA), end,
+               external_sort::SourceIterator<reader_type>(readerB), end, defaultCount, bufferSize_ / 3);
+      } catch(...) {
+        delete output;
+        throw;
+      }
+      clear();
+      replace_(output);
+    }
+
+    //forms the polygons of the set into output_container, as polygon_90_set_data::get does
+    template <class output_container>
+    inline void get(output_container& output) const {
+      get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type());
+    }
+
+    //replaces output by the clean vertices of the set, output takes the orientation of this set
+    //and is left clean and sorted
+    inline void get(polygon_90_set_data<coordinate_type>& output) const {
+      clean();
+      if(runs_.empty()) {
+        output.set_clean(buffer_.begin(), buffer_.end(), orient_);
+        return;
+      }
+      reader_type reader(runs_[0], bufferSize_);
+      output.clear();
+      output.reserve((std::size_t)runs_[0]->size());
+      output.set_clean(external_sort::SourceIterator<reader_type>(reader), external_sort::SourceIterator<reader_type>(),
+                       orient_);
+    }
+
+  private:
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_90_concept tag) const {
+      get_fracture(output, true, tag);
+    }
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_90_with_holes_concept tag) const {
+      get_fracture(output, false, tag);
+    }
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_45_concept tag) const {
+      get_fracture(output, true, tag);
+    }
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_45_with_holes_concept tag) const {
+      get_fracture(output, false, tag);
+    }
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_concept tag) const {
+      get_fracture(output, true, tag);
+    }
+    template <typename output_container>
+    void get_dispatch(output_container& output, polygon_with_holes_concept tag) const {
+      get_fracture(output, false, tag);
+    }
+    template <typename output_container, typename concept_type>
+    void get_fracture(output_container& container, bool fracture_holes, concept_type tag) const {
+      clean();
+      reader_type reader(runs_.empty() ? 0 : runs_[0], bufferSize_);
+      ::boost::polygon::get_polygons(container, external_sort::SourceIterator<reader_type>(reader),
+                                     external_sort::SourceIterator<reader_type>(), orient_, fracture_holes, tag);
+    }
+
+    template <typename iT>
+    void insert_vertices_(iT begin_vertices, iT end_vertices, orientation_2d orient) {
+      for( ; begin_vertices != end_vertices; ++begin_vertices)
+        insert(*begin_vertices, false, orient);
+    }
+
+    //the sweep of a boolean from the inputs into run
+    template <class T2, typename iterator_type_1, typename iterator_type_2>
+    static void sweep_(run_type& run, iterator_type_1 itr1, iterator_type_1 itr1_end,
+                       iterator_type_2 itr2, iterator_type_2 itr2_end, T2 defaultCount, std::size_t bufferSize) {
+      external_sort::RunWriter<coordinate_type> writer(run, bufferSize);
+      boolean_op::BooleanOpFlat<T2, coordinate_type> boolean(defaultCount);
+      boolean_op::applyBooleanBinaryOp(writer, itr1, itr1_end, itr2, itr2_end, defaultCount, boolean);
+      writer.flush();
+    }
+
+    //sorts, cleans and writes out the buffer as a run
+    void spill_() const {
+      if(buffer_.empty())
+        return;
+      polygon_sort(buffer_.begin(), buffer_.end());
+      boolean_op::default_arg_workaround<int>::applyBooleanOr(buffer_);
+      run_type* run = new run_type();
+      try {
+        run->append(&buffer_[0], buffer_.size());
+        runs_.push_back(run);
+      } catch(...) {
+        delete run;
+        throw;
+      }
+      buffer_.clear();
+    }
+
+    //makes run the only run of the set
+    void replace_(run_type* run) const {
+      for(std::size_t i = 0; i < runs_.size(); ++i)
+        delete runs_[i];
+      runs_.clear();
+      runs_.push_back(run);
+    }
+  };
+
+}
+}
+#endif
@@ -39,6 +39,33 @@ namespace boost { namespace polygon{
     return polygon_90_set_traits<polygon_set_type>::clean(polygon_set);
   }
 
+  //a polygon_90_set_data is read through the iterators of its own layout, packed or not, rather
+  //than through begin_90_set_data, whose iterator checks the layout at every vertex
+  template <typename polygon_set_type_1, typename polygon_set_type_2>
+  inline void assign_90_set_data(polygon_set_type_1& lvalue, const polygon_set_type_2& rvalue) {
+    polygon_90_set_mutable_traits<polygon_set_type_1>::set(lvalue, begin_90_set_data(rvalue), end_90_set_data(rvalue),
+                                                           scanline_orientation(rvalue));
+  }
+
+  template <typename polygon_set_type_1, typename T>
+  inline void assign_90_set_data(polygon_set_type_1& lvalue, const polygon_90_set_data<T>& rvalue) {
+    if(rvalue.compacted())
+      polygon_90_set_mutable_traits<polygon_set_type_1>::set(lvalue, rvalue.begin_compact(), rvalue.end_compact(),
+                                                             rvalue.orient());
+    else
+      polygon_90_set_mutable_traits<polygon_set_type_1>::set(lvalue, rvalue.begin(), rvalue.end(), rvalue.orient());
+  }
+
+  template <typename polygon_set_type>
+  inline bool empty_90_set_data(const polygon_set_type& polygon_set) {
+    return begin_90_set_data(polygon_set) == end_90_set_data(polygon_set);
+  }
+
+  template <typename T>
+  inline bool empty_90_set_data(const polygon_90_set_data<T>& polygon_set) {
+    return polygon_set.empty();
+  }
+
   //assign
   template <typename polygon_set_type_1, typename polygon_set_type_2>
   typename enable_if <
@@ -47,8 +74,7 @@ namespace boost { namespace polygon{
       typename is_polygon_90_set_type<polygon_set_type_2>::type>::type,
     polygon_set_type_1>::type &
   assign(polygon_set_type_1& lvalue, const polygon_set_type_2& rvalue) {
-    polygon_90_set_mutable_traits<polygon_set_type_1>::set(lvalue, begin_90_set_data(rvalue), end_90_set_data(rvalue),
-                                                           scanline_orientation(rvalue));
+    assign_90_set_data(lvalue, rvalue);
     return lvalue;
   }
 
@@ -126,7 +152,7 @@ namespace boost { namespace polygon{
   typename enable_if< typename is_mutable_polygon_90_set_type<polygon_set_type>::type,
                        bool>::type
   empty(const polygon_set_type& polygon_set) {
-    if(clean(polygon_set)) return begin_90_set_data(polygon_set) == end_90_set_data(polygon_set);
+    if(clean(polygon_set)) return empty_90_set_data(polygon_set);
     polygon_90_set_data<typename polygon_90_set_traits<polygon_set_type>::coordinate_type> ps;
     assign(ps, polygon_set);
     ps.clean();
@@ -151,15 +177,13 @@ namespace boost { namespace polygon{
   typename enable_if< typename is_mutable_polygon_90_set_type<polygon_set_type>::type,
                        typename coordinate_traits<typename polygon_90_set_traits<polygon_set_type>::coordinate_type>::manhattan_area_type>::type
   area(const polygon_set_type& polygon_set) {
-    typedef rectangle_data<typename polygon_90_set_traits<polygon_set_type>::coordinate_type> rectangle_type;
-    typedef typename coordinate_traits<typename polygon_90_set_traits<polygon_set_type>::coordinate_type>::manhattan_area_type area_type;
-    std::vector<rectangle_type> rects;
-    assign(rects, polygon_set);
-    area_type retval = (area_type)0;
-    for(std::size_t i = 0; i < rects.size(); ++i) {
-      retval += (area_type)area(rects[i]);
-    }
-    return retval;
+    typedef typename polygon_90_set_traits<polygon_set_type>::coordinate_type Unit;
+    typedef typename coordinate_traits<Unit>::manhattan_area_type area_type;
+    polygon_90_set_data<Unit> ps;
+    assign(ps, polygon_set);
+    rectangle_formation::AreaSum<area_type> sum;
+    ps.get_rectangles_to_sink(sum);
+    return sum.area;
   }
 
   //interact
@@ -7,6 +7,7 @@
 */
 #ifndef BOOST_POLYGON_POLYGON_90_SET_DATA_HPP
 #define BOOST_POLYGON_POLYGON_90_SET_DATA_HPP
+#include <cassert>
 #include "isotropy.hpp"
 #include "point_concept.hpp"
 #include "transform.hpp"
@@ -16,15 +17,18 @@
 #include "detail/iterator_points_to_compact.hpp"
 #include "detail/iterator_compact_to_points.hpp"
 #include "polygon_traits.hpp"
+#include "polygon_buffer.hpp"
 
 //manhattan boolean algorithms
 #include "detail/boolean_op.hpp"
 #include "detail/polygon_formation.hpp"
+#include "detail/boolean_op_tiles.hpp"
 #include "detail/rectangle_formation.hpp"
 #include "detail/max_cover.hpp"
 #include "detail/property_merge.hpp"
 #include "detail/polygon_90_touch.hpp"
 #include "detail/iterator_geometry_to_set.hpp"
+#include "detail/polygon_90_compact_data.hpp"
 
 namespace boost { namespace polygon{
   template <typename ltype, typename rtype, typename op_type>
@@ -37,17 +41,58 @@ namespace boost { namespace polygon{
     typedef std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > > value_type;
     typedef typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::const_iterator iterator_type;
     typedef polygon_90_set_data operator_arg_type;
+    typedef typename polygon_90_compact_data<coordinate_type>::iterator compact_iterator_type;
+
+    //iterator over the vertices of a set whether or not it is compacted, it hands out the
+    //vertices by value as compact_iterator_type does
+    class vertex_iterator_type {
+    private:
+      const polygon_90_set_data* set_;
+      std::size_t index_;
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef typename polygon_90_set_data::value_type::value_type value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const value_type* pointer; //immutable
+      typedef value_type reference; //by value, a packed vertex has no pair to refer to
+
+      inline vertex_iterator_type() : set_(0), index_(0) {}
+      inline vertex_iterator_type(const polygon_90_set_data* set, std::size_t index) : set_(set), index_(index) {}
+      //use bitwise copy and assign provided by the compiler
+      inline value_type operator*() const {
+        return set_->compacted_ ? *(set_->compact_.begin() + index_) : set_->data_[index_];
+      }
+      inline value_type operator[](difference_type n) const { return *(*this + n); }
+      inline vertex_iterator_type& operator++() { ++index_; return *this; }
+      inline vertex_iterator_type operator++(int) { vertex_iterator_type tmp(*this); ++index_; return tmp; }
+      inline vertex_iterator_type& operator--() { --index_; return *this; }
+      inline vertex_iterator_type operator--(int) { vertex_iterator_type tmp(*this); --index_; return tmp; }
+      inline vertex_iterator_type& operator+=(difference_type n) { index_ += n; return *this; }
+      inline vertex_iterator_type& operator-=(difference_type n) { index_ -= n; return *this; }
+      inline vertex_iterator_type operator+(difference_type n) const { vertex_iterator_type tmp(*this); return tmp += n; }
+      inline vertex_iterator_type operator-(difference_type n) const { vertex_iterator_type tmp(*this); return tmp -= n; }
+      inline difference_type operator-(const vertex_iterator_type& that) const {
+        return (difference_type)index_ - (difference_type)that.index_;
+      }
+      inline bool operator==(const vertex_iterator_type& that) const { return index_ == that.index_; }
+      inline bool operator!=(const vertex_iterator_type& that) const { return index_ != that.index_; }
+      inline bool operator<(const vertex_iterator_type& that) const { return index_ < that.index_; }
+      inline bool operator<=(const vertex_iterator_type& that) const { return index_ <= that.index_; }
+      inline bool operator>(const vertex_iterator_type& that) const { return index_ > that.index_; }
+      inline bool operator>=(const vertex_iterator_type& that) const { return index_ >= that.index_; }
+    };
+    friend class vertex_iterator_type;
 
     // default constructor
-    inline polygon_90_set_data() : orient_(HORIZONTAL), data_(), dirty_(false), unsorted_(false) {}
+    inline polygon_90_set_data() : orient_(HORIZONTAL), data_(), dirty_(false), unsorted_(false), cleanSize_(0), compact_(), compacted_(false) {}
 
     // constructor
-    inline polygon_90_set_data(orientation_2d orient) : orient_(orient), data_(), dirty_(false), unsorted_(false) {}
+    inline polygon_90_set_data(orientation_2d orient) : orient_(orient), data_(), dirty_(false), unsorted_(false), cleanSize_(0), compact_(), compacted_(false) {}
 
     // constructor from an iterator pair over vertex data
     template <typename iT>
     inline polygon_90_set_data(orientation_2d orient, iT input_begin, iT input_end) :
-      orient_(HORIZONTAL), data_(), dirty_(false), unsorted_(false) {
+      orient_(HORIZONTAL), data_(), dirty_(false), unsorted_(false), cleanSize_(0), compact_(), compacted_(false) {
       dirty_ = true;
       unsorted_ = true;
       for( ; input_begin != input_end; ++input_begin) { insert(*input_begin); }
@@ -55,15 +100,19 @@ namespace boost { namespace polygon{
 
     // copy constructor
     inline polygon_90_set_data(const polygon_90_set_data& that) :
-      orient_(that.orient_), data_(that.data_), dirty_(that.dirty_), unsorted_(that.unsorted_) {}
+      orient_(that.orient_), data_(that.data_), dirty_(that.dirty_), unsorted_(that.unsorted_),
+      cleanSize_(that.cleanSize_), compact_(that.compact_), compacted_(that.compacted_) {}
 
     template <typename ltype, typename rtype, typename op_type>
     inline polygon_90_set_data(const polygon_90_set_view<ltype, rtype, op_type>& that);
 
     // copy with orientation change constructor
     inline polygon_90_set_data(orientation_2d orient, const polygon_90_set_data& that) :
-      orient_(orient), data_(), dirty_(false), unsorted_(false) {
-      insert(that, false, that.orient_);
+      orient_(orient), data_(), dirty_(false), unsorted_(false), cleanSize_(0), compact_(), compacted_(false) {
+      if(that.compacted_)
+        insert(that.compact_.begin(), that.compact_.end(), that.orient_);
+      else
+        insert(that.data_.begin(), that.data_.end(), that.orient_);
     }
 
     // destructor
@@ -76,6 +125,9 @@ namespace boost { namespace polygon{
       data_ = that.data_;
       dirty_ = that.dirty_;
       unsorted_ = that.unsorted_;
+      cleanSize_ = that.cleanSize_;
+      compact_ = that.compact_;
+      compacted_ = that.compacted_;
       return *this;
     }
 
@@ -84,16 +136,16 @@ namespace boost { namespace polygon{
 
     template <typename geometry_object>
     inline polygon_90_set_data& operator=(const geometry_object& geometry) {
-      data_.clear();
+      clear();
       insert(geometry);
       return *this;
     }
 
     // insert iterator range
     inline void insert(iterator_type input_begin, iterator_type input_end, orientation_2d orient = HORIZONTAL) {
+      expand();
       if(input_begin == input_end || (!data_.empty() && &(*input_begin) == &(*(data_.begin())))) return;
-      dirty_ = true;
-      unsorted_ = true;
+      mark_dirty_();
       if(orient == orient_)
         data_.insert(data_.end(), input_begin, input_end);
       else {
@@ -107,15 +159,18 @@ namespace boost { namespace polygon{
     template <typename iT>
     inline void insert(iT input_begin, iT input_end, orientation_2d orient = HORIZONTAL) {
       if(input_begin == input_end) return;
-      dirty_ = true;
-      unsorted_ = true;
+      expand();
+      mark_dirty_();
       for( ; input_begin != input_end; ++input_begin) {
         insert(*input_begin, false, orient);
       }
     }
 
     inline void insert(const polygon_90_set_data& polygon_set) {
-      insert(polygon_set.begin(), polygon_set.end(), polygon_set.orient());
+      if(!polygon_set.compacted())
+        insert(polygon_set.begin(), polygon_set.end(), polygon_set.orient());
+      else if(&polygon_set != this)
+        insert(polygon_set.begin_compact(), polygon_set.end_compact(), polygon_set.orient());
     }
 
     inline void insert(const std::pair<std::pair<point_data<coordinate_type>, point_data<coordinate_type> >, int>& edge, bool is_hole = false,
@@ -140,11 +195,11 @@ namespace boost { namespace polygon{
 
     inline void insert(const std::pair<coordinate_type, std::pair<coordinate_type, int> >& vertex, bool is_hole = false,
                        orientation_2d orient = HORIZONTAL) {
+      expand();
+      mark_dirty_();
       data_.push_back(vertex);
       if(orient != orient_) std::swap(data_.back().first, data_.back().second.first);
       if(is_hole) data_.back().second.second *= -1;
-      dirty_ = true;
-      unsorted_ = true;
     }
 
     inline void insert(coordinate_type major_coordinate, const std::pair<interval_data<coordinate_type>, int>& edge) {
@@ -163,11 +218,52 @@ namespace boost { namespace polygon{
       get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type());
     }
 
+    //no polygon gets more than vthreshold vertices, the vertices of its holes included
     template <typename output_container>
     inline void get(output_container& output, size_t vthreshold) const {
       get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type(), vthreshold);
     }
 
+    //also fills stats with the counters of the formation scanline, to size vthreshold from real data
+    template <typename output_container>
+    inline void get(output_container& output, size_t vthreshold, polygon_formation::FormationStats& stats) const {
+      get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type(), vthreshold, &stats);
+    }
+
+    //polygons with holes written into one flat buffer
+    inline void get(polygon_buffer<coordinate_type>& output) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_polygons(output, compact_.begin(), compact_.end(), orient_, false, polygon_90_with_holes_concept());
+      else
+        ::boost::polygon::get_polygons(output, data_.begin(), data_.end(), orient_, false, polygon_90_with_holes_concept());
+    }
+
+    inline void get(polygon_buffer<coordinate_type>& output, size_t vthreshold) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_polygons(output, compact_.begin(), compact_.end(), orient_, false, polygon_90_with_holes_concept(), vthreshold);
+      else
+        ::boost::polygon::get_polygons(output, data_.begin(), data_.end(), orient_, false, polygon_90_with_holes_concept(), vthreshold);
+    }
+
+    inline void get(polygon_buffer<coordinate_type>& output, size_t vthreshold, polygon_formation::FormationStats& stats) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_polygons(output, compact_.begin(), compact_.end(), orient_, false, polygon_90_with_holes_concept(), vthreshold, &stats);
+      else
+        ::boost::polygon::get_polygons(output, data_.begin(), data_.end(), orient_, false, polygon_90_with_holes_concept(), vthreshold, &stats);
+    }
+
+
+    //forms the polygons on num_slabs slabs in parallel, see get_polygons_parallel; figures that
+    //cross a slab boundary are cut there unless stitch is set
+    template <typename output_container>
+    inline void get_parallel(output_container& output, std::size_t num_slabs, bool stitch = true,
+                             size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_parallel_dispatch(output, typename geometry_concept<typename output_container::value_type>::type(),
+                            num_slabs, stitch, vthreshold);
+    }
 
     template <typename output_container>
     inline void get_polygons(output_container& output) const {
@@ -177,7 +273,20 @@ namespace boost { namespace polygon{
     template <typename output_container>
     inline void get_rectangles(output_container& output) const {
       clean();
-      form_rectangles(output, data_.begin(), data_.end(), orient_, rectangle_concept());
+      if(compacted_)
+        form_rectangles(output, compact_.begin(), compact_.end(), orient_, rectangle_concept());
+      else
+        form_rectangles(output, data_.begin(), data_.end(), orient_, rectangle_concept());
+    }
+
+    //streams the rectangles get_rectangles gives to sink, see get_rectangles_to_sink
+    template <typename sink_type>
+    inline void get_rectangles_to_sink(sink_type& sink) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_rectangles_to_sink(sink, compact_.begin(), compact_.end(), orient_);
+      else
+        ::boost::polygon::get_rectangles_to_sink(sink, data_.begin(), data_.end(), orient_);
     }
 
     template <typename output_container>
@@ -201,6 +310,12 @@ namespace boost { namespace polygon{
       if(orient_ == p.orient()) {
         clean();
         p.clean();
+        if(compacted_ && p.compacted_)
+          return compact_ == p.compact_;
+        if(compacted_)
+          return compact_.size() == p.data_.size() && std::equal(p.data_.begin(), p.data_.end(), compact_.begin());
+        if(p.compacted_)
+          return p.compact_.size() == data_.size() && std::equal(data_.begin(), data_.end(), p.compact_.begin());
         return data_ == p.data_;
       } else {
         return false;
@@ -212,34 +327,38 @@ namespace boost { namespace polygon{
       return !((*this) == p);
     }
 
-    // get iterator to begin vertex data
+    // get iterator to begin vertex data, the set must not be compacted, see expand()
     inline iterator_type begin() const {
+      assert(!compacted_);
       return data_.begin();
     }
 
-    // get iterator to end vertex data
+    // get iterator to end vertex data, the set must not be compacted, see expand()
     inline iterator_type end() const {
+      assert(!compacted_);
       return data_.end();
     }
 
+    // get the vertex vector, the set must not be compacted, see expand()
     const value_type& value() const {
+      assert(!compacted_);
       return data_;
     }
 
     // clear the contents of the polygon_90_set_data
-    inline void clear() { data_.clear(); dirty_ = unsorted_ = false; }
+    inline void clear() { data_.clear(); compact_.clear(); dirty_ = unsorted_ = compacted_ = false; cleanSize_ = 0; }
 
     // find out if Polygon set is empty
-    inline bool empty() const { clean(); return data_.empty(); }
+    inline bool empty() const { clean(); return compacted_ ? compact_.empty() : data_.empty(); }
 
     // get the Polygon set size in vertices
-    inline std::size_t size() const { clean(); return data_.size(); }
+    inline std::size_t size() const { clean(); return compacted_ ? compact_.size() : data_.size(); }
 
     // get the current Polygon set capacity in vertices
-    inline std::size_t capacity() const { return data_.capacity(); }
+    inline std::size_t capacity() const { return compacted_ ? compact_.capacity() : data_.capacity(); }
 
     // reserve size of polygon set in vertices
-    inline void reserve(std::size_t size) { return data_.reserve(size); }
+    inline void reserve(std::size_t size) { expand(); return data_.reserve(size); }
 
     // find out if Polygon set is sorted
     inline bool sorted() const { return !unsorted_; }
@@ -250,6 +369,52 @@ namespace boost { namespace polygon{
     // get the scanline orientation of the polygon set
     inline orientation_2d orient() const { return orient_; }
 
+    // pack the vertex data, cleaned first, into a layout of 2*n*sizeof(Unit) bytes and a bit per
+    // vertex, see polygon_90_compact_data; returns false, leaving the set as it is, if the
+    // vertices do not all have a count of +1 or -1
+    // get, get_rectangles, move, extents, comparison and the boolean operators run on the packed
+    // vertices, anything that modifies the set unpacks them again first; begin(), end() and
+    // value() do not, a compacted set must be expanded before its vertex vector is read
+    inline bool compact() {
+      if(compacted_) return true;
+      clean();
+      if(!compact_.assign(data_.begin(), data_.end())) return false;
+      value_type().swap(data_);
+      compacted_ = true;
+      return true;
+    }
+
+    // unpack the vertex data packed by compact(), a no-op if it is not packed
+    inline void expand() {
+      if(compacted_) {
+        data_.assign(compact_.begin(), compact_.end());
+        compact_.clear();
+        compacted_ = false;
+      }
+    }
+
+    // true if the vertex data is packed
+    inline bool compacted() const { return compacted_; }
+
+    // get iterator to begin packed vertex data, the set must be compacted
+    inline compact_iterator_type begin_compact() const { return compact_.begin(); }
+
+    // get iterator to end packed vertex data, the set must be compacted
+    inline compact_iterator_type end_compact() const { return compact_.end(); }
+
+    // get iterator to begin vertex data, packed or not
+    inline vertex_iterator_type begin_vertices() const { return vertex_iterator_type(this, 0); }
+
+    // get iterator to end vertex data, packed or not
+    inline vertex_iterator_type end_vertices() const {
+      return vertex_iterator_type(this, compacted_ ? compact_.size() : data_.size());
+    }
+
+    // bytes used by the vertex data, packed or not
+    inline std::size_t memory() const {
+      return compacted_ ? compact_.memory() : data_.capacity() * sizeof(typename value_type::value_type);
+    }
+
     // Start BM
     // The problem: If we have two polygon sets with two different scanline orientations:
     // I tried changing the orientation of one to coincide with other (If not, resulting boolean operation
@@ -293,6 +458,10 @@ namespace boost { namespace polygon{
     // }
 
     void clean() const {
+      if(dirty_ && unsorted_ && cleanSize_ < data_.size() && cleanSize_ > data_.size() - cleanSize_) {
+        clean_tail_();
+        return;
+      }
       sort();
       if(dirty_) {
         boolean_op::default_arg_workaround<int>::applyBooleanOr(data_);
@@ -302,14 +471,21 @@ namespace boost { namespace polygon{
 
     void sort() const{
       if(unsorted_) {
-        polygon_sort(data_.begin(), data_.end());
+        if(cleanSize_ > 0) {
+          //the clean run is sorted already, only the vertices inserted after it are not
+          polygon_sort(data_.begin() + cleanSize_, data_.end());
+          std::inplace_merge(data_.begin(), data_.begin() + cleanSize_, data_.end());
+        } else {
+          polygon_sort(data_.begin(), data_.end());
+        }
         unsorted_ = false;
+        cleanSize_ = 0;
       }
     }
 
     template <typename input_iterator_type>
     void set(input_iterator_type input_begin, input_iterator_type input_end, orientation_2d orient) {
-      data_.clear();
+      clear();
       reserve(std::distance(input_begin, input_end));
       data_.insert(data_.end(), input_begin, input_end);
       orient_ = orient;
@@ -317,7 +493,18 @@ namespace boost { namespace polygon{
       unsorted_ = true;
     }
 
+    //sets the vertex data, which must be sorted and clean already, without sorting or cleaning it
+    template <typename input_iterator_type>
+    void set_clean(input_iterator_type input_begin, input_iterator_type input_end, orientation_2d orient) {
+      clear();
+      data_.assign(input_begin, input_end);
+      orient_ = orient;
+    }
+
     void set(const value_type& value, orientation_2d orient) {
+      compact_.clear();
+      compacted_ = false;
+      cleanSize_ = 0;
       data_ = value;
       orient_ = orient;
       dirty_ = true;
@@ -329,20 +516,9 @@ namespace boost { namespace polygon{
     bool
     extents(rectangle_type& extents_rectangle) const {
       clean();
-      if(data_.empty()) return false;
-      if(orient_ == HORIZONTAL)
-        set_points(extents_rectangle, point_data<coordinate_type>(data_[0].second.first, data_[0].first),
-                   point_data<coordinate_type>(data_[data_.size() - 1].second.first, data_[data_.size() - 1].first));
-      else
-        set_points(extents_rectangle, point_data<coordinate_type>(data_[0].first, data_[0].second.first),
-                   point_data<coordinate_type>(data_[data_.size() - 1].first, data_[data_.size() - 1].second.first));
-      for(std::size_t i = 1; i < data_.size() - 1; ++i) {
-        if(orient_ == HORIZONTAL)
-          encompass(extents_rectangle, point_data<coordinate_type>(data_[i].second.first, data_[i].first));
-        else
-          encompass(extents_rectangle, point_data<coordinate_type>(data_[i].first, data_[i].second.first));
-      }
-      return true;
+      if(compacted_)
+        return extents_(extents_rectangle, compact_.begin(), compact_.end());
+      return extents_(extents_rectangle, data_.begin(), data_.end());
     }
 
     polygon_90_set_data&
@@ -352,7 +528,7 @@ namespace boost { namespace polygon{
           typename coordinate_traits<coordinate_type>::unsigned_area_type north_bloating) {
       std::vector<rectangle_data<coordinate_type> > rects;
       clean();
-      rects.reserve(data_.size() / 2);
+      rects.reserve(size() / 2);
       get(rects);
       rectangle_data<coordinate_type> convolutionRectangle(interval_data<coordinate_type>(-((coordinate_type)west_bloating),
                                                                                           (coordinate_type)east_bloating),
@@ -491,63 +667,8 @@ namespace boost { namespace polygon{
            typename coordinate_traits<coordinate_type>::unsigned_area_type east_bloating,
            typename coordinate_traits<coordinate_type>::unsigned_area_type south_bloating,
            typename coordinate_traits<coordinate_type>::unsigned_area_type north_bloating) {
-      std::list<polygon_45_with_holes_data<coordinate_type> > polys;
-      get(polys);
-      clear();
-      for(typename std::list<polygon_45_with_holes_data<coordinate_type> >::iterator itr = polys.begin();
-          itr != polys.end(); ++itr) {
-        //polygon_90_set_data<coordinate_type> psref;
-        //psref.insert(view_as<polygon_90_concept>((*itr).self_));
-        //rectangle_data<coordinate_type> prerect;
-        //psref.extents(prerect);
-        resize_poly_up((*itr).self_.coords_, (coordinate_type)west_bloating, (coordinate_type)east_bloating,
-                       (coordinate_type)south_bloating, (coordinate_type)north_bloating);
-        iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-          begin_input(view_as<polygon_90_concept>((*itr).self_), LOW, orient_, false, true, COUNTERCLOCKWISE),
-          end_input(view_as<polygon_90_concept>((*itr).self_), HIGH, orient_, false, true, COUNTERCLOCKWISE);
-        insert(begin_input, end_input, orient_);
-        //polygon_90_set_data<coordinate_type> pstest;
-        //pstest.insert(view_as<polygon_90_concept>((*itr).self_));
-        //psref.bloat2(west_bloating, east_bloating, south_bloating, north_bloating);
-        //if(!equivalence(psref, pstest)) {
-        // std::cout << "test failed\n";
-        //}
-        for(typename std::list<polygon_45_data<coordinate_type> >::iterator itrh = (*itr).holes_.begin();
-            itrh != (*itr).holes_.end(); ++itrh) {
-          //rectangle_data<coordinate_type> rect;
-          //psref.extents(rect);
-          //polygon_90_set_data<coordinate_type> psrefhole;
-          //psrefhole.insert(prerect);
-          //psrefhole.insert(view_as<polygon_90_concept>(*itrh), true);
-          //polygon_45_data<coordinate_type> testpoly(*itrh);
-          if(resize_poly_down((*itrh).coords_,(coordinate_type)west_bloating, (coordinate_type)east_bloating,
-                              (coordinate_type)south_bloating, (coordinate_type)north_bloating)) {
-            iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-              begin_input2(view_as<polygon_90_concept>(*itrh), LOW, orient_, true, true),
-              end_input2(view_as<polygon_90_concept>(*itrh), HIGH, orient_, true, true);
-            insert(begin_input2, end_input2, orient_);
-            //polygon_90_set_data<coordinate_type> pstesthole;
-            //pstesthole.insert(rect);
-            //iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-            // begin_input2(view_as<polygon_90_concept>(*itrh), LOW, orient_, true, true);
-            //pstesthole.insert(begin_input2, end_input, orient_);
-            //psrefhole.bloat2(west_bloating, east_bloating, south_bloating, north_bloating);
-            //if(!equivalence(psrefhole, pstesthole)) {
-            // std::cout << (winding(testpoly) == CLOCKWISE) << std::endl;
-            // std::cout << (winding(*itrh) == CLOCKWISE) << std::endl;
-            // polygon_90_set_data<coordinate_type> c(psrefhole);
-            // c.clean();
-            // polygon_90_set_data<coordinate_type> a(pstesthole);
-            // polygon_90_set_data<coordinate_type> b(pstesthole);
-            // a.sort();
-            // b.clean();
-            // std::cout << "test hole failed\n";
-            // //std::cout << testpoly << std::endl;
-            //}
-          }
-        }
-      }
-      return *this;
+      return resize((coordinate_type)west_bloating, (coordinate_type)east_bloating,
+                    (coordinate_type)south_bloating, (coordinate_type)north_bloating);
     }
 
     polygon_90_set_data&
@@ -555,66 +676,8 @@ namespace boost { namespace polygon{
            typename coordinate_traits<coordinate_type>::unsigned_area_type east_shrinking,
            typename coordinate_traits<coordinate_type>::unsigned_area_type south_shrinking,
            typename coordinate_traits<coordinate_type>::unsigned_area_type north_shrinking) {
-      std::list<polygon_45_with_holes_data<coordinate_type> > polys;
-      get(polys);
-      clear();
-      for(typename std::list<polygon_45_with_holes_data<coordinate_type> >::iterator itr = polys.begin();
-          itr != polys.end(); ++itr) {
-        //polygon_90_set_data<coordinate_type> psref;
-        //psref.insert(view_as<polygon_90_concept>((*itr).self_));
-        //rectangle_data<coordinate_type> prerect;
-        //psref.extents(prerect);
-        //polygon_45_data<coordinate_type> testpoly((*itr).self_);
-        if(resize_poly_down((*itr).self_.coords_, -(coordinate_type)west_shrinking, -(coordinate_type)east_shrinking,
-                            -(coordinate_type)south_shrinking, -(coordinate_type)north_shrinking)) {
-          iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-            begin_input(view_as<polygon_90_concept>((*itr).self_), LOW, orient_, false, true, COUNTERCLOCKWISE),
-            end_input(view_as<polygon_90_concept>((*itr).self_), HIGH, orient_, false, true, COUNTERCLOCKWISE);
-          insert(begin_input, end_input, orient_);
-          //iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-          //  begin_input2(view_as<polygon_90_concept>((*itr).self_), LOW, orient_, false, true, COUNTERCLOCKWISE);
-          //polygon_90_set_data<coordinate_type> pstest;
-          //pstest.insert(begin_input2, end_input, orient_);
-          //psref.shrink2(west_shrinking, east_shrinking, south_shrinking, north_shrinking);
-          //if(!equivalence(psref, pstest)) {
-          //  std::cout << "test failed\n";
-          //}
-          for(typename std::list<polygon_45_data<coordinate_type> >::iterator itrh = (*itr).holes_.begin();
-              itrh != (*itr).holes_.end(); ++itrh) {
-            //rectangle_data<coordinate_type> rect;
-            //psref.extents(rect);
-            //polygon_90_set_data<coordinate_type> psrefhole;
-            //psrefhole.insert(prerect);
-            //psrefhole.insert(view_as<polygon_90_concept>(*itrh), true);
-            //polygon_45_data<coordinate_type> testpoly(*itrh);
-            resize_poly_up((*itrh).coords_, -(coordinate_type)west_shrinking, -(coordinate_type)east_shrinking,
-                            -(coordinate_type)south_shrinking, -(coordinate_type)north_shrinking);
-            iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-              begin_input2(view_as<polygon_90_concept>(*itrh), LOW, orient_, true, true),
-              end_input2(view_as<polygon_90_concept>(*itrh), HIGH, orient_, true, true);
-            insert(begin_input2, end_input2, orient_);
-            //polygon_90_set_data<coordinate_type> pstesthole;
-            //pstesthole.insert(rect);
-            //iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
-            //  begin_input2(view_as<polygon_90_concept>(*itrh), LOW, orient_, true, true);
-            //pstesthole.insert(begin_input2, end_input, orient_);
-            //psrefhole.shrink2(west_shrinking, east_shrinking, south_shrinking, north_shrinking);
-            //if(!equivalence(psrefhole, pstesthole)) {
-            //  std::cout << (winding(testpoly) == CLOCKWISE) << std::endl;
-            //  std::cout << (winding(*itrh) == CLOCKWISE) << std::endl;
-            //  polygon_90_set_data<coordinate_type> c(psrefhole);
-            //  c.clean();
-            //  polygon_90_set_data<coordinate_type> a(pstesthole);
-            //  polygon_90_set_data<coordinate_type> b(pstesthole);
-            //  a.sort();
-            //  b.clean();
-            //  std::cout << "test hole failed\n";
-            //  //std::cout << testpoly << std::endl;
-            //}
-          }
-        }
-      }
-      return *this;
+      return resize(-(coordinate_type)west_shrinking, -(coordinate_type)east_shrinking,
+                    -(coordinate_type)south_shrinking, -(coordinate_type)north_shrinking);
     }
 
     polygon_90_set_data&
@@ -677,6 +740,13 @@ namespace boost { namespace polygon{
     resize(coordinate_type west, coordinate_type east, coordinate_type south, coordinate_type north);
 
     polygon_90_set_data& move(coordinate_type x_delta, coordinate_type y_delta) {
+      if(compacted_) {
+        if(orient_ == orientation_2d(VERTICAL))
+          compact_.move(x_delta, y_delta);
+        else
+          compact_.move(y_delta, x_delta);
+        return *this;
+      }
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
         if(orient_ == orientation_2d(VERTICAL)) {
@@ -693,6 +763,7 @@ namespace boost { namespace polygon{
     // transform set
     template <typename transformation_type>
     polygon_90_set_data& transform(const transformation_type& transformation) {
+      expand();
       direction_2d dir1, dir2;
       transformation.get_directions(dir1, dir2);
       int sign = dir1.get_sign() * dir2.get_sign();
@@ -705,13 +776,16 @@ namespace boost { namespace polygon{
         }
         (*itr).second.second *= sign;
       }
-      if(dir1 != EAST || dir2 != NORTH)
+      if(dir1 != EAST || dir2 != NORTH) {
         unsorted_ = true; //some mirroring or rotation must have happened
+        cleanSize_ = 0;
+      }
       return *this;
     }
 
     // scale set
     polygon_90_set_data& scale_up(typename coordinate_traits<coordinate_type>::unsigned_area_type factor) {
+      expand();
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
         (*itr).first *= (coordinate_type)factor;
@@ -720,6 +794,7 @@ namespace boost { namespace polygon{
       return *this;
     }
     polygon_90_set_data& scale_down(typename coordinate_traits<coordinate_type>::unsigned_area_type factor) {
+      expand();
       typedef typename coordinate_traits<coordinate_type>::coordinate_distance dt;
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
@@ -727,10 +802,12 @@ namespace boost { namespace polygon{
         (*itr).second.first = scaling_policy<coordinate_type>::round((dt)((*itr).second.first) / (dt)factor);
       }
       unsorted_ = true; //scaling down can make coordinates equal that were not previously equal
+      cleanSize_ = 0;
       return *this;
     }
     template <typename scaling_type>
     polygon_90_set_data& scale(const anisotropic_scale_factor<scaling_type>& scaling) {
+      expand();
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
         if(orient_ == orientation_2d(VERTICAL)) {
@@ -740,10 +817,12 @@ namespace boost { namespace polygon{
         }
       }
       unsorted_ = true;
+      cleanSize_ = 0;
       return *this;
     }
     template <typename scaling_type>
     polygon_90_set_data& scale_with(const scaling_type& scaling) {
+      expand();
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
         if(orient_ == orientation_2d(VERTICAL)) {
@@ -753,9 +832,11 @@ namespace boost { namespace polygon{
         }
       }
       unsorted_ = true;
+      cleanSize_ = 0;
       return *this;
     }
     polygon_90_set_data& scale(double factor) {
+      expand();
       typedef typename coordinate_traits<coordinate_type>::coordinate_distance dt;
       for(typename std::vector<std::pair<coordinate_type, std::pair<coordinate_type, int> > >::iterator
             itr = data_.begin(); itr != data_.end(); ++itr) {
@@ -763,6 +844,7 @@ namespace boost { namespace polygon{
         (*itr).second.first = scaling_policy<coordinate_type>::round((dt)((*itr).second.first) * (dt)factor);
       }
       unsorted_ = true; //scaling make coordinates equal that were not previously equal
+      cleanSize_ = 0;
       return *this;
     }
 
@@ -790,7 +872,10 @@ namespace boost { namespace polygon{
       typedef coordinate_type Unit;
       if(that.dirty_) that.clean();
       typename touch_90_operation<Unit>::TouchSetData tsd;
-      touch_90_operation<Unit>::populateTouchSetData(tsd, that.data_, 0);
+      if(that.compacted_)
+        touch_90_operation<Unit>::populateTouchSetData(tsd, that.compact_.begin(), that.compact_.end(), 0);
+      else
+        touch_90_operation<Unit>::populateTouchSetData(tsd, that.data_, 0);
       std::vector<polygon_90_data<Unit> > polys;
       get(polys);
       std::vector<std::set<int> > graph(polys.size()+1, std::set<int>());
@@ -815,7 +900,58 @@ namespace boost { namespace polygon{
                               iterator_type_2 itr2, iterator_type_2 itr2_end,
                               T2 defaultCount) {
       data_.clear();
-      boolean_op::applyBooleanBinaryOp(data_, itr1, itr1_end, itr2, itr2_end, defaultCount);
+      compact_.clear();
+      compacted_ = false;
+      if(polygon_boolean_threads() != 1)
+        boolean_op::applyBooleanBinaryOpOnThreads(data_, itr1, itr1_end, itr2, itr2_end, defaultCount,
+                                                  polygon_boolean_threads());
+      else
+        boolean_op::applyBooleanBinaryOp(data_, itr1, itr1_end, itr2, itr2_end, defaultCount);
+    }
+
+    //Sets this to the regions where predicate holds on the counts of the sets of [first, last),
+    //which are polygon_90_set_data of this coordinate type, in a single sweep over all of them
+    //instead of a chain of binary booleans.  The predicate takes the std::vector<int> of the
+    //counts, one per set, and must be false when they are all zero; boolean_op::NaryAny,
+    //NaryAll and NaryAtLeast are the union, the intersection and the k times covered regions.
+    template <typename set_iterator_type, typename predicate_type>
+    polygon_90_set_data& applyBooleanNaryOp(set_iterator_type first, set_iterator_type last,
+                                            const predicate_type& predicate) {
+      std::size_t size = std::distance(first, last);
+      std::vector<value_type> copies(size); //the sets that are not read in place
+      std::vector<std::pair<iterator_type, iterator_type> > inputs;
+      inputs.reserve(size);
+      for(std::size_t i = 0; first != last; ++first, ++i) {
+        const polygon_90_set_data& input = *first;
+        if(input.orient() != orient_) {
+          polygon_90_set_data reoriented(orient_);
+          if(input.compacted())
+            reoriented.insert(input.begin_compact(), input.end_compact(), input.orient());
+          else
+            reoriented.insert(input.data_.begin(), input.data_.end(), input.orient());
+          reoriented.clean();
+          copies[i].swap(reoriented.data_);
+          inputs.push_back(std::make_pair(copies[i].begin(), copies[i].end()));
+        } else if(input.compacted()) {
+          copies[i].assign(input.begin_compact(), input.end_compact());
+          inputs.push_back(std::make_pair(copies[i].begin(), copies[i].end()));
+        } else {
+          input.clean();
+          inputs.push_back(std::make_pair(input.data_.begin(), input.data_.end()));
+        }
+      }
+      return applyBooleanNaryOp(inputs, predicate);
+    }
+
+    //the same on sorted vertex ranges, which may be the vertices of this set
+    template <typename predicate_type>
+    polygon_90_set_data& applyBooleanNaryOp(const std::vector<std::pair<iterator_type, iterator_type> >& inputs,
+                                            const predicate_type& predicate) {
+      value_type output;
+      boolean_op::applyBooleanNaryOp(output, inputs, predicate);
+      clear();
+      data_.swap(output);
+      return *this;
     }
 
   private:
@@ -823,13 +959,161 @@ namespace boost { namespace polygon{
     mutable value_type data_;
     mutable bool dirty_;
     mutable bool unsorted_;
+    mutable std::size_t cleanSize_; //while dirty, the length of the clean run the data was inserted after
+    polygon_90_compact_data<coordinate_type> compact_;
+    bool compacted_;
 
   private:
     //functions
+    void mark_dirty_() {
+      if(!dirty_ && !unsorted_)
+        cleanSize_ = data_.size();
+      dirty_ = true;
+      unsorted_ = true;
+    }
+
+    //clean() of a set that vertices were inserted into when it was clean: only the inserted tail
+    //is sorted, and the scanline is rerun over the stops from the first to the last of the tail,
+    //starting from the scan state the clean run has there.  Past the last stop of the tail the
+    //clean run is kept as it is, unless the tail leaves edges open to the right.
+    void clean_tail_() const {
+      typedef std::pair<coordinate_type, std::pair<coordinate_type, int> > vertex_type;
+      typedef typename value_type::iterator iterator;
+      iterator tail_begin = data_.begin() + cleanSize_;
+      polygon_sort(tail_begin, data_.end());
+      coordinate_type low = (*tail_begin).first;
+      coordinate_type high = data_.back().first;
+      std::map<coordinate_type, int> counts;
+      for(iterator itr = tail_begin; itr != data_.end(); ++itr)
+        counts[(*itr).second.first] += (*itr).second.second;
+      bool closed = true;
+      for(typename std::map<coordinate_type, int>::iterator itr = counts.begin(); itr != counts.end(); ++itr) {
+        if((*itr).second != 0) {
+          closed = false;
+          break;
+        }
+      }
+      iterator lo = std::lower_bound(data_.begin(), tail_begin,
+        vertex_type(low, std::pair<coordinate_type, int>((std::numeric_limits<coordinate_type>::min)(),
+                                                         (std::numeric_limits<int>::min)())));
+      iterator hi = tail_begin;
+      if(closed)
+        hi = std::upper_bound(lo, tail_begin,
+          vertex_type(high, std::pair<coordinate_type, int>((std::numeric_limits<coordinate_type>::max)(),
+                                                            (std::numeric_limits<int>::max)())));
+      //the clean run up to lo, summed per minor coordinate, is the scan state at its last stop; it
+      //goes into the scanline as vertices on that stop, whose output is dropped again
+      std::vector<std::pair<coordinate_type, int> > state;
+      state.reserve(lo - data_.begin());
+      for(iterator itr = data_.begin(); itr != lo; ++itr)
+        state.push_back((*itr).second);
+      polygon_sort(state.begin(), state.end());
+      value_type window;
+      window.reserve((hi - lo) + (data_.end() - tail_begin));
+      coordinate_type stop = lo == data_.begin() ? coordinate_type() : (*(lo - 1)).first;
+      for(std::size_t i = 0; i < state.size(); ) {
+        std::pair<coordinate_type, int> sum(state[i].first, 0);
+        for( ; i < state.size() && state[i].first == sum.first; ++i)
+          sum.second += state[i].second;
+        if(sum.second != 0)
+          window.push_back(vertex_type(stop, sum));
+      }
+      std::vector<std::pair<coordinate_type, int> >().swap(state);
+      std::merge(lo, hi, tail_begin, data_.end(), std::back_inserter(window));
+      boolean_op::default_arg_workaround<int>::applyBooleanOr(window);
+      typename value_type::iterator first = window.begin();
+      if(lo != data_.begin()) {
+        while(first != window.end() && (*first).first == stop)
+          ++first;
+      }
+      //put the output in place of [lo, hi) and drop the tail
+      std::size_t begin = lo - data_.begin();
+      std::size_t end = hi - data_.begin();
+      std::size_t size = window.end() - first;
+      data_.resize(cleanSize_);
+      if(size >= end - begin) {
+        std::copy(first, first + (end - begin), data_.begin() + begin);
+        data_.insert(data_.begin() + end, first + (end - begin), window.end());
+      } else {
+        std::copy(first, window.end(), data_.begin() + begin);
+        data_.erase(data_.begin() + begin + size, data_.begin() + end);
+      }
+      dirty_ = false;
+      unsorted_ = false;
+      cleanSize_ = 0;
+    }
+
+    //Appends to output the vertices of input, sorted on their major coordinate, with the edges
+    //they give moved along the major coordinate: the low edges, where the count rises toward higher
+    //major coordinates, by low_delta and the high edges by high_delta.  A vertex of a column where
+    //a low edge turns into a high edge is split in two.
+    static void resize_edges_(value_type& output, const value_type& input,
+                              coordinate_type low_delta, coordinate_type high_delta, bool transpose) {
+      int count = 0; //the change of the count across the column, positive on low edges and negative on high ones
+      for(typename value_type::const_iterator itr = input.begin(); itr != input.end(); ++itr) {
+        int before = count;
+        count += (*itr).second.second;
+        int low_change = (count > 0 ? count : 0) - (before > 0 ? before : 0);
+        int high_change = (count < 0 ? count : 0) - (before < 0 ? before : 0);
+        if(low_change != 0)
+          output.push_back(resized_vertex_((*itr).first + low_delta, (*itr).second.first, low_change, transpose));
+        if(high_change != 0)
+          output.push_back(resized_vertex_((*itr).first + high_delta, (*itr).second.first, high_change, transpose));
+      }
+    }
+
+    template <typename rectangle_type, typename iT>
+    bool extents_(rectangle_type& extents_rectangle, iT itr, iT itr_end) const {
+      if(itr == itr_end) return false;
+      for(bool first = true; itr != itr_end; ++itr, first = false) {
+        point_data<coordinate_type> pt((*itr).first, (*itr).second.first);
+        if(orient_ == HORIZONTAL) pt = point_data<coordinate_type>(pt.y(), pt.x());
+        if(first) set_points(extents_rectangle, pt, pt);
+        else encompass(extents_rectangle, pt);
+      }
+      return true;
+    }
+
+    static inline std::pair<coordinate_type, std::pair<coordinate_type, int> >
+    resized_vertex_(coordinate_type major, coordinate_type minor, int count, bool transpose) {
+      if(transpose)
+        return std::make_pair(minor, std::make_pair(major, count));
+      return std::make_pair(major, std::make_pair(minor, count));
+    }
+
+    //Shrinks the set a polygon at a time: the outer rings are moved in by the deltas and the holes
+    //out.  The moved vertices stay between the vertices of the set, so this is what resize falls
+    //back on when the box of its complement would not fit in coordinate_type.
+    void shrink_polygons_(coordinate_type west, coordinate_type east, coordinate_type south, coordinate_type north) {
+      std::list<polygon_45_with_holes_data<coordinate_type> > polys;
+      get(polys);
+      clear();
+      for(typename std::list<polygon_45_with_holes_data<coordinate_type> >::iterator itr = polys.begin();
+          itr != polys.end(); ++itr) {
+        if(!resize_poly_down((*itr).self_.coords_, west, east, south, north))
+          continue;
+        iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
+          begin_input(view_as<polygon_90_concept>((*itr).self_), LOW, orient_, false, true, COUNTERCLOCKWISE),
+          end_input(view_as<polygon_90_concept>((*itr).self_), HIGH, orient_, false, true, COUNTERCLOCKWISE);
+        insert(begin_input, end_input, orient_);
+        for(typename std::list<polygon_45_data<coordinate_type> >::iterator itrh = (*itr).holes_.begin();
+            itrh != (*itr).holes_.end(); ++itrh) {
+          resize_poly_up((*itrh).coords_, west, east, south, north);
+          iterator_geometry_to_set<polygon_90_concept, view_of<polygon_90_concept, polygon_45_data<coordinate_type> > >
+            begin_input2(view_as<polygon_90_concept>(*itrh), LOW, orient_, true, true),
+            end_input2(view_as<polygon_90_concept>(*itrh), HIGH, orient_, true, true);
+          insert(begin_input2, end_input2, orient_);
+        }
+      }
+    }
+
     template <typename output_container>
     void get_dispatch(output_container& output, rectangle_concept ) const {
       clean();
-      form_rectangles(output, data_.begin(), data_.end(), orient_, rectangle_concept());
+      if(compacted_)
+        form_rectangles(output, compact_.begin(), compact_.end(), orient_, rectangle_concept());
+      else
+        form_rectangles(output, data_.begin(), data_.end(), orient_, rectangle_concept());
     }
     template <typename output_container>
     void get_dispatch(output_container& output, polygon_90_concept tag) const {
@@ -838,8 +1122,32 @@ namespace boost { namespace polygon{
 
     template <typename output_container>
     void get_dispatch(output_container& output, polygon_90_concept tag, 
-      size_t vthreshold) const {
-      get_fracture(output, true, tag, vthreshold);
+      size_t vthreshold, polygon_formation::FormationStats* stats = 0) const {
+      get_fracture(output, true, tag, vthreshold, stats);
+    }
+
+    template <typename output_container>
+    void get_parallel_dispatch(output_container& output, polygon_90_concept tag,
+      std::size_t num_slabs, bool stitch, size_t vthreshold) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_polygons_parallel(output, compact_.begin(), compact_.end(), orient_, true, tag,
+                                                num_slabs, stitch, vthreshold);
+      else
+        ::boost::polygon::get_polygons_parallel(output, data_.begin(), data_.end(), orient_, true, tag,
+                                                num_slabs, stitch, vthreshold);
+    }
+
+    template <typename output_container>
+    void get_parallel_dispatch(output_container& output, polygon_90_with_holes_concept tag,
+      std::size_t num_slabs, bool stitch, size_t vthreshold) const {
+      clean();
+      if(compacted_)
+        ::boost::polygon::get_polygons_parallel(output, compact_.begin(), compact_.end(), orient_, false, tag,
+                                                num_slabs, stitch, vthreshold);
+      else
+        ::boost::polygon::get_polygons_parallel(output, data_.begin(), data_.end(), orient_, false, tag,
+                                                num_slabs, stitch, vthreshold);
     }
 
     template <typename output_container>
@@ -849,8 +1157,8 @@ namespace boost { namespace polygon{
 
     template <typename output_container>
     void get_dispatch(output_container& output, polygon_90_with_holes_concept tag,
-      size_t vthreshold) const {
-      get_fracture(output, false, tag, vthreshold);
+      size_t vthreshold, polygon_formation::FormationStats* stats = 0) const {
+      get_fracture(output, false, tag, vthreshold, stats);
     }
 
 
@@ -873,47 +1181,157 @@ namespace boost { namespace polygon{
     template <typename output_container, typename concept_type>
     void get_fracture(output_container& container, bool fracture_holes, concept_type tag) const {
       clean();
-      ::boost::polygon::get_polygons(container, data_.begin(), data_.end(), orient_, fracture_holes, tag);
+      if(compacted_)
+        ::boost::polygon::get_polygons(container, compact_.begin(), compact_.end(), orient_, fracture_holes, tag);
+      else
+        ::boost::polygon::get_polygons(container, data_.begin(), data_.end(), orient_, fracture_holes, tag);
     }
 
     template <typename output_container, typename concept_type>
     void get_fracture(output_container& container, bool fracture_holes, concept_type tag,
-      size_t vthreshold) const {
+      size_t vthreshold, polygon_formation::FormationStats* stats = 0) const {
       clean();
-      ::boost::polygon::get_polygons(container, data_.begin(), data_.end(), orient_, fracture_holes, tag, vthreshold);
+      if(compacted_)
+        ::boost::polygon::get_polygons(container, compact_.begin(), compact_.end(), orient_, fracture_holes, tag, vthreshold, stats);
+      else
+        ::boost::polygon::get_polygons(container, data_.begin(), data_.end(), orient_, fracture_holes, tag, vthreshold, stats);
     }
   };
 
+  //Resizing is separable, the set is resized along one axis and then along the other.  Along an
+  //axis the clean vertices of a column give the edges of the set crossing it, which resize_edges_
+  //moves without forming polygons.  Where bloated edges overlap the counts add up, so the moved
+  //vertices of a bloat go on to the other axis as they are and a single OR cleans them at the end.
+  //A shrink bloats the complement of the set within a box about it instead and takes the result
+  //out of the box, and when the axes are sized with different signs the shrinking comes first.
   template <typename coordinate_type>
   polygon_90_set_data<coordinate_type>&
   polygon_90_set_data<coordinate_type>::resize(coordinate_type west,
                                                coordinate_type east,
                                                coordinate_type south,
                                                coordinate_type north) {
-    move(-west, -south);
     coordinate_type e_total = west + east;
     coordinate_type n_total = south + north;
-    if((e_total < 0) ^ (n_total < 0)) {
-      //different signs
-      if(e_total < 0) {
-        shrink(0, -e_total, 0, 0);
-        if(n_total != 0)
-          return bloat(0, 0, 0, n_total);
-        else
-          return (*this);
-      } else {
-        shrink(0, 0, 0, -n_total); //shrink first
-        if(e_total != 0)
-          return bloat(0, e_total, 0, 0);
-        else
-          return (*this);
+    //an axis sized by zero in all is only moved
+    move(e_total == 0 ? -west : 0, n_total == 0 ? -south : 0);
+    if(e_total == 0 && n_total == 0)
+      return *this;
+    clean();
+    expand();
+    if(data_.empty())
+      return *this;
+    bool shrinking = e_total <= 0 && n_total <= 0;
+    bool mixed = (e_total < 0 && n_total > 0) || (e_total > 0 && n_total < 0);
+    //the axes to size, the orientation of a step is the one whose columns cross the edges it moves
+    orientation_2d step_orient[2];
+    coordinate_type low_delta[2], high_delta[2];
+    int steps = 0;
+    bool x_first = mixed ? e_total < 0 : orient_ == VERTICAL;
+    if(n_total != 0 && !x_first) {
+      step_orient[steps] = HORIZONTAL;
+      low_delta[steps] = -south;
+      high_delta[steps++] = north;
+    }
+    if(e_total != 0) {
+      step_orient[steps] = VERTICAL;
+      low_delta[steps] = -west;
+      high_delta[steps++] = east;
+    }
+    if(n_total != 0 && x_first) {
+      step_orient[steps] = HORIZONTAL;
+      low_delta[steps] = -south;
+      high_delta[steps++] = north;
+    }
+    value_type input, output, box;
+    coordinate_type minor_low = data_.front().second.first;
+    coordinate_type minor_high = minor_low;
+    if(shrinking) {
+      for(typename value_type::iterator itr = data_.begin(); itr != data_.end(); ++itr) {
+        minor_low = (std::min)(minor_low, (*itr).second.first);
+        minor_high = (std::max)(minor_high, (*itr).second.first);
       }
-    } else {
-      if(e_total < 0) {
-        return shrink(0, -e_total, 0, -n_total);
+      //the box is margin outside the set and its complement is bloated by up to margin again, near
+      //the limits of coordinate_type the set is moved away from them for the shrink, and a set too
+      //wide for that is shrunk a polygon at a time
+      typedef typename coordinate_traits<coordinate_type>::manhattan_area_type wide_type;
+      wide_type margin = (wide_type)1 - (west < 0 ? (wide_type)west : -(wide_type)west) -
+        (east < 0 ? (wide_type)east : -(wide_type)east) - (south < 0 ? (wide_type)south : -(wide_type)south) -
+        (north < 0 ? (wide_type)north : -(wide_type)north);
+      wide_type lowest = (wide_type)(std::numeric_limits<coordinate_type>::min)() + 2 * margin;
+      wide_type highest = (wide_type)(std::numeric_limits<coordinate_type>::max)() - 2 * margin;
+      wide_type low[2] = { (wide_type)data_.front().first, (wide_type)minor_low };
+      wide_type high[2] = { (wide_type)data_.back().first, (wide_type)minor_high };
+      coordinate_type shift[2] = { 0, 0 };
+      for(int axis = 0; axis < 2; ++axis) {
+        if(low[axis] >= lowest && high[axis] <= highest)
+          continue;
+        if(high[axis] - low[axis] > highest - lowest) {
+          shrink_polygons_(e_total == 0 ? 0 : west, e_total == 0 ? 0 : east,
+                           n_total == 0 ? 0 : south, n_total == 0 ? 0 : north);
+          return *this;
+        }
+        shift[axis] = (coordinate_type)(low[axis] < lowest ? lowest - low[axis] : highest - high[axis]);
+      }
+      if(shift[0] != 0 || shift[1] != 0) {
+        coordinate_type x_shift = orient_ == orientation_2d(VERTICAL) ? shift[0] : shift[1];
+        coordinate_type y_shift = orient_ == orientation_2d(VERTICAL) ? shift[1] : shift[0];
+        move(x_shift, y_shift);
+        resize(e_total == 0 ? 0 : west, e_total == 0 ? 0 : east, n_total == 0 ? 0 : south, n_total == 0 ? 0 : north);
+        return move(-x_shift, -y_shift);
       }
-      return bloat(0, e_total, 0, n_total);
     }
+    input.swap(data_);
+    if(shrinking) {
+      coordinate_type margin = std::abs(west) + std::abs(east) + std::abs(south) + std::abs(north) + 1;
+      for(typename value_type::iterator itr = input.begin(); itr != input.end(); ++itr)
+        (*itr).second.second *= -1;
+      //the complement is the box less the set, the result is the bloated box less the bloated complement
+      coordinate_type low[2] = { input.front().first - margin, minor_low - margin };
+      coordinate_type high[2] = { input.back().first + margin, minor_high + margin };
+      input.insert(input.begin(), 2, input.front());
+      input[0] = std::make_pair(low[0], std::make_pair(low[1], 1));
+      input[1] = std::make_pair(low[0], std::make_pair(high[1], -1));
+      input.push_back(std::make_pair(high[0], std::make_pair(low[1], -1)));
+      input.push_back(std::make_pair(high[0], std::make_pair(high[1], 1)));
+      //the low and high edges of the complement are the high and low edges of the set
+      for(int step = 0; step < steps; ++step) {
+        std::swap(low_delta[step], high_delta[step]);
+        int axis = step_orient[step] == orient_ ? 0 : 1;
+        low[axis] += low_delta[step];
+        high[axis] += high_delta[step];
+      }
+      box.push_back(std::make_pair(low[0], std::make_pair(low[1], 1)));
+      box.push_back(std::make_pair(low[0], std::make_pair(high[1], -1)));
+      box.push_back(std::make_pair(high[0], std::make_pair(low[1], -1)));
+      box.push_back(std::make_pair(high[0], std::make_pair(high[1], 1)));
+    }
+    if(step_orient[0] != orient_) {
+      for(typename value_type::iterator itr = input.begin(); itr != input.end(); ++itr)
+        std::swap((*itr).first, (*itr).second.first);
+      polygon_sort(input.begin(), input.end());
+    }
+    for(int step = 0; step < steps; ++step) {
+      orientation_2d output_orient = step + 1 < steps ? step_orient[step + 1] : orient_;
+      output.clear();
+      output.reserve(input.size() + input.size() / 4);
+      resize_edges_(output, input, low_delta[step], high_delta[step], output_orient != step_orient[step]);
+      if(step + 1 < steps || shrinking)
+        polygon_sort(output.begin(), output.end());
+      if(step + 1 < steps) {
+        if(mixed)
+          boolean_op::default_arg_workaround<int>::applyBooleanOr(output);
+        input.swap(output);
+      }
+    }
+    clear();
+    if(shrinking) {
+      boolean_op::applyBooleanBinaryOp(data_, box.begin(), box.end(), output.begin(), output.end(),
+                                       boolean_op::BinaryCount<boolean_op::BinaryNot>());
+    } else {
+      data_.swap(output);
+      dirty_ = unsorted_ = true;
+    }
+    return *this;
   }
 
   template <typename coordinate_type, typename property_type>
@@ -925,8 +1343,12 @@ namespace boost { namespace polygon{
     inline property_merge_90(const property_merge_90& that) : pmd_(that.pmd_) {}
     inline property_merge_90& operator=(const property_merge_90& that) { pmd_ = that.pmd_; return *this; }
     inline void insert(const polygon_90_set_data<coordinate_type>& ps, const property_type& property) {
-      merge_scanline<coordinate_type, property_type, polygon_90_set_data<coordinate_type> >::
-        populate_property_merge_data(pmd_, ps.begin(), ps.end(), property, ps.orient());
+      if(ps.compacted())
+        merge_scanline<coordinate_type, property_type, polygon_90_set_data<coordinate_type> >::
+          populate_property_merge_data(pmd_, ps.begin_compact(), ps.end_compact(), property, ps.orient());
+      else
+        merge_scanline<coordinate_type, property_type, polygon_90_set_data<coordinate_type> >::
+          populate_property_merge_data(pmd_, ps.begin(), ps.end(), property, ps.orient());
     }
     template <class GeoObjT>
     inline void insert(const GeoObjT& geoObj, const property_type& property) {
@@ -937,7 +1359,9 @@ namespace boost { namespace polygon{
     //merge properties of input geometries and store the resulting geometries of regions
     //with unique sets of merged properties to polygons sets in a map keyed by sets of properties
     // T = std::map<std::set<property_type>, polygon_90_set_data<coordiante_type> > or
-    // T = std::map<std::vector<property_type>, polygon_90_set_data<coordiante_type> >
+    // T = std::map<std::vector<property_type>, polygon_90_set_data<coordiante_type> > or
+    // T = std::map<polygon_ulong_long_type, polygon_90_set_data<coordiante_type> > keyed by masks of
+    //     properties 0 to 63, geometry of other properties is left out
     template <typename ResultType>
     inline void merge(ResultType& result) {
       merge_scanline<coordinate_type, property_type, polygon_90_set_data<coordinate_type>, typename ResultType::key_type> ms;
@@ -966,7 +1390,10 @@ namespace boost { namespace polygon{
     //insert a polygon set graph node, the value returned is the id of the graph node
     inline unsigned int insert(const polygon_90_set_data<coordinate_type>& ps) {
       ps.clean();
-      touch_90_operation<coordinate_type>::populateTouchSetData(tsd_, ps.begin(), ps.end(), nodeCount_);
+      if(ps.compacted())
+        touch_90_operation<coordinate_type>::populateTouchSetData(tsd_, ps.begin_compact(), ps.end_compact(), nodeCount_);
+      else
+        touch_90_operation<coordinate_type>::populateTouchSetData(tsd_, ps.begin(), ps.end(), nodeCount_);
       return nodeCount_++;
     }
     template <class GeoObjT>
@@ -983,6 +1410,29 @@ namespace boost { namespace polygon{
     inline void extract(GraphT& graph) {
       touch_90_operation<coordinate_type>::performTouch(graph, tsd_);
     }
+
+    //extract connectivity as connected components instead of edges, labels is resized to the
+    //number of graph nodes and the label of a graph node is the least id in its component,
+    //the value returned is the number of components
+    inline unsigned int extract_components(std::vector<unsigned int>& labels) {
+      typename touch_90_operation<coordinate_type>::TouchComponents components(nodeCount_);
+      touch_90_operation<coordinate_type>::performTouch(components, tsd_);
+      labels.resize(nodeCount_);
+      unsigned int componentCount = 0;
+      for(unsigned int i = 0; i < nodeCount_; ++i) {
+        labels[i] = components.find(i);
+        if(labels[i] == i) ++componentCount;
+      }
+      return componentCount;
+    }
+
+    //extract connectivity and give the edges to sink as sink(id, id), an edge may be given
+    //more than once and with its graph node ids in either order
+    template <class SinkT>
+    inline void extract_edges(SinkT& sink) {
+      typename touch_90_operation<coordinate_type>::template TouchEdgeSink<SinkT> edges(sink);
+      touch_90_operation<coordinate_type>::performTouch(edges, tsd_);
+    }
   };
 }
 }
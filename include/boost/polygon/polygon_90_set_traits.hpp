@@ -317,15 +317,16 @@ namespace boost { namespace polygon{
   template <typename T>
   struct polygon_90_set_traits<polygon_90_set_data<T> > {
     typedef typename polygon_90_set_data<T>::coordinate_type coordinate_type;
-    typedef typename polygon_90_set_data<T>::iterator_type iterator_type;
+    //a compacted set has no vertex vector to iterate, its vertices are read in either layout
+    typedef typename polygon_90_set_data<T>::vertex_iterator_type iterator_type;
     typedef typename polygon_90_set_data<T>::operator_arg_type operator_arg_type;
 
     static inline iterator_type begin(const polygon_90_set_data<T>& polygon_set) {
-      return polygon_set.begin();
+      return polygon_set.begin_vertices();
     }
 
     static inline iterator_type end(const polygon_90_set_data<T>& polygon_set) {
-      return polygon_set.end();
+      return polygon_set.end_vertices();
     }
 
     static inline orientation_2d orient(const polygon_90_set_data<T>& polygon_set) { return polygon_set.orient(); }
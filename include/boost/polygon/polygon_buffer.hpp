@@ -0,0 +1,171 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_BUFFER_HPP
+#define BOOST_POLYGON_POLYGON_BUFFER_HPP
+#include <cstddef>
+#include <vector>
+#include "isotropy.hpp"
+#include "point_data.hpp"
+#include "detail/iterator_compact_to_points.hpp"
+namespace boost { namespace polygon{
+struct polygon_90_concept;
+struct polygon_90_with_holes_concept;
+
+// one ring of a polygon_buffer, the shell or a hole of a polygon
+template <typename T>
+class polygon_buffer_ring {
+public:
+  typedef polygon_90_concept geometry_type;
+  typedef T coordinate_type;
+  typedef const T* compact_iterator_type;
+  typedef iterator_compact_to_points<compact_iterator_type, point_data<T> > iterator_type;
+  typedef typename coordinate_traits<T>::area_type area_type;
+
+  inline polygon_buffer_ring() : begin_(0), end_(0) {}
+  inline polygon_buffer_ring(compact_iterator_type begin, compact_iterator_type end) : begin_(begin), end_(end) {}
+
+  inline compact_iterator_type begin_compact() const { return begin_; }
+  inline compact_iterator_type end_compact() const { return end_; }
+  inline iterator_type begin() const { return iterator_type(begin_, end_); }
+  inline iterator_type end() const { return iterator_type(end_, end_); }
+  inline std::size_t size() const { return end_ - begin_; }
+
+private:
+  compact_iterator_type begin_;
+  compact_iterator_type end_;
+};
+
+// one polygon of a polygon_buffer, only valid while the buffer is not modified
+template <typename T>
+class polygon_buffer_polygon {
+public:
+  typedef polygon_90_with_holes_concept geometry_type;
+  typedef T coordinate_type;
+  typedef polygon_buffer_ring<T> hole_type;
+  typedef typename hole_type::compact_iterator_type compact_iterator_type;
+  typedef typename hole_type::iterator_type iterator_type;
+  typedef typename coordinate_traits<T>::area_type area_type;
+  typedef point_data<T> point_type;
+
+  class iterator_holes_type {
+  public:
+    inline iterator_holes_type() : coordinates_(0), rings_(0) {}
+    inline iterator_holes_type(const T* coordinates, const std::size_t* rings) :
+      coordinates_(coordinates), rings_(rings) {}
+    inline iterator_holes_type& operator++() { ++rings_; return *this; }
+    inline const iterator_holes_type operator++(int) {
+      iterator_holes_type tmp(*this);
+      ++(*this);
+      return tmp;
+    }
+    inline bool operator==(const iterator_holes_type& that) const { return rings_ == that.rings_; }
+    inline bool operator!=(const iterator_holes_type& that) const { return rings_ != that.rings_; }
+    inline hole_type operator*() const { return hole_type(coordinates_ + rings_[0], coordinates_ + rings_[1]); }
+  private:
+    const T* coordinates_;
+    const std::size_t* rings_;
+  };
+
+  inline polygon_buffer_polygon() : coordinates_(0), rings_(0), size_rings_(0) {}
+  inline polygon_buffer_polygon(const T* coordinates, const std::size_t* rings, std::size_t size_rings) :
+    coordinates_(coordinates), rings_(rings), size_rings_(size_rings) {}
+
+  inline compact_iterator_type begin_compact() const { return coordinates_ + rings_[0]; }
+  inline compact_iterator_type end_compact() const { return coordinates_ + rings_[1]; }
+  inline iterator_type begin() const { return iterator_type(begin_compact(), end_compact()); }
+  inline iterator_type end() const { return iterator_type(end_compact(), end_compact()); }
+  inline std::size_t size() const { return rings_[1] - rings_[0]; }
+
+  inline iterator_holes_type begin_holes() const { return iterator_holes_type(coordinates_, rings_ + 1); }
+  inline iterator_holes_type end_holes() const { return iterator_holes_type(coordinates_, rings_ + size_rings_); }
+  inline std::size_t size_holes() const { return size_rings_ - 1; }
+
+private:
+  const T* coordinates_;
+  const std::size_t* rings_;
+  std::size_t size_rings_;
+};
+
+// polygon_buffer keeps many Manhattan polygons with holes in three flat arrays rather than one
+// object per polygon: the compact coordinates of all rings back to back, the offset of each ring
+// in the coordinates and the offset of each polygon in the rings.  The first ring of a polygon is
+// its shell, the others are its holes.  polygon_90_set_data::get writes into it without a heap
+// allocation per polygon, and the arrays can be written to a file and mapped back as they are.
+template <typename T>
+class polygon_buffer {
+public:
+  typedef T coordinate_type;
+  typedef polygon_buffer_polygon<T> polygon_type;
+  typedef polygon_buffer_ring<T> ring_type;
+
+  inline polygon_buffer() : coordinates_(), rings_(1, 0), polygons_(1, 0) {}
+
+  // number of polygons
+  inline std::size_t size() const { return polygons_.size() - 1; }
+  inline bool empty() const { return size() == 0; }
+  // number of rings, shells and holes
+  inline std::size_t size_rings() const { return rings_.size() - 1; }
+
+  inline polygon_type operator[](std::size_t i) const {
+    return polygon_type(data(), &rings_[polygons_[i]], polygons_[i + 1] - polygons_[i]);
+  }
+  inline ring_type ring(std::size_t i) const {
+    return ring_type(data() + rings_[i], data() + rings_[i + 1]);
+  }
+
+  // the raw arrays: ring i is coordinates()[ring_offsets()[i], ring_offsets()[i + 1]), polygon i has
+  // the rings [polygon_offsets()[i], polygon_offsets()[i + 1])
+  inline const std::vector<coordinate_type>& coordinates() const { return coordinates_; }
+  inline const std::vector<std::size_t>& ring_offsets() const { return rings_; }
+  inline const std::vector<std::size_t>& polygon_offsets() const { return polygons_; }
+
+  inline void clear() {
+    coordinates_.clear();
+    rings_.resize(1);
+    polygons_.resize(1);
+  }
+
+  inline void reserve(std::size_t num_polygons, std::size_t num_coordinates) {
+    coordinates_.reserve(num_coordinates);
+    rings_.reserve(num_polygons + 1);
+    polygons_.reserve(num_polygons + 1);
+  }
+
+  // to append a polygon write the compact coordinates of its shell to coordinates() and
+  // close_ring(), then the same for each hole, then close_polygon()
+  inline std::vector<coordinate_type>& coordinates() { return coordinates_; }
+  inline void close_ring() { rings_.push_back(coordinates_.size()); }
+  inline void close_polygon() { polygons_.push_back(rings_.size() - 1); }
+
+  template <typename iT>
+  inline void push_ring(iT begin_compact, iT end_compact) {
+    coordinates_.insert(coordinates_.end(), begin_compact, end_compact);
+    close_ring();
+  }
+
+private:
+  inline const coordinate_type* data() const { return coordinates_.empty() ? 0 : &coordinates_[0]; }
+
+  std::vector<coordinate_type> coordinates_;
+  std::vector<std::size_t> rings_;
+  std::vector<std::size_t> polygons_;
+};
+
+template <typename T>
+struct geometry_concept<polygon_buffer_ring<T> > {
+  typedef polygon_90_concept type;
+};
+
+template <typename T>
+struct geometry_concept<polygon_buffer_polygon<T> > {
+  typedef polygon_90_with_holes_concept type;
+};
+
+}
+}
+#endif
@@ -236,6 +236,14 @@ namespace boost { namespace polygon {
       get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type());
     }
 
+    //figures are cut along a segment across the figure once they reach vthreshold vertices, the
+    //vertices of their holes included; a cut waits for a scan stop where one of the edges it
+    //connects ends, so vthreshold bounds the polygons loosely
+    template <typename output_container>
+    inline void get(output_container& output, size_t vthreshold) const {
+      get_dispatch(output, typename geometry_concept<typename output_container::value_type>::type(), vthreshold);
+    }
+
     // append to the container cT with polygons of three or four verticies
     // slicing orientation is vertical
     template <class cT>
@@ -337,6 +345,17 @@ namespace boost { namespace polygon {
       unsorted_ = true;
     }
 
+    //sets the half edges of a range, which must be sorted and clean already, without sorting or
+    //cleaning them
+    template <typename input_iterator_type>
+    void set_clean(input_iterator_type input_begin, input_iterator_type input_end) {
+      clear();
+      is_45_ = true;
+      reserve(std::distance(input_begin, input_end));
+      for( ; input_begin != input_end; ++input_begin)
+        insert_clean(*input_begin);
+    }
+
     template <typename rectangle_type>
     bool extents(rectangle_type& rect) {
       clean();
@@ -780,17 +799,19 @@ namespace boost { namespace polygon {
     //functions
 
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_concept tag) const {
-      get_fracture(output, true, tag);
+    void get_dispatch(output_container& output, polygon_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, true, tag, vthreshold);
     }
     template <typename output_container>
-    void get_dispatch(output_container& output, polygon_with_holes_concept tag) const {
-      get_fracture(output, false, tag);
+    void get_dispatch(output_container& output, polygon_with_holes_concept tag,
+                      size_t vthreshold = (std::numeric_limits<size_t>::max)()) const {
+      get_fracture(output, false, tag, vthreshold);
     }
     template <typename output_container, typename concept_type>
-    void get_fracture(output_container& container, bool fracture_holes, concept_type ) const {
+    void get_fracture(output_container& container, bool fracture_holes, concept_type, size_t vthreshold) const {
       clean();
-      polygon_arbitrary_formation<coordinate_type> pf(fracture_holes);
+      polygon_arbitrary_formation<coordinate_type> pf(fracture_holes, vthreshold);
       typedef typename polygon_arbitrary_formation<coordinate_type>::vertex_half_edge vertex_half_edge;
       std::vector<vertex_half_edge> data;
       for(iterator_type itr = data_.begin(); itr != data_.end(); ++itr){
@@ -0,0 +1,446 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_SET_SERIALIZATION_HPP
+#define BOOST_POLYGON_POLYGON_SET_SERIALIZATION_HPP
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include "polygon.hpp"
+
+namespace boost { namespace polygon{
+
+  /*
+   * Binary format of polygon_90_set_data, polygon_45_set_data and polygon_set_data.
+   *
+   * A file is the header, the chunk index, the elements of the set (the vertices or half edges of
+   * its value()) and, for polygon_90_set_data, the coverage profiles of the chunks, each section
+   * starting at a multiple of 64 bytes.  Elements are stored as they are in memory, so a file that
+   * is memory mapped, or read into a buffer, is used in place through polygon_set_image without
+   * being parsed, sorted or cleaned again.  The byte order and sizes of the writer are recorded
+   * and a reader with others rejects the file.
+   *
+   * Sorted sets are cut into chunks of about chunk_size elements at changes of the major
+   * coordinate, the one they are sorted on first.  The index holds the first coordinate and element of each chunk, so that the
+   * elements of a range of coordinates are found without reading the others.  For
+   * polygon_90_set_data it also holds the profile of the scanline entering each chunk, the
+   * (minor, count) changes of coverage left by all the chunks before it, which make a range of
+   * chunks a set of its own, see polygon_set_image::load.
+   */
+  struct polygon_set_file_header {
+    char magic[8];
+    unsigned int version;
+    unsigned int byte_order;
+    unsigned int kind;
+    unsigned int coordinate_size;
+    unsigned int element_size;
+    unsigned int flags;
+    polygon_ulong_long_type element_count;
+    polygon_ulong_long_type chunk_count;
+    polygon_ulong_long_type profile_count;
+    polygon_ulong_long_type reserved;
+
+    static const unsigned int current_version = 1;
+    static const unsigned int native_byte_order = 0x01020304;
+    static const unsigned int vertical_flag = 1;
+    static const unsigned int sorted_flag = 2;
+    static const unsigned int clean_flag = 4;
+    static const std::size_t alignment = 64;
+
+    static inline const char* magic_string() { return "BPOLYSET"; }
+    static inline polygon_ulong_long_type aligned(polygon_ulong_long_type offset) {
+      return (offset + alignment - 1) / alignment * alignment;
+    }
+  };
+
+  //an entry of the chunk index, profile_begin and profile_end index the profiles section
+  template <typename Unit>
+  struct polygon_set_file_chunk {
+    Unit major;
+    polygon_ulong_long_type begin;
+    polygon_ulong_long_type profile_begin;
+    polygon_ulong_long_type profile_end;
+  };
+
+  //the kind of a set in the format, its elements and how they are given back to the set
+  template <typename set_type>
+  struct polygon_set_file_traits {};
+
+  template <typename T>
+  struct polygon_set_file_traits<polygon_90_set_data<T> > {
+    typedef T coordinate_type;
+    typedef std::pair<T, std::pair<T, int> > element_type;
+    static const unsigned int kind = 90;
+    static inline T major(const element_type& element) { return element.first; }
+    static inline orientation_2d orient(const polygon_90_set_data<T>& set) { return set.orient(); }
+    //the elements of set, unpacked into unpacked if the set is compacted
+    static inline const std::vector<element_type>& value(const polygon_90_set_data<T>& set,
+                                                         std::vector<element_type>& unpacked) {
+      if(!set.compacted())
+        return set.value();
+      unpacked.assign(set.begin_compact(), set.end_compact());
+      return unpacked;
+    }
+    static inline void set_clean(polygon_90_set_data<T>& set, const element_type* begin, const element_type* end,
+                                 orientation_2d orient) {
+      set.set_clean(begin, end, orient);
+    }
+    static inline void set(polygon_90_set_data<T>& set, const element_type* begin, const element_type* end,
+                           orientation_2d orient) {
+      set.set(begin, end, orient);
+    }
+  };
+
+  template <typename T>
+  struct polygon_set_file_traits<polygon_45_set_data<T> > {
+    typedef T coordinate_type;
+    typedef typename polygon_45_set_data<T>::Vertex45Compact element_type;
+    static const unsigned int kind = 45;
+    static inline T major(const element_type& element) { return element.pt.x(); }
+    static inline orientation_2d orient(const polygon_45_set_data<T>&) { return HORIZONTAL; }
+    static inline const std::vector<element_type>& value(const polygon_45_set_data<T>& set,
+                                                         std::vector<element_type>&) {
+      return set.value();
+    }
+    static inline void set_clean(polygon_45_set_data<T>& set, const element_type* begin, const element_type* end,
+                                 orientation_2d) {
+      set.set_clean(begin, end);
+    }
+    static inline void set(polygon_45_set_data<T>& set, const element_type* begin, const element_type* end,
+                           orientation_2d) {
+      set.set(begin, end);
+    }
+  };
+
+  template <typename T>
+  struct polygon_set_file_traits<polygon_set_data<T> > {
+    typedef T coordinate_type;
+    typedef typename polygon_set_data<T>::element_type element_type;
+    static const unsigned int kind = 1;
+    static inline T major(const element_type& element) { return element.first.first.x(); }
+    static inline orientation_2d orient(const polygon_set_data<T>&) { return HORIZONTAL; }
+    static inline const std::vector<element_type>& value(const polygon_set_data<T>& set,
+                                                         std::vector<element_type>&) {
+      return set.value();
+    }
+    static inline void set_clean(polygon_set_data<T>& set, const element_type* begin, const element_type* end,
+                                 orientation_2d) {
+      set.set_clean(begin, end);
+    }
+    static inline void set(polygon_set_data<T>& set, const element_type* begin, const element_type* end,
+                           orientation_2d) {
+      set.set(begin, end);
+    }
+  };
+
+namespace polygon_set_file {
+
+  template <typename set_type>
+  inline polygon_set_file_header makeHeader() {
+    typedef polygon_set_file_traits<set_type> traits;
+    polygon_set_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, polygon_set_file_header::magic_string(), sizeof(header.magic));
+    header.version = polygon_set_file_header::current_version;
+    header.byte_order = polygon_set_file_header::native_byte_order;
+    header.kind = traits::kind;
+    header.coordinate_size = sizeof(typename traits::coordinate_type);
+    header.element_size = sizeof(typename traits::element_type);
+    return header;
+  }
+
+  //throws unless header was written for set_type by a writer like this one
+  template <typename set_type>
+  inline void checkHeader(const polygon_set_file_header& header) {
+    polygon_set_file_header expected = makeHeader<set_type>();
+    if(std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+      throw std::runtime_error("boost::polygon: not a polygon set file");
+    if(header.version != expected.version)
+      throw std::runtime_error("boost::polygon: unsupported polygon set file version");
+    if(header.byte_order != expected.byte_order)
+      throw std::runtime_error("boost::polygon: polygon set file of another byte order");
+    if(header.kind != expected.kind || header.coordinate_size != expected.coordinate_size ||
+       header.element_size != expected.element_size)
+      throw std::runtime_error("boost::polygon: polygon set file of another set type");
+  }
+
+  template <typename Unit>
+  inline polygon_ulong_long_type elementsOffset(const polygon_set_file_header& header) {
+    return polygon_set_file_header::aligned(sizeof(polygon_set_file_header) +
+                                            header.chunk_count * sizeof(polygon_set_file_chunk<Unit>));
+  }
+
+  template <typename Unit>
+  inline polygon_ulong_long_type profilesOffset(const polygon_set_file_header& header) {
+    return polygon_set_file_header::aligned(elementsOffset<Unit>(header) + header.element_count * header.element_size);
+  }
+
+  //throws unless chunk, which follows previous in the chunk index (0 for the first chunk), indexes
+  //the elements and profiles of header in order, as the writer leaves them
+  template <typename Unit>
+  inline void checkChunk(const polygon_set_file_header& header, const polygon_set_file_chunk<Unit>& chunk,
+                         const polygon_set_file_chunk<Unit>* previous) {
+    if(chunk.begin >= header.element_count || chunk.profile_begin > chunk.profile_end ||
+       chunk.profile_end > header.profile_count ||
+       (previous && (chunk.begin <= previous->begin || chunk.profile_begin < previous->profile_end ||
+                     !(previous->major < chunk.major))))
+      throw std::runtime_error("boost::polygon: polygon set file with a damaged chunk index");
+  }
+
+  inline void writePadding(std::ostream& os, polygon_ulong_long_type offset) {
+    static const char zeros[polygon_set_file_header::alignment] = {0};
+    os.write(zeros, (std::streamsize)(polygon_set_file_header::aligned(offset) - offset));
+  }
+
+  //the first element of each chunk, which starts at a change of major coordinate
+  template <typename traits>
+  inline void chunkBounds(std::vector<std::size_t>& bounds, const typename traits::element_type* elements,
+                          std::size_t size, std::size_t chunkSize) {
+    bounds.clear();
+    if(size == 0)
+      return;
+    bounds.push_back(0);
+    for(std::size_t i = chunkSize; i < size; i += chunkSize) {
+      if(i <= bounds.back())
+        continue;
+      while(i < size && traits::major(elements[i]) == traits::major(elements[i - 1]))
+        ++i;
+      if(i < size)
+        bounds.push_back(i);
+    }
+  }
+
+  //the profiles of the scanline entering each chunk of sorted polygon_90_set_data vertices
+  template <typename Unit>
+  inline void chunkProfiles(std::vector<std::vector<std::pair<Unit, int> > >& profiles,
+                            const std::pair<Unit, std::pair<Unit, int> >* elements,
+                            const std::vector<std::size_t>& bounds, std::size_t size) {
+    typedef const std::pair<Unit, std::pair<Unit, int> >* iterator_type;
+    std::vector<iterator_type> slabs;
+    for(std::size_t k = 0; k < bounds.size(); ++k)
+      slabs.push_back(elements + bounds[k]);
+    slabs.push_back(elements + size);
+    std::vector<std::vector<std::pair<Unit, int> > > netProfiles(bounds.size());
+    polygon_formation::SlabProfileTask<iterator_type, Unit> profileTask(slabs, netProfiles);
+    for(std::size_t k = 0; k + 1 < bounds.size(); ++k)
+      profileTask(k);
+    profiles.clear();
+    profiles.resize(bounds.size());
+    for(std::size_t k = 1; k < bounds.size(); ++k)
+      polygon_formation::addProfiles(profiles[k], profiles[k - 1], netProfiles[k - 1]);
+  }
+
+  template <typename Unit, typename element_type>
+  inline void chunkProfiles(std::vector<std::vector<std::pair<Unit, int> > >& profiles, const element_type*,
+                            const std::vector<std::size_t>&, std::size_t) {
+    profiles.clear();
+  }
+
+}
+
+  //Writes set to os in the binary format with chunks of about chunk_size elements.  The set is
+  //written as it is, sorted and clean or not; clean it first for files that load without work.
+  template <typename set_type>
+  inline void write_polygon_set(std::ostream& os, const set_type& set, std::size_t chunk_size = 1 << 16) {
+    typedef polygon_set_file_traits<set_type> traits;
+    typedef typename traits::coordinate_type Unit;
+    typedef typename traits::element_type element_type;
+    std::vector<element_type> unpacked;
+    const std::vector<element_type>& value = traits::value(set, unpacked);
+    const element_type* elements = value.empty() ? 0 : &value[0];
+    std::vector<std::size_t> bounds;
+    std::vector<std::vector<std::pair<Unit, int> > > profiles;
+    if(set.sorted()) {
+      polygon_set_file::chunkBounds<traits>(bounds, elements, value.size(), chunk_size < 1 ? 1 : chunk_size);
+      polygon_set_file::chunkProfiles(profiles, elements, bounds, value.size());
+    }
+    polygon_set_file_header header = polygon_set_file::makeHeader<set_type>();
+    if(traits::orient(set) == VERTICAL) header.flags |= polygon_set_file_header::vertical_flag;
+    if(set.sorted()) header.flags |= polygon_set_file_header::sorted_flag;
+    if(set.sorted() && !set.dirty()) header.flags |= polygon_set_file_header::clean_flag;
+    header.element_count = value.size();
+    header.chunk_count = bounds.size();
+    std::vector<polygon_set_file_chunk<Unit> > chunks(bounds.size());
+    for(std::size_t k = 0; k < bounds.size(); ++k) {
+      chunks[k].major = traits::major(elements[bounds[k]]);
+      chunks[k].begin = bounds[k];
+      chunks[k].profile_begin = header.profile_count;
+      if(!profiles.empty())
+        header.profile_count += profiles[k].size();
+      chunks[k].profile_end = header.profile_count;
+    }
+
+    os.write((const char*)&header, sizeof(header));
+    if(!chunks.empty())
+      os.write((const char*)&chunks[0], (std::streamsize)(chunks.size() * sizeof(chunks[0])));
+    polygon_ulong_long_type offset = sizeof(header) + chunks.size() * sizeof(polygon_set_file_chunk<Unit>);
+    polygon_set_file::writePadding(os, offset);
+    offset = polygon_set_file::elementsOffset<Unit>(header);
+    if(!value.empty())
+      os.write((const char*)elements, (std::streamsize)(value.size() * sizeof(element_type)));
+    polygon_set_file::writePadding(os, offset + value.size() * sizeof(element_type));
+    for(std::size_t k = 0; k < profiles.size(); ++k) {
+      if(!profiles[k].empty())
+        os.write((const char*)&profiles[k][0], (std::streamsize)(profiles[k].size() * sizeof(profiles[k][0])));
+    }
+    if(!os)
+      throw std::runtime_error("boost::polygon: cannot write a polygon set file");
+  }
+
+  /*
+   * polygon_set_image is a polygon set file in memory, for example memory mapped, which is used in
+   * place: its elements are a sorted range the booleans and polygon formation take directly when
+   * the file was written clean, and load copies them into a set without sorting or cleaning them.
+   * The memory must be aligned to 8 bytes, as mapped pages and buffers from operator new are, and
+   * outlive the image.
+   */
+  template <typename set_type>
+  class polygon_set_image {
+  public:
+    typedef polygon_set_file_traits<set_type> traits;
+    typedef typename traits::coordinate_type coordinate_type;
+    typedef typename traits::element_type element_type;
+    typedef const element_type* iterator_type;
+    typedef polygon_set_file_chunk<coordinate_type> chunk_type;
+    typedef std::pair<coordinate_type, int> profile_element_type;
+  private:
+    const polygon_set_file_header* header_;
+    const chunk_type* chunks_;
+    const element_type* elements_;
+    const profile_element_type* profiles_;
+  public:
+    inline polygon_set_image(const void* data, std::size_t size) :
+      header_((const polygon_set_file_header*)data), chunks_(0), elements_(0), profiles_(0) {
+      if(size < sizeof(polygon_set_file_header))
+        throw std::runtime_error("boost::polygon: truncated polygon set file");
+      if(((std::size_t)data) % sizeof(polygon_ulong_long_type) != 0)
+        throw std::runtime_error("boost::polygon: misaligned polygon set file image");
+      polygon_set_file::checkHeader<set_type>(*header_);
+      polygon_ulong_long_type end = polygon_set_file::profilesOffset<coordinate_type>(*header_) +
+        header_->profile_count * sizeof(profile_element_type);
+      if(header_->profile_count == 0)
+        end = polygon_set_file::elementsOffset<coordinate_type>(*header_) + header_->element_count * sizeof(element_type);
+      if(size < end)
+        throw std::runtime_error("boost::polygon: truncated polygon set file");
+      const char* bytes = (const char*)data;
+      chunks_ = (const chunk_type*)(bytes + sizeof(polygon_set_file_header));
+      elements_ = (const element_type*)(bytes + polygon_set_file::elementsOffset<coordinate_type>(*header_));
+      profiles_ = (const profile_element_type*)(bytes + polygon_set_file::profilesOffset<coordinate_type>(*header_));
+      for(std::size_t k = 0; k < chunks(); ++k)
+        polygon_set_file::checkChunk(*header_, chunks_[k], k ? chunks_ + k - 1 : 0);
+    }
+
+    inline iterator_type begin() const { return elements_; }
+    inline iterator_type end() const { return elements_ + header_->element_count; }
+    inline std::size_t size() const { return (std::size_t)header_->element_count; }
+    inline orientation_2d orient() const {
+      return (header_->flags & polygon_set_file_header::vertical_flag) ? VERTICAL : HORIZONTAL;
+    }
+    inline bool sorted() const { return (header_->flags & polygon_set_file_header::sorted_flag) != 0; }
+    inline bool dirty() const { return (header_->flags & polygon_set_file_header::clean_flag) == 0; }
+
+    inline std::size_t chunks() const { return (std::size_t)header_->chunk_count; }
+    inline const chunk_type& chunk(std::size_t k) const { return chunks_[k]; }
+    inline iterator_type begin(std::size_t k) const { return elements_ + chunks_[k].begin; }
+    inline iterator_type end(std::size_t k) const { return k + 1 < chunks() ? begin(k + 1) : end(); }
+
+    //the chunks [first, last) that hold the elements of major coordinates in [low, high]
+    inline std::pair<std::size_t, std::size_t> chunks(coordinate_type low, coordinate_type high) const {
+      std::size_t first = upperBound_(low);
+      if(first > 0) --first;
+      return std::make_pair(first, upperBound_(high));
+    }
+
+    //copies the whole set into set, which is sorted and cleaned only if the file was not
+    inline void load(set_type& set) const {
+      if(sorted() && !dirty())
+        traits::set_clean(set, begin(), end(), orient());
+      else
+        traits::set(set, begin(), end(), orient());
+    }
+
+    //Loads the part of a clean polygon_90_set_data in the chunks holding the coordinates [low, high]
+    //into set: the chunks are closed at both ends by the profiles of the scanline entering them, so
+    //set is the file set clipped to the chunks and clean.
+    inline void load(set_type& set, coordinate_type low, coordinate_type high) const {
+      if(traits::kind != 90 || !sorted() || dirty())
+        throw std::runtime_error("boost::polygon: partial loads need a clean polygon_90_set_data file");
+      std::pair<std::size_t, std::size_t> range = chunks(low, high);
+      std::vector<element_type> elements;
+      if(range.first < range.second) {
+        const chunk_type& first = chunks_[range.first];
+        for(std::size_t i = first.profile_begin; i < first.profile_end; ++i)
+          elements.push_back(element_type(first.major, profiles_[i]));
+        std::size_t opening = elements.size();
+        elements.insert(elements.end(), begin(range.first), end(range.second - 1));
+        std::inplace_merge(elements.begin(), elements.begin() + opening, elements.end());
+        if(range.second < chunks()) {
+          const chunk_type& next = chunks_[range.second];
+          for(std::size_t i = next.profile_begin; i < next.profile_end; ++i)
+            elements.push_back(element_type(next.major, profile_element_type(profiles_[i].first,
+                                                                             -profiles_[i].second)));
+        }
+        boolean_op::default_arg_workaround<int>::applyBooleanOr(elements);
+      }
+      traits::set_clean(set, elements.empty() ? 0 : &elements[0], elements.empty() ? 0 : &elements[0] + elements.size(),
+                        orient());
+    }
+
+  private:
+    inline std::size_t upperBound_(coordinate_type major) const {
+      std::size_t first = 0, count = chunks();
+      while(count > 0) {
+        std::size_t step = count / 2;
+        if(!(major < chunks_[first + step].major)) {
+          first += step + 1;
+          count -= step + 1;
+        } else {
+          count = step;
+        }
+      }
+      return first;
+    }
+  };
+
+  //reads a set written by write_polygon_set from is into set, as polygon_set_image::load does
+  template <typename set_type>
+  inline void read_polygon_set(std::istream& is, set_type& set) {
+    typedef polygon_set_file_traits<set_type> traits;
+    typedef typename traits::coordinate_type Unit;
+    typedef typename traits::element_type element_type;
+    polygon_set_file_header header;
+    if(!is.read((char*)&header, sizeof(header)))
+      throw std::runtime_error("boost::polygon: truncated polygon set file");
+    polygon_set_file::checkHeader<set_type>(header);
+    polygon_set_file_chunk<Unit> chunk, previous;
+    for(polygon_ulong_long_type k = 0; k < header.chunk_count; ++k) {
+      if(!is.read((char*)&chunk, sizeof(chunk)))
+        throw std::runtime_error("boost::polygon: truncated polygon set file");
+      polygon_set_file::checkChunk(header, chunk, k ? &previous : 0);
+      previous = chunk;
+    }
+    is.ignore((std::streamsize)(polygon_set_file::elementsOffset<Unit>(header) - sizeof(header) -
+                                header.chunk_count * sizeof(chunk)));
+    std::vector<element_type> elements((std::size_t)header.element_count);
+    if(!elements.empty() &&
+       !is.read((char*)&elements[0], (std::streamsize)(elements.size() * sizeof(element_type))))
+      throw std::runtime_error("boost::polygon: truncated polygon set file");
+    is.ignore((std::streamsize)(polygon_set_file::profilesOffset<Unit>(header) -
+                                polygon_set_file::elementsOffset<Unit>(header) - elements.size() * sizeof(element_type) +
+                                header.profile_count * sizeof(std::pair<Unit, int>)));
+    orientation_2d orient = (header.flags & polygon_set_file_header::vertical_flag) ? VERTICAL : HORIZONTAL;
+    const element_type* begin = elements.empty() ? 0 : &elements[0];
+    if((header.flags & polygon_set_file_header::sorted_flag) && (header.flags & polygon_set_file_header::clean_flag))
+      traits::set_clean(set, begin, begin + elements.size(), orient);
+    else
+      traits::set(set, begin, begin + elements.size(), orient);
+  }
+
+}
+}
+#endif
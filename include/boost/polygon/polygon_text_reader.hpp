@@ -0,0 +1,301 @@
+/*
+  Copyright 2008 Intel Corporation
+
+  Use, modification and distribution are subject to the Boost Software License,
+  Version 1.0. (See accompanying file LICENSE_1_0.txt or copy at
+  http://www.boost.org/LICENSE_1_0.txt).
+*/
+#ifndef BOOST_POLYGON_POLYGON_TEXT_READER_HPP
+#define BOOST_POLYGON_POLYGON_TEXT_READER_HPP
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "polygon.hpp"
+
+namespace boost { namespace polygon{
+
+  /*
+   * Readers of the text formats of example/input_data and of the layouts of doc/tutorial, which
+   * parse text in memory (a file read whole, or memory mapped by the caller) without iostreams.
+   *
+   * input_data: the number of points, the x y of every point, the number of segments and the
+   * x1 y1 x2 y2 of every segment, all whitespace separated integers.
+   *
+   * layout: one record per line, "Rectangle xl xh yl yh LAYER" records go into the
+   * polygon_90_set_data of their layer and other records, such as Pin, are skipped.  Lines are
+   * split into chunks parsed on up to num_threads threads (0 means one per hardware thread) when
+   * BOOST_POLYGON_USE_THREADS is defined; the sets get the same vertices either way.
+   *
+   * Malformed text, and integers out of the range of the coordinate type, throw
+   * std::runtime_error with the line they are on.
+   */
+namespace text_input {
+
+  //scans the whitespace separated tokens of [pos, end), text is where line numbers count from
+  class TokenScanner {
+  private:
+    const char* text_;
+    const char* pos_;
+    const char* end_;
+  public:
+    inline TokenScanner(const char* text, const char* pos, const char* end) : text_(text), pos_(pos), end_(end) {}
+
+    static inline bool isSpace(char c) {
+      return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+    }
+
+    //the next token, false at the end of the text, or of the line if sameLine is set
+    inline bool word(const char*& begin, const char*& end, bool sameLine = false) {
+      skipSpace_(sameLine);
+      if(pos_ == end_ || *pos_ == '\n')
+        return false;
+      begin = pos_;
+      while(pos_ != end_ && !isSpace(*pos_))
+        ++pos_;
+      end = pos_;
+      return true;
+    }
+
+    //the next token as an integer, which must be on this line if sameLine is set
+    template <typename Unit>
+    inline void integer(Unit& value, bool sameLine = false) {
+      skipSpace_(sameLine);
+      if(pos_ == end_ || *pos_ == '\n')
+        error("missing integer");
+      bool negative = *pos_ == '-';
+      if(*pos_ == '-' || *pos_ == '+')
+        ++pos_;
+      const char* digits = pos_;
+      const polygon_ulong_long_type limit = (polygon_ulong_long_type)(std::numeric_limits<polygon_long_long_type>::max)();
+      polygon_ulong_long_type magnitude = 0;
+      for( ; pos_ != end_ && (unsigned int)(*pos_ - '0') < 10; ++pos_) {
+        unsigned int digit = (unsigned int)(*pos_ - '0');
+        if(magnitude > (limit + 1 - digit) / 10)
+          error("integer out of range");
+        magnitude = magnitude * 10 + digit;
+      }
+      if(pos_ == digits || (pos_ != end_ && !isSpace(*pos_)))
+        error("malformed integer");
+      if(magnitude > limit + negative)
+        error("integer out of range");
+      polygon_long_long_type result = negative ? -(polygon_long_long_type)(magnitude - 1) - 1 : (polygon_long_long_type)magnitude;
+      if(std::numeric_limits<Unit>::is_integer) {
+        bool outOfRange = std::numeric_limits<Unit>::is_signed ?
+          result < (polygon_long_long_type)(std::numeric_limits<Unit>::min)() ||
+          (polygon_long_long_type)(std::numeric_limits<Unit>::max)() < result :
+          result < 0 || (polygon_ulong_long_type)(std::numeric_limits<Unit>::max)() < (polygon_ulong_long_type)result;
+        if(outOfRange)
+          error("integer out of range");
+      }
+      value = (Unit)result;
+    }
+
+    inline void skipLine() {
+      while(pos_ != end_ && *pos_ != '\n')
+        ++pos_;
+    }
+
+    inline void error(const char* what) const {
+      std::size_t line = 1;
+      for(const char* pos = text_; pos != pos_; ++pos)
+        line += *pos == '\n';
+      std::string number;
+      for( ; line; line /= 10)
+        number.insert(number.begin(), (char)('0' + line % 10));
+      throw std::runtime_error(std::string("boost::polygon: ") + what + " on line " + number);
+    }
+
+  private:
+    inline void skipSpace_(bool sameLine) {
+      while(pos_ != end_ && isSpace(*pos_) && !(sameLine && *pos_ == '\n'))
+        ++pos_;
+    }
+  };
+
+  //parses the layout records of chunk k, the lines in [bounds[k], bounds[k + 1]), into the
+  //vertices of each layer in the order the layers first appear
+  template <typename Unit>
+  class LayoutChunkTask {
+  public:
+    typedef std::pair<Unit, std::pair<Unit, int> > vertex_type;
+    typedef std::vector<std::pair<std::string, std::vector<vertex_type> > > layers_type;
+  private:
+    const char* text_;
+    const std::vector<const char*>& bounds_;
+    std::vector<layers_type>& layers_;
+  public:
+    inline LayoutChunkTask(const char* text, const std::vector<const char*>& bounds, std::vector<layers_type>& layers) :
+      text_(text), bounds_(bounds), layers_(layers) {}
+
+    inline void operator()(std::size_t k) {
+      TokenScanner scanner(text_, bounds_[k], bounds_[k + 1]);
+      layers_type& layers = layers_[k];
+      std::size_t layer = 0;
+      const char* begin;
+      const char* end;
+      while(scanner.word(begin, end)) {
+        if(end - begin != 9 || std::memcmp(begin, "Rectangle", 9) != 0) {
+          scanner.skipLine();
+          continue;
+        }
+        Unit xl, xh, yl, yh;
+        scanner.integer(xl, true);
+        scanner.integer(xh, true);
+        scanner.integer(yl, true);
+        scanner.integer(yh, true);
+        if(!scanner.word(begin, end, true))
+          scanner.error("missing layer");
+        //records of a layer come in runs, so the layer of the last one is tried first
+        if(layer == layers.size() || !sameName_(layers[layer].first, begin, end)) {
+          for(layer = 0; layer < layers.size() && !sameName_(layers[layer].first, begin, end); ++layer) {}
+          if(layer == layers.size())
+            layers.push_back(std::make_pair(std::string(begin, end), std::vector<vertex_type>()));
+        }
+        rectangle_data<Unit> rect(xl, yl, xh, yh);
+        iterator_geometry_to_set<rectangle_concept, rectangle_data<Unit> >
+          itr(rect, LOW, HORIZONTAL), itr_end(rect, HIGH, HORIZONTAL);
+        layers[layer].second.insert(layers[layer].second.end(), itr, itr_end);
+      }
+    }
+
+  private:
+    static inline bool sameName_(const std::string& name, const char* begin, const char* end) {
+      return name.size() == (std::size_t)(end - begin) && std::memcmp(name.data(), begin, name.size()) == 0;
+    }
+  };
+
+}
+
+  //reads the whole of a file into text
+  inline void read_text_file(const std::string& filename, std::vector<char>& text) {
+    text.clear();
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if(!file)
+      throw std::runtime_error("boost::polygon: cannot open " + filename);
+    std::size_t size = 0;
+    for(;;) {
+      text.resize(size + (size < 65536 ? 65536 : size));
+      std::size_t count = std::fread(&text[size], 1, text.size() - size, file);
+      size += count;
+      if(size < text.size())
+        break;
+    }
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    text.resize(size);
+    if(failed)
+      throw std::runtime_error("boost::polygon: cannot read " + filename);
+  }
+
+  //parses the input_data text [begin, end) into points and segments, appended to the ones given
+  template <typename Unit>
+  inline void parse_points_and_segments(const char* begin, const char* end,
+                                        std::vector<point_data<Unit> >& points,
+                                        std::vector<segment_data<Unit> >& segments) {
+    text_input::TokenScanner scanner(begin, begin, end);
+    //a count is at most the number of integers the text can hold, whatever it reads
+    std::size_t capacity = (std::size_t)(end - begin) / 4;
+    std::size_t count;
+    scanner.integer(count);
+    points.reserve(points.size() + (std::min)(count, capacity));
+    for(std::size_t i = 0; i < count; ++i) {
+      Unit x, y;
+      scanner.integer(x);
+      scanner.integer(y);
+      points.push_back(point_data<Unit>(x, y));
+    }
+    const char* word_begin;
+    const char* word_end;
+    text_input::TokenScanner lookahead(scanner);
+    if(!lookahead.word(word_begin, word_end))
+      return;
+    scanner.integer(count);
+    segments.reserve(segments.size() + (std::min)(count, capacity / 2));
+    for(std::size_t i = 0; i < count; ++i) {
+      Unit x1, y1, x2, y2;
+      scanner.integer(x1);
+      scanner.integer(y1);
+      scanner.integer(x2);
+      scanner.integer(y2);
+      segments.push_back(segment_data<Unit>(point_data<Unit>(x1, y1), point_data<Unit>(x2, y2)));
+    }
+  }
+
+  //parses the layout text [begin, end) into layers, inserting the rectangles of every layer into
+  //its set after reserving room for all of them
+  template <typename Unit>
+  inline void parse_layout_rectangles(const char* begin, const char* end,
+                                      std::map<std::string, polygon_90_set_data<Unit> >& layers,
+                                      std::size_t num_threads = 1) {
+    typedef typename text_input::LayoutChunkTask<Unit>::vertex_type vertex_type;
+    typedef typename text_input::LayoutChunkTask<Unit>::layers_type chunk_layers_type;
+    std::size_t numChunks = 1;
+#ifdef BOOST_POLYGON_USE_THREADS
+    if(num_threads == 0)
+      num_threads = std::thread::hardware_concurrency();
+    //below some tens of thousands of bytes a chunk costs more than it saves
+    numChunks = (std::min)(4 * num_threads, (std::size_t)(end - begin) / 65536);
+    if(num_threads < 2 || numChunks == 0)
+      numChunks = 1;
+#endif
+    std::vector<const char*> bounds(1, begin);
+    for(std::size_t k = 1; k < numChunks; ++k) {
+      const char* bound = begin + (std::size_t)(end - begin) * k / numChunks;
+      if(bound < bounds.back())
+        bound = bounds.back();
+      while(bound != end && *bound != '\n')
+        ++bound;
+      if(bound != end)
+        ++bound;
+      if(bound != bounds.back())
+        bounds.push_back(bound);
+    }
+    if(bounds.back() != end || bounds.size() == 1)
+      bounds.push_back(end);
+    std::vector<chunk_layers_type> chunks(bounds.size() - 1);
+    text_input::LayoutChunkTask<Unit> task(begin, bounds, chunks);
+    parallel_for(chunks.size(), num_threads, task);
+
+    std::map<std::string, std::size_t> sizes;
+    for(std::size_t k = 0; k < chunks.size(); ++k)
+      for(std::size_t i = 0; i < chunks[k].size(); ++i)
+        sizes[chunks[k][i].first] += chunks[k][i].second.size();
+    for(std::map<std::string, std::size_t>::iterator itr = sizes.begin(); itr != sizes.end(); ++itr) {
+      polygon_90_set_data<Unit>& set = layers[itr->first];
+      set.expand();
+      set.reserve(set.value().size() + itr->second);
+    }
+    for(std::size_t k = 0; k < chunks.size(); ++k) {
+      for(std::size_t i = 0; i < chunks[k].size(); ++i) {
+        const std::vector<vertex_type>& vertices = chunks[k][i].second;
+        layers[chunks[k][i].first].insert(vertices.begin(), vertices.end(), HORIZONTAL);
+        std::vector<vertex_type>().swap(chunks[k][i].second);
+      }
+    }
+  }
+
+  template <typename Unit>
+  inline void read_points_and_segments(const std::string& filename, std::vector<point_data<Unit> >& points,
+                                       std::vector<segment_data<Unit> >& segments) {
+    std::vector<char> text;
+    read_text_file(filename, text);
+    const char* begin = text.empty() ? 0 : &text[0];
+    parse_points_and_segments(begin, begin + text.size(), points, segments);
+  }
+
+  template <typename Unit>
+  inline void read_layout_rectangles(const std::string& filename,
+                                     std::map<std::string, polygon_90_set_data<Unit> >& layers,
+                                     std::size_t num_threads = 1) {
+    std::vector<char> text;
+    read_text_file(filename, text);
+    const char* begin = text.empty() ? 0 : &text[0];
+    parse_layout_rectangles(begin, begin + text.size(), layers, num_threads);
+  }
+
+}
+}
+#endif
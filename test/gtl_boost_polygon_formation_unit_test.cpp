@@ -9,6 +9,9 @@
 #define BOOST_POLYGON_NO_DEPS
 #include <boost/polygon/polygon.hpp>
 #include <boost/polygon/polygon_90_set_data_iterator.hpp>
+#include <boost/polygon/polygon_90_external_set_data.hpp>
+#include <boost/polygon/polygon_set_serialization.hpp>
+#include <boost/polygon/polygon_text_reader.hpp>
 #include "gtl_boost_polygon_90_unit_test_utils.h"
 
 namespace gtl = boost::polygon;
@@ -16,6 +19,9 @@ using namespace boost::polygon::operators;
 #include <time.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
 
 void assert_s(bool c, std::string msg) {
   if(!c) {
@@ -24,6 +30,28 @@ void assert_s(bool c, std::string msg) {
   }
 }
 
+//the generator of the randomized tests, a linear congruential one so that they draw the same
+//numbers on every platform, state is the seed and advances with every number drawn
+static unsigned int next_random(unsigned int& state) {
+  state = state * 1103515245u + 12345u;
+  return state >> 8;
+}
+
+//count rectangles with their low corner in [0, range) on both axes and sides of 1 to size
+static std::vector<boost::polygon::rectangle_data<intDC> > random_rects(unsigned int& state, int count,
+                                                                        int range, int size = 30) {
+  std::vector<boost::polygon::rectangle_data<intDC> > rects;
+  rects.reserve(count);
+  for(int i=0; i<count; i++){
+    int x = next_random(state) % range;
+    int y = next_random(state) % range;
+    int w = 1 + next_random(state) % size;
+    int h = 1 + next_random(state) % size;
+    rects.push_back(boost::polygon::rectangle_data<intDC>(x, y, x+w, y+h));
+  }
+  return rects;
+}
+
 /*************New Polygon Formation Tests********************/
 /*
  *
@@ -224,6 +252,1876 @@ int test_new_polygon_formation_marginal_threshold(int argc, char**){
    return 0;
 }
 
+/*
+ * TEST PLAN: form the same polygon set with the default scanline
+ * arena and with a caller supplied arena (twice, so the second run
+ * reuses the slabs of the first). Results must be XOR clean and
+ * the arena must hold no live figures after each run.
+ */
+int test_polygon_formation_arena(){
+   intDC shell_coords[] = {0,0, 10,0, 10,21, 0,21, 0,15, 3,15, 3,13,
+      0,13, 0,10, 5,10, 5,8, 0,8, 0,5, 5,5, 5,3, 0,3};
+   intDC hole_coords[] = {4,11, 7,11, 7,19, 4,19};
+   GTLPolygon shell, hole;
+   GTLPolygonSet pset;
+   CreateGTLPolygon(shell_coords, sizeof(shell_coords)/(2*sizeof(intDC)), shell);
+   CreateGTLPolygon(hole_coords, sizeof(hole_coords)/(2*sizeof(intDC)), hole);
+   pset.insert(shell);
+   pset.insert(hole, true);
+   pset.clean();
+
+   std::vector<GTLPolygon> gold;
+   pset.get(gold);
+
+   boost::polygon::polygon_formation::PolyLineArena<intDC> arena(4);
+   for(size_t run=0; run<2; run++){
+      for(size_t threshold=4; threshold<=8; threshold+=4){
+         std::vector<GTLPolygon> result;
+         boost::polygon::get_polygons(result, pset.begin(), pset.end(),
+            pset.orient(), false, boost::polygon::polygon_90_with_holes_concept(),
+            run ? threshold : (std::numeric_limits<size_t>::max)(), arena);
+         if(!arena.empty()){
+            std::cerr << "FAILED: arena still holds live figures" << std::endl;
+            return 1;
+         }
+         GTLPolygonSet a, b;
+         a.insert(gold.begin(), gold.end());
+         b.insert(result.begin(), result.end());
+         a ^= b;
+         if(!a.empty()){
+            std::cerr << "FAILED: arena formation differs from default" << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_formation_arena] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: drive FlatTailMap and std::map through the same random
+ * sequence of inserts, erases and lookups, holding iterators across
+ * modifications the way the scanline does, and check both agree.
+ */
+int test_flat_tail_map(){
+   typedef boost::polygon::polygon_formation::FlatTailMap<int, int> FlatMap;
+   FlatMap flat;
+   std::map<int, int> gold;
+   unsigned int state = 7;
+   FlatMap::iterator held = flat.end();
+   int heldKey = 0;
+   for(int i=0; i<20000; i++){
+      int key = next_random(state) % 2000;
+      if(next_random(state) % 3){
+         gold.insert(std::make_pair(key, i));
+         flat.insert(flat.end(), std::make_pair(key, i));
+      }else{
+         if(held != flat.end() && heldKey == key) held = flat.end();
+         gold.erase(key);
+         flat.erase(key);
+      }
+      if(held == flat.end() && !gold.empty()){
+         held = flat.lower_bound(key);
+         if(held != flat.end()) heldKey = held->first;
+      }
+      if(held != flat.end() && held->second != gold[heldKey]){
+         std::cerr << "FAILED: held iterator lost its element" << std::endl;
+         return 1;
+      }
+      FlatMap::iterator lb = flat.lower_bound(key);
+      std::map<int, int>::iterator glb = gold.lower_bound(key);
+      if((lb == flat.end()) != (glb == gold.end()) ||
+         (glb != gold.end() && (lb->first != glb->first || lb->second != glb->second))){
+         std::cerr << "FAILED: lower_bound mismatch" << std::endl;
+         return 1;
+      }
+   }
+   if(flat.size() != gold.size()){
+      std::cerr << "FAILED: size mismatch" << std::endl;
+      return 1;
+   }
+   std::map<int, int>::iterator gitr = gold.begin();
+   for(FlatMap::iterator itr = flat.begin(); itr != flat.end(); ++itr, ++gitr){
+      if(itr->first != gitr->first || itr->second != gitr->second){
+         std::cerr << "FAILED: iteration mismatch" << std::endl;
+         return 1;
+      }
+   }
+   FlatMap::iterator last = flat.end();
+   --last;
+   if(last->first != gold.rbegin()->first){
+      std::cerr << "FAILED: decrement from end" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_flat_tail_map] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: form random rectangle clouds with a std::map tail map
+ * and with the default FlatTailMap, with and without a vertex
+ * threshold, and check both results are XOR clean with the input.
+ */
+int test_flat_tail_map_formation(){
+   typedef boost::polygon::polygon_formation::ActiveTail<intDC> Tail;
+   unsigned int state = 11;
+   for(int trial=0; trial<20; trial++){
+      GTLPolygonSet pset(boost::polygon::VERTICAL);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 300, 200);
+      pset.insert(rects.begin(), rects.end());
+      pset.clean();
+      for(int t=0; t<2; t++){
+         size_t threshold = t ? 8 : (std::numeric_limits<size_t>::max)();
+         std::vector<boost::polygon::polygon_90_data<intDC> > mapResult, flatResult;
+         boost::polygon::polygon_formation::ContainerOutput<
+            std::vector<boost::polygon::polygon_90_data<intDC> > > mapOutput(mapResult), flatOutput(flatResult);
+         boost::polygon::polygon_formation::ScanLineToPolygonItrs<true, intDC,
+            boost::polygon::polygon_90_concept, std::map<intDC, Tail*> > mapScanline(true);
+         boost::polygon::polygon_formation::ScanLineToPolygonItrs<true, intDC,
+            boost::polygon::polygon_90_concept> flatScanline(true);
+         boost::polygon::polygon_formation::formPolygons(mapScanline, pset.begin(), pset.end(), threshold, mapOutput);
+         boost::polygon::polygon_formation::formPolygons(flatScanline, pset.begin(), pset.end(), threshold, flatOutput);
+         if(mapResult.size() != flatResult.size()){
+            std::cerr << "FAILED: tail maps produced different polygon counts" << std::endl;
+            return 1;
+         }
+         // the vertex threshold path is checked against the std::map
+         // scanline, without a threshold against the input itself.
+         GTLPolygonSet check(boost::polygon::VERTICAL);
+         check.insert(flatResult.begin(), flatResult.end());
+         if(t){
+            GTLPolygonSet reference(boost::polygon::VERTICAL);
+            reference.insert(mapResult.begin(), mapResult.end());
+            check ^= reference;
+         }else{
+            check ^= pset;
+         }
+         if(!check.empty()){
+            std::cerr << "FAILED: flat tail map formation is not XOR clean" << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_flat_tail_map_formation] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: stream the polygon set of test_polygon_formation_arena
+ * to a sink, as polygons with holes and as fractured polygons, with
+ * and without a vertex threshold. Each figure must arrive while the
+ * view is valid and the union of the figures must be XOR clean.  A
+ * polygon type in place of the concept must stream the same figures.
+ */
+struct GTLPolygonSink {
+   GTLPolygonSet& pset_;
+   unsigned int count_, holes_;
+   GTLPolygonSink(GTLPolygonSet& pset) : pset_(pset), count_(0), holes_(0) {}
+   template <typename figure_type>
+   void operator()(const figure_type& figure){
+      GTLPolygon poly;
+      boost::polygon::assign(poly, figure);
+      pset_.insert(poly);
+      ++count_;
+      holes_ += poly.size_holes();
+   }
+};
+
+int test_polygon_formation_sink(){
+   intDC shell_coords[] = {0,0, 10,0, 10,21, 0,21, 0,15, 3,15, 3,13,
+      0,13, 0,10, 5,10, 5,8, 0,8, 0,5, 5,5, 5,3, 0,3};
+   intDC hole_coords[] = {4,11, 7,11, 7,19, 4,19};
+   GTLPolygon shell, hole;
+   GTLPolygonSet pset;
+   CreateGTLPolygon(shell_coords, sizeof(shell_coords)/(2*sizeof(intDC)), shell);
+   CreateGTLPolygon(hole_coords, sizeof(hole_coords)/(2*sizeof(intDC)), hole);
+   pset.insert(shell);
+   pset.insert(hole, true);
+   pset.clean();
+
+   for(size_t threshold=4; threshold<=8; threshold+=4){
+      for(int fracture=0; fracture<2; fracture++){
+         GTLPolygonSet result;
+         GTLPolygonSink sink(result);
+         unsigned int count;
+         size_t vthreshold = threshold == 8 ? (std::numeric_limits<size_t>::max)() : threshold;
+         if(fracture)
+            count = boost::polygon::get_polygons_to_sink(sink, pset.begin(), pset.end(),
+               pset.orient(), true, boost::polygon::polygon_90_concept(), vthreshold);
+         else
+            count = boost::polygon::get_polygons_to_sink(sink, pset.begin(), pset.end(),
+               pset.orient(), false, boost::polygon::polygon_90_with_holes_concept(), vthreshold);
+         if(count != sink.count_ || !count){
+            std::cerr << "FAILED: sink saw " << sink.count_ << " of " << count << " figures" << std::endl;
+            return 1;
+         }
+         result ^= pset;
+         if(!result.empty()){
+            std::cerr << "FAILED: streamed figures are not XOR clean" << std::endl;
+            return 1;
+         }
+         GTLPolygonSet typed;
+         GTLPolygonSink typedSink(typed);
+         if(fracture)
+            count = boost::polygon::get_polygons_to_sink(typedSink, pset.begin(), pset.end(),
+               pset.orient(), true, boost::polygon::polygon_90_data<intDC>(), vthreshold);
+         else
+            count = boost::polygon::get_polygons_to_sink(typedSink, pset.begin(), pset.end(),
+               pset.orient(), false, GTLPolygon(), vthreshold);
+         if(count != sink.count_ || typedSink.count_ != sink.count_ || typedSink.holes_ != sink.holes_ ||
+            (threshold == 8 && sink.holes_ != (fracture ? 0u : 1u))){
+            std::cerr << "FAILED: sink given a polygon type saw " << typedSink.count_ << " figures, "
+               << typedSink.holes_ << " holes" << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_formation_sink] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: form random rectangle sets of both orientations in 1 to
+ * 6 slabs, cut and stitched, as polygons and polygons with holes.
+ * Results must be XOR clean and the stitched results must have the
+ * same number of figures as the serial formation.  A mesh crossing
+ * every slab, with islands in its holes, must stitch into as many
+ * figures and holes as the serial formation gives.
+ */
+int test_parallel_polygon_formation(){
+   unsigned int state = 5;
+   for(int trial=0; trial<8; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet pset(orient);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 200, 200);
+      pset.insert(rects.begin(), rects.end());
+      pset.clean();
+      std::vector<GTLPolygon> serialHoles;
+      std::vector<boost::polygon::polygon_90_data<intDC> > serialPolys;
+      pset.get(serialHoles);
+      pset.get(serialPolys);
+      for(size_t slabs=1; slabs<=6; slabs++){
+         for(int stitch=0; stitch<2; stitch++){
+            std::vector<GTLPolygon> holes;
+            std::vector<boost::polygon::polygon_90_data<intDC> > polys;
+            pset.get_parallel(holes, slabs, stitch != 0);
+            pset.get_parallel(polys, slabs, stitch != 0);
+            if(stitch && (holes.size() != serialHoles.size() || polys.size() != serialPolys.size())){
+               std::cerr << "FAILED: stitched formation in " << slabs << " slabs formed "
+                  << holes.size() << "/" << polys.size() << " figures, expected "
+                  << serialHoles.size() << "/" << serialPolys.size() << std::endl;
+               return 1;
+            }
+            GTLPolygonSet a(orient), b(orient);
+            a.insert(holes.begin(), holes.end());
+            b.insert(polys.begin(), polys.end());
+            a ^= pset;
+            b ^= pset;
+            if(!a.empty() || !b.empty()){
+               std::cerr << "FAILED: formation in " << slabs << " slabs is not XOR clean" << std::endl;
+               return 1;
+            }
+         }
+      }
+   }
+   for(int trial=0; trial<2; trial++){
+      GTLPolygonSet mesh(trial ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL);
+      for(int i=0; i<30; i++){
+         mesh.insert(boost::polygon::rectangle_data<intDC>(i * 20, 0, i * 20 + 4, 600));
+         mesh.insert(boost::polygon::rectangle_data<intDC>(0, i * 20, 600, i * 20 + 4));
+         for(int j=0; j<30; j+=3)
+            mesh.insert(boost::polygon::rectangle_data<intDC>(i * 20 + 8, j * 20 + 8, i * 20 + 12, j * 20 + 12));
+      }
+      mesh.clean();
+      std::vector<GTLPolygon> serialHoles, holes;
+      std::vector<boost::polygon::polygon_90_data<intDC> > serialPolys, polys;
+      mesh.get(serialHoles);
+      mesh.get(serialPolys);
+      mesh.get_parallel(holes, 5, true);
+      mesh.get_parallel(polys, 5, true);
+      size_t serialHoleCount = 0, holeCount = 0;
+      for(size_t i=0; i<serialHoles.size(); i++) serialHoleCount += serialHoles[i].size_holes();
+      for(size_t i=0; i<holes.size(); i++) holeCount += holes[i].size_holes();
+      GTLPolygonSet a(mesh.orient()), b(mesh.orient());
+      a.insert(holes.begin(), holes.end());
+      b.insert(polys.begin(), polys.end());
+      a ^= mesh;
+      b ^= mesh;
+      if(holes.size() != serialHoles.size() || holeCount != serialHoleCount ||
+         polys.size() != serialPolys.size() || !a.empty() || !b.empty()){
+         std::cerr << "FAILED: stitched formation of a mesh differs from the serial one" << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_parallel_polygon_formation] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: form random rectangle sets of both orientations into a
+ * polygon_buffer, with holes and fractured, and check that every ring
+ * has exactly the coordinates of the polygons formed the usual way.  A
+ * single polygon with holes must reserve exactly its coordinates.
+ */
+int test_polygon_buffer_formation(){
+   unsigned int state = 17;
+   for(int trial=0; trial<8; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet pset(orient);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 200, 200);
+      pset.insert(rects.begin(), rects.end());
+      std::vector<GTLPolygon> gold;
+      std::vector<boost::polygon::polygon_90_data<intDC> > goldFractured;
+      boost::polygon::polygon_buffer<intDC> buffer, fractured;
+      pset.get(gold);
+      pset.get(goldFractured);
+      pset.get(buffer);
+      boost::polygon::get_polygons(fractured, pset.begin(), pset.end(), orient, true,
+         boost::polygon::polygon_90_concept());
+      if(buffer.size() != gold.size() || fractured.size() != goldFractured.size() ||
+         fractured.size_rings() != fractured.size()){
+         std::cerr << "FAILED: polygon_buffer holds the wrong number of polygons" << std::endl;
+         return 1;
+      }
+      for(size_t i=0; i<buffer.size(); i++){
+         boost::polygon::polygon_buffer_polygon<intDC> poly = buffer[i];
+         bool same = poly.size_holes() == gold[i].size_holes() &&
+            std::equal(poly.begin_compact(), poly.end_compact(), gold[i].begin_compact()) &&
+            poly.size() == (size_t)(gold[i].end_compact() - gold[i].begin_compact());
+         GTLPolygon::iterator_holes_type goldHole = gold[i].begin_holes();
+         for(boost::polygon::polygon_buffer_polygon<intDC>::iterator_holes_type hole = poly.begin_holes();
+             same && hole != poly.end_holes(); ++hole, ++goldHole){
+            same = (*hole).size() == (size_t)((*goldHole).end_compact() - (*goldHole).begin_compact()) &&
+               std::equal((*hole).begin_compact(), (*hole).end_compact(), (*goldHole).begin_compact());
+         }
+         if(!same){
+            std::cerr << "FAILED: polygon_buffer polygon " << i << " differs" << std::endl;
+            return 1;
+         }
+      }
+      for(size_t i=0; i<fractured.size(); i++){
+         boost::polygon::polygon_buffer_polygon<intDC> poly = fractured[i];
+         if(poly.size() != (size_t)(goldFractured[i].end_compact() - goldFractured[i].begin_compact()) ||
+            !std::equal(poly.begin_compact(), poly.end_compact(), goldFractured[i].begin_compact())){
+            std::cerr << "FAILED: fractured polygon_buffer polygon " << i << " differs" << std::endl;
+            return 1;
+         }
+      }
+      GTLPolygonSet check(orient);
+      for(size_t i=0; i<buffer.size(); i++){
+         GTLPolygon poly;
+         boost::polygon::assign(poly, buffer[i]);
+         check.insert(poly);
+      }
+      check ^= pset;
+      if(!check.empty()){
+         std::cerr << "FAILED: polygon_buffer is not XOR clean" << std::endl;
+         return 1;
+      }
+      //the coordinates of the first polygon written into a buffer are reserved exactly
+      GTLPolygonSet ring(orient);
+      ring.insert(boost::polygon::rectangle_data<intDC>(0, 0, 30, 30));
+      ring.insert(boost::polygon::rectangle_data<intDC>(10, 10, 20, 20), true);
+      ring.insert(boost::polygon::rectangle_data<intDC>(5, 22, 8, 25), true);
+      boost::polygon::polygon_buffer<intDC> single;
+      ring.get(single);
+      if(single.size() != 1 || single.coordinates().size() != 12 || single.coordinates().capacity() != 12){
+         std::cerr << "FAILED: polygon_buffer reserved " << single.coordinates().capacity() << " coordinates for "
+            << single.coordinates().size() << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_buffer_formation] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: collect FormationStats while forming the polygon set of
+ * test_polygon_formation_arena with and without a vertex threshold.
+ * Emitted polygons and coordinates must match the output, cuts only
+ * happen with a threshold and no vertex may stay live in the arena.
+ */
+int test_polygon_formation_stats(){
+   intDC shell_coords[] = {0,0, 10,0, 10,21, 0,21, 0,15, 3,15, 3,13,
+      0,13, 0,10, 5,10, 5,8, 0,8, 0,5, 5,5, 5,3, 0,3};
+   intDC hole_coords[] = {4,11, 7,11, 7,19, 4,19};
+   GTLPolygon shell, hole;
+   GTLPolygonSet pset;
+   CreateGTLPolygon(shell_coords, sizeof(shell_coords)/(2*sizeof(intDC)), shell);
+   CreateGTLPolygon(hole_coords, sizeof(hole_coords)/(2*sizeof(intDC)), hole);
+   pset.insert(shell);
+   pset.insert(hole, true);
+   pset.clean();
+   size_t stops = 0;
+   for(GTLPolygonSet::iterator_type itr = pset.begin(); itr != pset.end(); ++itr)
+      stops += itr == pset.begin() || (*itr).first != (*(itr - 1)).first;
+
+   for(size_t threshold=4; threshold<=8; threshold+=4){
+      size_t vthreshold = threshold == 8 ? (std::numeric_limits<size_t>::max)() : threshold;
+      boost::polygon::polygon_formation::FormationStats stats;
+      boost::polygon::polygon_formation::PolyLineArena<intDC> arena;
+      std::vector<GTLPolygon> result;
+      boost::polygon::get_polygons(result, pset.begin(), pset.end(), pset.orient(), false,
+         boost::polygon::polygon_90_with_holes_concept(), vthreshold, arena, &stats);
+      size_t coordinates = 0;
+      for(size_t i=0; i<result.size(); i++){
+         coordinates += result[i].end_compact() - result[i].begin_compact();
+         for(GTLPolygon::iterator_holes_type h = result[i].begin_holes(); h != result[i].end_holes(); ++h)
+            coordinates += (*h).end_compact() - (*h).begin_compact();
+      }
+      if(stats.polygonsEmitted != result.size() || stats.coordinatesWritten != coordinates ||
+         stats.scanStops != stops || !stats.peakTailMapSize || !stats.peakLiveVertices ||
+         (stats.thresholdCuts != 0) != (vthreshold == threshold) || arena.liveVertices() != 0){
+         std::cerr << "FAILED: unexpected stats: polygons " << stats.polygonsEmitted << "/" << result.size()
+            << " coordinates " << stats.coordinatesWritten << "/" << coordinates
+            << " stops " << stats.scanStops << " cuts " << stats.thresholdCuts
+            << " live " << arena.liveVertices() << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_formation_stats] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: form a plane with a grid of via holes, in both
+ * orientations, with polygon_90_with_holes_concept and decreasing
+ * vertex thresholds.  Results must be XOR clean, no polygon may have
+ * more vertices than the threshold, holes included, and the holes must
+ * come back as holes once a polygon can hold them.  Random rectangles
+ * with random holes must be XOR clean and bounded at any threshold, into
+ * a container of polygons with holes and into a polygon_buffer, and
+ * get_polygons must return the number of polygons it output.
+ */
+int test_polygon_formation_hole_threshold(){
+   const int columns = 20, rows = 12;
+   for(int o=0; o<2; o++){
+      boost::polygon::orientation_2d orient = o ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet pset(orient);
+      pset.insert(boost::polygon::rectangle_data<intDC>(0, 0, 10*columns, 10*rows));
+      for(int i=0; i<columns; i++)
+         for(int j=0; j<rows; j++)
+            pset.insert(boost::polygon::rectangle_data<intDC>(10*i+3, 10*j+3, 10*i+6, 10*j+6), true);
+      pset.clean();
+      size_t thresholds[] = {(std::numeric_limits<size_t>::max)(), 1000, 100, 16};
+      for(int t=0; t<4; t++){
+         std::vector<GTLPolygon> result;
+         pset.get(result, thresholds[t]);
+         size_t holes = 0, largest = 0;
+         for(size_t i=0; i<result.size(); i++){
+            size_t size = result[i].size();
+            for(GTLPolygon::iterator_holes_type h = result[i].begin_holes(); h != result[i].end_holes(); ++h)
+               size += (*h).size();
+            holes += result[i].size_holes();
+            largest = (std::max)(largest, size);
+         }
+         GTLPolygonSet check(orient);
+         check.insert(result.begin(), result.end());
+         check ^= pset;
+         if(!check.empty() || largest > thresholds[t] || (t < 3 && !holes) ||
+            (t == 0 && (result.size() != 1 || holes != (size_t)(columns*rows)))){
+            std::cerr << "FAILED: threshold " << thresholds[t] << " gave " << result.size() << " polygons, "
+               << holes << " holes, largest " << largest << std::endl;
+            return 1;
+         }
+      }
+   }
+   unsigned int state = 23;
+   for(int trial=0; trial<20; trial++){
+      GTLPolygonSet pset(trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 60, 100);
+      std::vector<boost::polygon::rectangle_data<intDC> > holes = random_rects(state, 40, 100, 5);
+      pset.insert(rects.begin(), rects.end());
+      for(size_t i=0; i<holes.size(); i++) pset.insert(holes[i], true);
+      pset.clean();
+      for(size_t threshold=4; threshold<=64; threshold*=2){
+         std::vector<GTLPolygon> result;
+         pset.get(result, threshold);
+         boost::polygon::polygon_buffer<intDC> buffer;
+         pset.get(buffer, threshold);
+         GTLPolygonSet check(pset.orient()), bufferCheck(pset.orient());
+         check.insert(result.begin(), result.end());
+         size_t largest = 0;
+         for(size_t i=0; i<buffer.size(); i++){
+            size_t size = buffer[i].size();
+            for(boost::polygon::polygon_buffer_polygon<intDC>::iterator_holes_type h = buffer[i].begin_holes();
+                h != buffer[i].end_holes(); ++h)
+               size += (*h).size();
+            largest = (std::max)(largest, size);
+            GTLPolygon poly;
+            boost::polygon::assign(poly, buffer[i]);
+            bufferCheck.insert(poly);
+         }
+         check ^= pset;
+         bufferCheck ^= pset;
+         if(!check.empty() || !bufferCheck.empty() || buffer.size() != result.size() || largest > threshold){
+            std::cerr << "FAILED: threshold " << threshold << " is not XOR clean or gave "
+               << largest << " vertices" << std::endl;
+            return 1;
+         }
+         std::vector<GTLPolygon> counted;
+         boost::polygon::polygon_buffer<intDC> countedBuffer;
+         unsigned int count = boost::polygon::get_polygons(counted, pset.begin(), pset.end(), pset.orient(), false,
+            boost::polygon::polygon_90_with_holes_concept(), threshold);
+         unsigned int bufferCount = boost::polygon::get_polygons(countedBuffer, pset.begin(), pset.end(), pset.orient(),
+            false, boost::polygon::polygon_90_with_holes_concept(), threshold);
+         if(count != counted.size() || bufferCount != countedBuffer.size()){
+            std::cerr << "FAILED: threshold " << threshold << " counted " << count << "/" << bufferCount
+               << " polygons for " << counted.size() << "/" << countedBuffer.size() << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_formation_hole_threshold] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: form a band with a 45 degree zigzag top of 400 vertices
+ * and a plane with a grid of diamond holes through
+ * polygon_45_set_data::get with decreasing vertex thresholds.  Results
+ * must be XOR clean; the band, which gains a vertex or two per scan
+ * stop, may not give a polygon of more points than the threshold, and
+ * the plane, which gains a column of holes per stop, may only exceed it
+ * by one such column.  Random 45 degree shapes with random cut outs
+ * must be XOR clean at any threshold, with holes and fractured.
+ */
+int test_polygon_45_formation_threshold(){
+   typedef boost::polygon::point_data<int> Point;
+   typedef boost::polygon::polygon_45_data<int> Polygon45;
+   typedef boost::polygon::polygon_45_with_holes_data<int> Polygon45WithHoles;
+   typedef boost::polygon::polygon_45_set_data<int> Polygon45Set;
+   const size_t unbounded = (std::numeric_limits<size_t>::max)();
+   std::vector<Point> points;
+   const int teeth = 200;
+   points.push_back(Point(0, 0));
+   points.push_back(Point(20*teeth, 0));
+   for(int i=teeth; i>0; i--){
+      points.push_back(Point(20*i, 20));
+      points.push_back(Point(20*i-10, 30));
+   }
+   points.push_back(Point(0, 20));
+   Polygon45Set band;
+   band.insert(Polygon45(points.begin(), points.end()));
+   size_t thresholds[] = {unbounded, 100, 32, 8};
+   for(int t=0; t<4; t++){
+      std::vector<Polygon45> result;
+      band.get(result, thresholds[t]);
+      size_t largest = 0;
+      for(size_t i=0; i<result.size(); i++)
+         largest = (std::max)(largest, result[i].size());
+      Polygon45Set check;
+      check.insert(result.begin(), result.end());
+      check ^= band;
+      if(!check.empty() || largest > thresholds[t] || (t == 0 && result.size() != 1)){
+         std::cerr << "FAILED: band at threshold " << thresholds[t] << " gave " << result.size()
+            << " polygons, largest " << largest << std::endl;
+         return 1;
+      }
+   }
+   const int columns = 20, rows = 12;
+   Polygon45Set plane;
+   plane.insert(boost::polygon::rectangle_data<int>(0, 0, 20*columns, 20*rows));
+   for(int i=0; i<columns; i++)
+      for(int j=0; j<rows; j++){
+         points.clear();
+         points.push_back(Point(20*i+5, 20*j+10));
+         points.push_back(Point(20*i+10, 20*j+5));
+         points.push_back(Point(20*i+15, 20*j+10));
+         points.push_back(Point(20*i+10, 20*j+15));
+         plane.insert(Polygon45(points.begin(), points.end()), true);
+      }
+   plane.clean();
+   for(int t=0; t<4; t++){
+      std::vector<Polygon45WithHoles> result;
+      plane.get(result, thresholds[t]);
+      size_t holes = 0, largest = 0;
+      for(size_t i=0; i<result.size(); i++){
+         size_t size = result[i].size();
+         for(Polygon45WithHoles::iterator_holes_type h = result[i].begin_holes(); h != result[i].end_holes(); ++h)
+            size += (*h).size();
+         holes += result[i].size_holes();
+         largest = (std::max)(largest, size);
+      }
+      Polygon45Set check;
+      check.insert(result.begin(), result.end());
+      check ^= plane;
+      if(!check.empty() || (t && largest > thresholds[t] + 5*rows*2 + 4) ||
+         (t == 0 && (result.size() != 1 || holes != (size_t)(columns*rows)))){
+         std::cerr << "FAILED: plane at threshold " << thresholds[t] << " gave " << result.size()
+            << " polygons, " << holes << " holes, largest " << largest << std::endl;
+         return 1;
+      }
+   }
+   unsigned int state = 29;
+   for(int trial=0; trial<20; trial++){
+      Polygon45Set pset;
+      for(int i=0; i<100; i++){
+         int x = next_random(state) % 100;
+         int y = next_random(state) % 100;
+         int w = 2 + next_random(state) % (i < 60 ? 30 : 8);
+         points.clear();
+         points.push_back(Point(x, y));
+         points.push_back(Point(x+w, y));
+         if(next_random(state) % 2){
+            points.push_back(Point(x+w, y+w));
+         }else{
+            points.push_back(Point(x+2*w, y+w));
+            points.push_back(Point(x+w, y+2*w));
+            points.push_back(Point(x, y+w));
+         }
+         Polygon45 shape(points.begin(), points.end());
+         if(i < 60)
+            pset.insert(shape);
+         else
+            pset.insert(shape, true);
+      }
+      pset.clean();
+      for(size_t threshold=4; threshold<=64; threshold*=2){
+         std::vector<Polygon45> fractured;
+         std::vector<Polygon45WithHoles> result;
+         pset.get(fractured, threshold);
+         pset.get(result, threshold);
+         Polygon45Set check, fracturedCheck;
+         check.insert(result.begin(), result.end());
+         fracturedCheck.insert(fractured.begin(), fractured.end());
+         check ^= pset;
+         fracturedCheck ^= pset;
+         if(!check.empty() || !fracturedCheck.empty()){
+            std::cerr << "FAILED: threshold " << threshold << " is not XOR clean" << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_45_formation_threshold] PASSED" << std::endl;
+   return 0;
+}
+
+//get the set at a vertex threshold and check that the result is XOR clean
+//with the set and has the area of the result without a threshold, which it
+//would not have if the polygons of the result overlapped
+static int check_polygon_set_threshold(const boost::polygon::polygon_set_data<int>& pset, size_t threshold){
+   typedef boost::polygon::polygon_with_holes_data<int> PolygonWithHoles;
+   std::vector<PolygonWithHoles> unbounded, result;
+   pset.get(unbounded);
+   pset.get(result, threshold);
+   double unboundedArea = 0, resultArea = 0;
+   for(size_t i=0; i<unbounded.size(); i++)
+      unboundedArea += boost::polygon::area(unbounded[i]);
+   for(size_t i=0; i<result.size(); i++)
+      resultArea += boost::polygon::area(result[i]);
+   boost::polygon::polygon_set_data<int> check;
+   check.insert(result.begin(), result.end());
+   check ^= pset;
+   if(!check.empty() || resultArea != unboundedArea){
+      std::cerr << "FAILED: threshold " << threshold << " is not XOR clean or gave area "
+         << resultArea << " for " << unboundedArea << std::endl;
+      return 1;
+   }
+   return 0;
+}
+
+/*
+ * TEST PLAN: form a discretized circle of 400 vertices and a ring with
+ * six round holes through polygon_set_data::get with decreasing
+ * vertex thresholds.  Results must be XOR clean with holes at any
+ * threshold, the circle also fractured (fracturing a hole snaps it to
+ * the grid, so the ring is not compared fractured).  The circle, which
+ * gains at most two vertices per scan stop, may not give a polygon of
+ * more than two points over the threshold.  Random shapes with random
+ * cut outs and random sets of small triangles must be XOR clean at any
+ * threshold and keep the area they have without one, so that no cut
+ * crosses the boundary of its figure.
+ */
+int test_polygon_set_formation_threshold(){
+   typedef boost::polygon::point_data<int> Point;
+   typedef boost::polygon::polygon_data<int> Polygon;
+   typedef boost::polygon::polygon_with_holes_data<int> PolygonWithHoles;
+   typedef boost::polygon::polygon_set_data<int> PolygonSet;
+   const size_t unbounded = (std::numeric_limits<size_t>::max)();
+   const double pi = 3.14159265358979323846;
+   std::vector<Point> points;
+   for(int i=0; i<400; i++)
+      points.push_back(Point((int)std::floor(10000*std::cos(2*pi*i/400) + 0.5),
+                             (int)std::floor(10000*std::sin(2*pi*i/400) + 0.5)));
+   PolygonSet disc;
+   disc.insert(Polygon(points.begin(), points.end()));
+   size_t thresholds[] = {unbounded, 100, 32, 8};
+   for(int t=0; t<4; t++){
+      std::vector<Polygon> fractured;
+      std::vector<PolygonWithHoles> result;
+      disc.get(fractured, thresholds[t]);
+      disc.get(result, thresholds[t]);
+      size_t largest = 0;
+      for(size_t i=0; i<fractured.size(); i++)
+         largest = (std::max)(largest, fractured[i].size());
+      PolygonSet check, fracturedCheck;
+      check.insert(result.begin(), result.end());
+      fracturedCheck.insert(fractured.begin(), fractured.end());
+      check ^= disc;
+      fracturedCheck ^= disc;
+      if(!check.empty() || !fracturedCheck.empty() || (t && largest > thresholds[t] + 2) ||
+         (t == 0 && fractured.size() != 1)){
+         std::cerr << "FAILED: circle at threshold " << thresholds[t] << " gave " << fractured.size()
+            << " polygons, largest " << largest << std::endl;
+         return 1;
+      }
+   }
+   PolygonSet ring = disc;
+   points.clear();
+   for(int i=0; i<300; i++)
+      points.push_back(Point((int)std::floor(7000*std::cos(2*pi*i/300) + 0.5),
+                             (int)std::floor(7000*std::sin(2*pi*i/300) + 0.5)));
+   ring -= Polygon(points.begin(), points.end());
+   for(int j=0; j<6; j++){
+      points.clear();
+      for(int i=0; i<60; i++)
+         points.push_back(Point((int)std::floor(8500*std::cos((double)j) + 700*std::cos(2*pi*i/60) + 0.5),
+                                (int)std::floor(8500*std::sin((double)j) + 700*std::sin(2*pi*i/60) + 0.5)));
+      ring -= Polygon(points.begin(), points.end());
+   }
+   size_t unboundedLargest = 0;
+   for(int t=0; t<4; t++){
+      std::vector<PolygonWithHoles> result;
+      ring.get(result, thresholds[t]);
+      size_t holes = 0, largest = 0;
+      for(size_t i=0; i<result.size(); i++){
+         size_t size = result[i].size();
+         for(PolygonWithHoles::iterator_holes_type h = result[i].begin_holes(); h != result[i].end_holes(); ++h)
+            size += (*h).size();
+         holes += result[i].size_holes();
+         largest = (std::max)(largest, size);
+      }
+      if(t == 0)
+         unboundedLargest = largest;
+      PolygonSet check;
+      check.insert(result.begin(), result.end());
+      check ^= ring;
+      if(!check.empty() || (t && largest >= unboundedLargest) ||
+         (t == 0 && (result.size() != 1 || holes != 7))){
+         std::cerr << "FAILED: ring at threshold " << thresholds[t] << " gave " << result.size()
+            << " polygons, " << holes << " holes, largest " << largest << std::endl;
+         return 1;
+      }
+   }
+   unsigned int state = 31;
+   for(int trial=0; trial<20; trial++){
+      PolygonSet pset;
+      for(int i=0; i<60; i++){
+         points.clear();
+         int x = next_random(state) % 200;
+         int y = next_random(state) % 200;
+         int n = 3 + next_random(state) % 6;
+         for(int k=0; k<n; k++){
+            int dx = (int)(next_random(state) % 80) - 40;
+            int dy = (int)(next_random(state) % 80) - 40;
+            points.push_back(Point(x + dx, y + dy));
+         }
+         Polygon shape(points.begin(), points.end());
+         if(i < 45)
+            pset.insert(shape);
+         else
+            pset -= shape;
+      }
+      pset.clean();
+      for(size_t threshold=4; threshold<=64; threshold*=2)
+         if(check_polygon_set_threshold(pset, threshold))
+            return 1;
+   }
+   //small triangles that overlap a lot, so that edges often start and end
+   //between the two edges of a solid interval
+   for(int trial=0; trial<1000; trial++){
+      PolygonSet pset;
+      for(int i=0; i<8; i++){
+         points.clear();
+         for(int k=0; k<3; k++){
+            int x = next_random(state) % 20;
+            points.push_back(Point(x, next_random(state) % 20));
+         }
+         pset.insert(Polygon(points.begin(), points.end()));
+      }
+      pset.clean();
+      for(size_t threshold=4; threshold<=16; threshold+=2)
+         if(check_polygon_set_threshold(pset, threshold))
+            return 1;
+   }
+   std::cout << "[test_polygon_set_formation_threshold] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: compact random rectangle sets of both orientations and check
+ * that the packed vertices are the vertices of the clean set in less
+ * memory, and that get, get_rectangles, move and the booleans against
+ * compacted and plain sets give what they give on the plain set.
+ * Reading a compacted set through a const reference must leave it packed,
+ * also as the right operand of +=, |= and -=, and expand must give back
+ * the vertex vector. A set that is modified
+ * after compacting must unpack and stay correct.
+ */
+int test_polygon_90_compact_set(){
+   unsigned int state = 23;
+   for(int trial=0; trial<8; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet pset(orient), other(orient);
+      std::vector<boost::polygon::rectangle_data<intDC> > drawn = random_rects(state, 400, 300);
+      for(size_t i=0; i<drawn.size(); i++) (i % 2 ? pset : other).insert(drawn[i]);
+      pset.clean();
+      other.clean();
+      GTLPolygonSet packed(pset), packedOther(other);
+      if(!packed.compact() || !packed.compacted() || !packedOther.compact() ||
+         packed.size() != pset.size() || packed.empty() ||
+         packed.memory() * 10 > pset.size() * sizeof(std::pair<intDC, std::pair<intDC, int> >) * 7 ||
+         !std::equal(packed.begin_compact(), packed.end_compact(), pset.begin())){
+         std::cerr << "FAILED: packed vertices differ from the clean set" << std::endl;
+         return 1;
+      }
+      std::vector<GTLPolygon> gold, result;
+      std::vector<boost::polygon::rectangle_data<intDC> > goldRects, rects;
+      pset.get(gold);
+      packed.get(result);
+      pset.get_rectangles(goldRects);
+      packed.get_rectangles(rects);
+      GTLPolygonSet check(orient);
+      check.insert(result.begin(), result.end());
+      if(result.size() != gold.size() || check != pset || goldRects != rects || !packed.compacted()){
+         std::cerr << "FAILED: get on the packed set differs" << std::endl;
+         return 1;
+      }
+      GTLPolygonSet goldOr(pset | other), goldAnd(pset & other), goldNot(pset - other), goldXor(pset ^ other);
+      if(GTLPolygonSet(packed | packedOther) != goldOr || GTLPolygonSet(packed & other) != goldAnd ||
+         GTLPolygonSet(pset - packedOther) != goldNot || GTLPolygonSet(packed ^ packedOther) != goldXor ||
+         GTLPolygonSet(packedOther - packed) != GTLPolygonSet(other - pset) ||
+         !packed.compacted() || !packedOther.compacted()){
+         std::cerr << "FAILED: booleans on the packed set differ" << std::endl;
+         return 1;
+      }
+      GTLPolygonSet moved(pset);
+      moved.move(7, -3);
+      packed.move(7, -3);
+      if(!packed.compacted() || packed != moved){
+         std::cerr << "FAILED: move of the packed set differs" << std::endl;
+         return 1;
+      }
+      const GTLPolygonSet& reader = packed;
+      boost::polygon::rectangle_data<intDC> box, goldBox;
+      GTLPolygonSet copied(orient);
+      copied.insert(reader);
+      if(!reader.extents(box) || !moved.extents(goldBox) || box != goldBox || !(reader == moved) ||
+         !(moved == reader) || copied != moved || boost::polygon::area(reader) != boost::polygon::area(moved) ||
+         reader.capacity() < reader.size() || !packed.compacted()){
+         std::cerr << "FAILED: reading the packed set differs or unpacks it" << std::endl;
+         return 1;
+      }
+      boost::polygon::orientation_2d across = orient == boost::polygon::HORIZONTAL ?
+         boost::polygon::VERTICAL : boost::polygon::HORIZONTAL;
+      GTLPolygonSet added(other), ored(other), oredAcross(across), subtracted(other);
+      oredAcross.insert(other);
+      added += reader;
+      ored |= reader;
+      oredAcross |= reader;
+      subtracted -= reader;
+      if(added != GTLPolygonSet(other | moved) || ored != GTLPolygonSet(other | moved) ||
+         GTLPolygonSet(orient, oredAcross) != GTLPolygonSet(other | moved) ||
+         subtracted != GTLPolygonSet(other - moved) ||
+         (size_t)std::distance(boost::polygon::begin_90_set_data(reader), boost::polygon::end_90_set_data(reader)) !=
+         moved.size() || !packed.compacted()){
+         std::cerr << "FAILED: the packed set as the right operand differs" << std::endl;
+         return 1;
+      }
+      packed.expand();
+      if(packed.compacted() || packed.value() != moved.value() || !packed.compact()){
+         std::cerr << "FAILED: expand of the packed set differs" << std::endl;
+         return 1;
+      }
+      packed.move(-7, 3);
+      packed.insert(boost::polygon::rectangle_data<intDC>(-50, -50, 10, 10));
+      pset.insert(boost::polygon::rectangle_data<intDC>(-50, -50, 10, 10));
+      if(packed.compacted() || packed != pset){
+         std::cerr << "FAILED: insert into the packed set differs" << std::endl;
+         return 1;
+      }
+      packedOther |= packed;
+      if(packedOther != GTLPolygonSet(other | pset)){
+         std::cerr << "FAILED: self assignment boolean on the packed set differs" << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_90_compact_set] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: polygon_sort radix sorts vertex and half edge data on integer
+ * coordinates. Sort random data of sizes on both sides of the cutoff to
+ * std::sort, with extreme coordinates and counts other than +1 and -1, on
+ * one and on all hardware threads, and compare with std::sort.
+ */
+int test_polygon_radix_sort(){
+   typedef std::pair<intDC, std::pair<intDC, int> > vertex;
+   typedef std::pair<std::pair<GTLPoint, GTLPoint>, int> half_edge;
+   unsigned int state = 29;
+   int sizes[] = {0, 1, 100, 1023, 1024, 5000, 70000};
+   for(int threads=0; threads<2; threads++){
+      boost::polygon::polygon_sort_threads() = threads;
+      for(int i=0; i<7; i++){
+         std::vector<vertex> vertices(sizes[i]);
+         std::vector<half_edge> edges(sizes[i]);
+         for(int j=0; j<sizes[i]; j++){
+            int x = (int)next_random(state) - (1 << 23);
+            int y = next_random(state) % 3000;
+            unsigned int r = next_random(state);
+            int count = r % 7 ? (r % 2 ? 1 : -1) : (int)(r % 5) - 2;
+            vertices[j] = vertex(x, std::pair<intDC, int>(y, count));
+            edges[j] = half_edge(std::make_pair(GTLPoint(y % 50, x % 50), GTLPoint(x % 7, y)), count);
+         }
+         if(sizes[i] > 100){
+            vertices[17].first = (std::numeric_limits<intDC>::min)();
+            vertices[42].first = (std::numeric_limits<intDC>::max)();
+            edges[17].first.second = GTLPoint((std::numeric_limits<intDC>::min)(), (std::numeric_limits<intDC>::max)());
+         }
+         std::vector<vertex> goldVertices(vertices);
+         std::vector<half_edge> goldEdges(edges);
+         std::sort(goldVertices.begin(), goldVertices.end());
+         std::sort(goldEdges.begin(), goldEdges.end());
+         boost::polygon::polygon_sort(vertices.begin(), vertices.end());
+         boost::polygon::polygon_sort(edges.begin(), edges.end());
+         if(vertices != goldVertices || edges != goldEdges){
+            std::cerr << "FAILED: radix sort of " << sizes[i] << " elements differs from std::sort" << std::endl;
+            return 1;
+         }
+      }
+   }
+   boost::polygon::polygon_sort_threads() = 1;
+   std::cout << "[test_polygon_radix_sort] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: insert a few rectangles, holes and loose vertices into clean
+ * random sets of both orientations, some of them compacted, and check that
+ * clean() and sort(), which only sort and rescan the inserted part, give the
+ * same vertices as cleaning the same data from scratch.
+ */
+int test_polygon_90_incremental_clean(){
+   unsigned int state = 31;
+   for(int trial=0; trial<60; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet pset(orient);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 300, 300, 20);
+      pset.insert(rects.begin(), rects.end());
+      pset.clean();
+      if(trial % 4 == 0) pset.compact();
+      for(int round=0; round<3; round++){
+         std::vector<boost::polygon::rectangle_data<intDC> > inserted = random_rects(state, 1+trial%9, 300, 20);
+         for(size_t i=0; i<inserted.size(); i++) pset.insert(inserted[i], trial % 3 == 0 && i % 2);
+         if(trial % 5 == 0)
+            pset.insert(std::make_pair((intDC)(next_random(state) % 300), std::make_pair((intDC)(next_random(state) % 301), 1)));
+         GTLPolygonSet scratch(orient);
+         scratch.insert(pset.begin(), pset.end(), orient);
+         if(round == 1){
+            GTLPolygonSet sorted(pset);
+            sorted.sort();
+            scratch.sort();
+            if(sorted.value() != scratch.value()){
+               std::cerr << "FAILED: sort of the inserted vertices differs" << std::endl;
+               return 1;
+            }
+         }
+         pset.clean();
+         scratch.clean();
+         if(pset.value() != scratch.value()){
+            std::cerr << "FAILED: incremental clean differs in trial " << trial << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_90_incremental_clean] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: BooleanOpFlat must produce the output of BooleanOp for any sequence
+ * of scan stops.  Drive both with the same random stops of sorted disjoint
+ * intervals, first many intervals per stop, then a long scanline with one
+ * interval per stop so that BooleanOpFlat moves over to the map halfway.
+ */
+int test_polygon_boolean_flat_scan(){
+   typedef boost::polygon::interval_data<intDC> Interval;
+   typedef std::vector<std::pair<Interval, int> > Output;
+   unsigned int state = 17;
+   for(int trial=0; trial<2; trial++){
+      boost::polygon::boolean_op::BooleanOp<int, intDC> tree(0);
+      boost::polygon::boolean_op::BooleanOpFlat<int, intDC> flat(0);
+      Output treeOutput, flatOutput;
+      for(int stop=0; stop<400; stop++){
+         int numIntervals = trial == 0 || stop == 0 ? 5000 : 1;
+         int step = trial == 0 || stop == 0 ? 4 : 20000;
+         intDC pos = 0;
+         for(int i=0; i<numIntervals; i++){
+            pos += next_random(state) % step;
+            intDC high = pos + 1 + next_random(state) % step;
+            int delta = (int)(next_random(state) % 5) - 2;
+            if(delta == 0) delta = 1;
+            tree.processInterval(treeOutput, Interval(pos, high), delta);
+            flat.processInterval(flatOutput, Interval(pos, high), delta);
+            pos = high;
+         }
+         tree.advanceScan();
+         flat.advanceScan();
+         if(treeOutput != flatOutput){
+            std::cerr << "FAILED: flat scanline output differs at stop " << stop << " of trial " << trial << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::cout << "[test_polygon_boolean_flat_scan] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: applyBooleanNaryOp over several layers of random grid aligned
+ * rectangles must give the set of the unit cells the predicate holds on, with
+ * the cell counts taken rectangle by rectangle.  Some layers are compacted,
+ * dirty or of the other orientation, and a stateful predicate and a custom
+ * one are used besides NaryAny and NaryAll.
+ */
+class OddLayerCount {
+public:
+   bool operator()(const std::vector<int>& counts) const {
+      int covered = 0;
+      for(std::size_t i = 0; i < counts.size(); i++) covered += counts[i] > 0;
+      return covered % 2 == 1;
+   }
+};
+
+template <typename predicate_type>
+int check_polygon_90_nary_op(const std::vector<GTLPolygonSet>& layers,
+                             const std::vector<std::vector<int> >& cells,
+                             const predicate_type& predicate, int side, const char* name){
+   GTLPolygonSet result(boost::polygon::HORIZONTAL);
+   result.applyBooleanNaryOp(layers.begin(), layers.end(), predicate);
+   GTLPolygonSet expected(boost::polygon::HORIZONTAL);
+   std::vector<int> counts(layers.size());
+   for(int x=0; x<side; x++){
+      for(int y=0; y<side; y++){
+         for(std::size_t l=0; l<layers.size(); l++) counts[l] = cells[l][x*side+y];
+         if(predicate(counts)) expected.insert(boost::polygon::rectangle_data<intDC>(x, y, x+1, y+1));
+      }
+   }
+   expected.clean();
+   if(result.value() != expected.value()){
+      std::cerr << "FAILED: n-ary " << name << " differs from the cell counts" << std::endl;
+      return 1;
+   }
+   return 0;
+}
+
+int test_polygon_90_nary_op(){
+   const int side = 40;
+   unsigned int state = 5;
+   for(int trial=0; trial<20; trial++){
+      std::size_t numLayers = 1 + trial % 7;
+      std::vector<GTLPolygonSet> layers;
+      std::vector<std::vector<int> > cells(numLayers, std::vector<int>(side*side, 0));
+      for(std::size_t l=0; l<numLayers; l++){
+         layers.push_back(GTLPolygonSet(l % 3 == 2 ? boost::polygon::VERTICAL : boost::polygon::HORIZONTAL));
+         for(int i=0; i<8; i++){
+            int x = next_random(state) % (side - 1);
+            int y = next_random(state) % (side - 1);
+            int xh = x + 1 + next_random(state) % (side - x - 1 > 10 ? 10 : side - x - 1);
+            int yh = y + 1 + next_random(state) % (side - y - 1 > 10 ? 10 : side - y - 1);
+            layers.back().insert(boost::polygon::rectangle_data<intDC>(x, y, xh, yh));
+            for(int cx=x; cx<xh; cx++)
+               for(int cy=y; cy<yh; cy++) cells[l][cx*side+cy]++;
+         }
+         if(l % 3 == 1){
+            layers.back().clean();
+            layers.back().compact();
+         }
+      }
+      if(check_polygon_90_nary_op(layers, cells, boost::polygon::boolean_op::NaryAny(), side, "any") ||
+         check_polygon_90_nary_op(layers, cells, boost::polygon::boolean_op::NaryAll(), side, "all") ||
+         check_polygon_90_nary_op(layers, cells, boost::polygon::boolean_op::NaryAtLeast(2), side, "at least 2") ||
+         check_polygon_90_nary_op(layers, cells, OddLayerCount(), side, "odd"))
+         return 1;
+   }
+   GTLPolygonSet layer(boost::polygon::HORIZONTAL), other(boost::polygon::HORIZONTAL);
+   layer.insert(boost::polygon::rectangle_data<intDC>(0, 0, 10, 10));
+   other.insert(boost::polygon::rectangle_data<intDC>(5, 5, 20, 20));
+   std::vector<GTLPolygonSet> pair;
+   pair.push_back(layer);
+   pair.push_back(other);
+   GTLPolygonSet expected(layer & other);
+   layer.applyBooleanNaryOp(pair.begin(), pair.end(), boost::polygon::boolean_op::NaryAll());
+   if(layer.value() != expected.value()){
+      std::cerr << "FAILED: n-ary intersection into an input differs" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_polygon_90_nary_op] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: a view with views among its arguments is evaluated in one fused
+ * sweep.  Expressions over random layers, some compacted, of the other
+ * orientation or vectors of rectangles, must equal the same booleans done one
+ * at a time through intermediate sets.
+ */
+int test_polygon_90_fused_view(){
+   unsigned int state = 11;
+   for(int trial=0; trial<30; trial++){
+      GTLPolygonSet layers[4];
+      std::vector<boost::polygon::rectangle_data<intDC> > rects;
+      for(int l=0; l<5; l++){
+         std::vector<boost::polygon::rectangle_data<intDC> > drawn = random_rects(state, 30, 200, 40);
+         if(l < 4){
+            layers[l] = GTLPolygonSet(l == 3 && trial % 2 ? boost::polygon::VERTICAL : boost::polygon::HORIZONTAL);
+            layers[l].insert(drawn.begin(), drawn.end());
+         } else {
+            rects = drawn;
+         }
+      }
+      if(trial % 3 == 0){
+         layers[1].clean();
+         layers[1].compact();
+      }
+      GTLPolygonSet ab(layers[0] | layers[1]), cd(layers[2] - layers[3]);
+      GTLPolygonSet expected(ab & cd), fused((layers[0] | layers[1]) & (layers[2] - layers[3]));
+      if(fused.value() != expected.value()){
+         std::cerr << "FAILED: fused (a | b) & (c - d) differs in trial " << trial << std::endl;
+         return 1;
+      }
+      GTLPolygonSet x(layers[0] ^ layers[1]), y(layers[2] & layers[3]), z(x - y);
+      expected = z | rects;
+      fused = ((layers[0] ^ layers[1]) - (layers[2] & layers[3])) | rects;
+      if(fused.value() != expected.value()){
+         std::cerr << "FAILED: fused ((a ^ b) - (c & d)) | e differs in trial " << trial << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_90_fused_view] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: the boolean on tiles must be byte for byte the serial one.  Run
+ * every boolean of random sets, one of them compacted, through
+ * applyBooleanBinaryOpInTiles with several tile counts and compare the vertex
+ * vectors, then through polygon_90_set_data with polygon_boolean_threads set.
+ */
+template <typename op_type>
+int check_polygon_boolean_tiles(const GTLPolygonSet& a, const GTLPolygonSet& b, const char* name){
+   typedef std::vector<std::pair<intDC, std::pair<intDC, int> > > Vertices;
+   boost::polygon::boolean_op::BinaryCount<op_type> count;
+   Vertices serial;
+   boost::polygon::boolean_op::applyBooleanBinaryOp(serial, a.begin_compact(), a.end_compact(),
+                                                    b.begin(), b.end(), count);
+   for(std::size_t numTiles=1; numTiles<12; numTiles+=3){
+      Vertices tiled;
+      boost::polygon::boolean_op::applyBooleanBinaryOpInTiles(tiled, a.begin_compact(), a.end_compact(),
+                                                               b.begin(), b.end(), count, numTiles, 3);
+      if(tiled != serial){
+         std::cerr << "FAILED: " << name << " on " << numTiles << " tiles differs from the serial one" << std::endl;
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int test_polygon_boolean_tiles(){
+   unsigned int state = 7;
+   for(int trial=0; trial<6; trial++){
+      GTLPolygonSet a, b;
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 3000, 5000, 100);
+      for(size_t i=0; i<rects.size(); i++){
+         //the later trials stretch the rectangles across most of the tiles
+         if(trial >= 3)
+            boost::polygon::xh(rects[i], boost::polygon::xl(rects[i]) + 1 + next_random(state) % 5000);
+         if(i % 2) a.insert(rects[i]);
+         else b.insert(rects[i]);
+      }
+      a.clean();
+      a.compact();
+      b.clean();
+      if(check_polygon_boolean_tiles<boost::polygon::boolean_op::BinaryOr>(a, b, "or") ||
+         check_polygon_boolean_tiles<boost::polygon::boolean_op::BinaryAnd>(a, b, "and") ||
+         check_polygon_boolean_tiles<boost::polygon::boolean_op::BinaryXor>(a, b, "xor") ||
+         check_polygon_boolean_tiles<boost::polygon::boolean_op::BinaryNot>(a, b, "not"))
+         return 1;
+      GTLPolygonSet serial(a - b);
+      boost::polygon::polygon_boolean_threads() = 0;
+      GTLPolygonSet threaded(a - b);
+      boost::polygon::polygon_boolean_threads() = 1;
+      if(threaded.value() != serial.value()){
+         std::cerr << "FAILED: threaded boolean differs from the serial one" << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_boolean_tiles] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: the external set must agree with the in memory one.  Insert
+ * random rectangles into both with a buffer of the least size, so that they
+ * spill many runs, then compare the clean vertices, a boolean of two external
+ * sets and the polygons formed from a set against polygon_90_set_data.  The
+ * set get fills must take the orientation of the external set and be clean.
+ */
+int test_polygon_90_external_set(){
+   typedef boost::polygon::polygon_90_external_set_data<intDC> ExternalSet;
+   unsigned int state = 11;
+   for(int trial=0; trial<4; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::VERTICAL : boost::polygon::HORIZONTAL;
+      GTLPolygonSet a(orient), b(orient);
+      ExternalSet externalA(orient, 0), externalB(orient, 0);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 4000, 3000, 60);
+      for(size_t i=0; i<rects.size(); i++){
+         if(i % 3){
+            a.insert(rects[i]);
+            externalA.insert(rects[i]);
+         } else {
+            b.insert(rects[i]);
+            externalB.insert(rects[i]);
+         }
+      }
+      //the output of get takes the orientation of the external set and is left clean
+      GTLPolygonSet result(orient.get_perpendicular());
+      result.insert(rects[0]);
+      externalA.get(result);
+      if(result.orient() != orient || result.dirty() || !result.sorted()){
+         std::cerr << "FAILED: get leaves the wrong orientation or a dirty set in trial " << trial << std::endl;
+         return 1;
+      }
+      a.clean();
+      if(result.value() != a.value() || externalA.size() != a.size()){
+         std::cerr << "FAILED: clean external set differs in trial " << trial << std::endl;
+         return 1;
+      }
+      ExternalSet externalC(orient, 0);
+      externalC.applyBooleanBinaryOp(externalA, externalB, boost::polygon::boolean_op::BinaryCount<boost::polygon::boolean_op::BinaryXor>());
+      externalC.get(result);
+      GTLPolygonSet expected(a ^ b);
+      if(result.value() != expected.value()){
+         std::cerr << "FAILED: external xor differs in trial " << trial << std::endl;
+         return 1;
+      }
+      externalA.applyBooleanBinaryOp(externalA, externalB, boost::polygon::boolean_op::BinaryCount<boost::polygon::boolean_op::BinaryNot>());
+      externalA.get(result);
+      expected = a - b;
+      if(result.value() != expected.value()){
+         std::cerr << "FAILED: external not into its first input differs in trial " << trial << std::endl;
+         return 1;
+      }
+      std::vector<boost::polygon::polygon_90_data<intDC> > polygons, externalPolygons;
+      expected.get(polygons);
+      externalA.get(externalPolygons);
+      if(polygons != externalPolygons){
+         std::cerr << "FAILED: polygons of the external set differ in trial " << trial << std::endl;
+         return 1;
+      }
+   }
+   ExternalSet empty;
+   GTLPolygonSet result;
+   empty.get(result);
+   if(!empty.empty() || !result.empty()){
+      std::cerr << "FAILED: empty external set is not empty" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_polygon_90_external_set] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: a set written in the binary format must come back as it was.
+ * Round trip clean 90, 45 and arbitrary sets through a stream and through
+ * an image of the file in memory, which must load them clean, form the
+ * polygons of the 90 set from the image in place, load windows of chunks
+ * that must equal the set clipped to them, and reject a damaged header or
+ * chunk index in a stream and in an image.
+ */
+template <typename set_type>
+bool polygon_set_file_rejected(const std::string& bytes){
+   int rejected = 0;
+   std::stringstream stream(bytes);
+   set_type set;
+   try {
+      boost::polygon::read_polygon_set(stream, set);
+   } catch(const std::runtime_error&) {
+      ++rejected;
+   }
+   std::vector<polygon_ulong_long_type> memory(bytes.size() / sizeof(polygon_ulong_long_type) + 1);
+   std::memcpy(&memory[0], bytes.data(), bytes.size());
+   try {
+      boost::polygon::polygon_set_image<set_type> image(&memory[0], bytes.size());
+   } catch(const std::runtime_error&) {
+      ++rejected;
+   }
+   return rejected == 2;
+}
+
+template <typename set_type>
+int check_polygon_set_round_trip(const set_type& set, std::size_t chunk_size, const char* name){
+   std::stringstream stream;
+   boost::polygon::write_polygon_set(stream, set, chunk_size);
+   set_type read;
+   boost::polygon::read_polygon_set(stream, read);
+   std::string bytes = stream.str();
+   std::vector<polygon_ulong_long_type> memory(bytes.size() / sizeof(polygon_ulong_long_type) + 1);
+   std::memcpy(&memory[0], bytes.data(), bytes.size());
+   boost::polygon::polygon_set_image<set_type> image(&memory[0], bytes.size());
+   set_type loaded;
+   image.load(loaded);
+   if(read.value() != set.value() || loaded.value() != set.value() || read.dirty() != set.dirty() ||
+      loaded.dirty() != set.dirty() || (std::size_t)(image.end() - image.begin()) != set.value().size()){
+      std::cerr << "FAILED: " << name << " set round trip" << std::endl;
+      return 1;
+   }
+   return 0;
+}
+
+int test_polygon_set_serialization(){
+   typedef boost::polygon::polygon_set_image<GTLPolygonSet> Image;
+   unsigned int state = 13;
+   for(int trial=0; trial<4; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::VERTICAL : boost::polygon::HORIZONTAL;
+      GTLPolygonSet set(orient);
+      std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 2000, 3000, 80);
+      set.insert(rects.begin(), rects.end());
+      set.clean();
+      if(check_polygon_set_round_trip(set, 97, "90"))
+         return 1;
+      std::stringstream stream;
+      boost::polygon::write_polygon_set(stream, set, 97);
+      std::string bytes = stream.str();
+      std::vector<polygon_ulong_long_type> memory(bytes.size() / sizeof(polygon_ulong_long_type) + 1);
+      std::memcpy(&memory[0], bytes.data(), bytes.size());
+      Image image(&memory[0], bytes.size());
+      std::vector<boost::polygon::polygon_90_data<intDC> > polygons, imagePolygons;
+      set.get(polygons);
+      boost::polygon::get_polygons(imagePolygons, image.begin(), image.end(), image.orient(), true,
+                                   boost::polygon::polygon_90_concept());
+      if(polygons != imagePolygons || image.chunks() < 10){
+         std::cerr << "FAILED: polygons of the image differ in trial " << trial << std::endl;
+         return 1;
+      }
+      for(int window=0; window<6; window++){
+         intDC low = next_random(state) % 3200 - 100;
+         intDC high = low + window * 300;
+         GTLPolygonSet part;
+         image.load(part, low, high);
+         std::pair<std::size_t, std::size_t> chunks = image.chunks(low, high);
+         intDC xl = chunks.first < chunks.second ? image.chunk(chunks.first).major : 0;
+         intDC xh = chunks.second < image.chunks() ? image.chunk(chunks.second).major : 4000;
+         GTLPolygonSet clip(orient);
+         if(orient == boost::polygon::VERTICAL)
+            clip.insert(boost::polygon::rectangle_data<intDC>(xl, -1, xh, 4000));
+         else
+            clip.insert(boost::polygon::rectangle_data<intDC>(-1, xl, 4000, xh));
+         GTLPolygonSet expected(set & clip);
+         if(chunks.first == chunks.second)
+            expected.clear();
+         if(part.dirty() || part.value() != expected.value() || part.orient() != orient){
+            std::cerr << "FAILED: window " << low << ", " << high << " differs in trial " << trial << std::endl;
+            return 1;
+         }
+      }
+      GTLPolygonSet dirty(orient);
+      dirty.insert(boost::polygon::rectangle_data<intDC>(0, 0, 10, 10));
+      dirty.insert(boost::polygon::rectangle_data<intDC>(5, 5, 20, 20));
+      if(check_polygon_set_round_trip(dirty, 97, "dirty 90"))
+         return 1;
+   }
+   typedef boost::polygon::point_data<int> Point;
+   std::vector<Point> points;
+   points.push_back(Point(0, 0));
+   points.push_back(Point(100, 0));
+   points.push_back(Point(150, 50));
+   points.push_back(Point(100, 100));
+   points.push_back(Point(0, 100));
+   boost::polygon::polygon_45_set_data<int> set45;
+   set45.insert(boost::polygon::polygon_45_data<int>(points.begin(), points.end()));
+   set45.insert(boost::polygon::rectangle_data<int>(50, 50, 300, 80));
+   set45.clean();
+   points[2] = Point(170, 30);
+   boost::polygon::polygon_set_data<int> set;
+   set.insert(boost::polygon::polygon_data<int>(points.begin(), points.end()));
+   set.insert(boost::polygon::rectangle_data<int>(50, 50, 300, 80));
+   set.clean();
+   if(check_polygon_set_round_trip(set45, 3, "45") || check_polygon_set_round_trip(set, 3, "arbitrary"))
+      return 1;
+   std::stringstream stream;
+   boost::polygon::write_polygon_set(stream, set);
+   std::string bytes = stream.str();
+   bytes[0] = 'X';
+   if(!polygon_set_file_rejected<boost::polygon::polygon_set_data<int> >(bytes)){
+      std::cerr << "FAILED: damaged header was read" << std::endl;
+      return 1;
+   }
+   GTLPolygonSet set90;
+   std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 200, 1000, 50);
+   set90.insert(rects.begin(), rects.end());
+   set90.clean();
+   std::stringstream stream90;
+   boost::polygon::write_polygon_set(stream90, set90, 10);
+   bytes = stream90.str();
+   boost::polygon::polygon_set_file_header header;
+   std::memcpy(&header, bytes.data(), sizeof(header));
+   typedef boost::polygon::polygon_set_file_chunk<intDC> Chunk;
+   for(int damage=0; damage<3; damage++){
+      std::string damaged = bytes;
+      std::size_t offset = sizeof(header) + (std::size_t)(header.chunk_count / 2) * sizeof(Chunk);
+      Chunk chunk;
+      std::memcpy(&chunk, damaged.data() + offset, sizeof(chunk));
+      if(damage == 0)
+         chunk.begin = header.element_count;
+      else if(damage == 1)
+         chunk.profile_end = header.profile_count + 1;
+      else
+         chunk.profile_begin = chunk.profile_end + 1;
+      std::memcpy(&damaged[offset], &chunk, sizeof(chunk));
+      if(header.chunk_count < 4 || !polygon_set_file_rejected<GTLPolygonSet>(damaged)){
+         std::cerr << "FAILED: damaged chunk index was read, damage " << damage << std::endl;
+         return 1;
+      }
+   }
+   if(polygon_set_file_rejected<GTLPolygonSet>(bytes)){
+      std::cerr << "FAILED: intact chunk index was rejected" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_polygon_set_serialization] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: the text readers must read what the iostream parsers read.
+ * Parse a generated layout of many layers and pin records serially and on
+ * threads and compare each layer with the rectangles inserted one by one,
+ * parse a points and segments file, and check that malformed and out of
+ * range integers throw with their line.
+ */
+int test_polygon_text_reader(){
+   typedef std::map<std::string, GTLPolygonSet> Layers;
+   const char* names[] = {"NWELL", "PDIFF", "NDIFF", "POLY", "METAL1"};
+   std::string text;
+   Layers expected;
+   unsigned int state = 17;
+   std::vector<boost::polygon::rectangle_data<intDC> > rects = random_rects(state, 20000, 5000, 40);
+   for(int i=0; i<20000; i++){
+      int x = boost::polygon::xl(rects[i]) - 2500, y = boost::polygon::yl(rects[i]);
+      int w = boost::polygon::delta(rects[i], boost::polygon::HORIZONTAL);
+      int h = boost::polygon::delta(rects[i], boost::polygon::VERTICAL);
+      const char* layer = names[(i / 7 + next_random(state)) % 5];
+      std::stringstream line;
+      line << (i % 3 ? "Rectangle " : "Rectangle\t") << x << " " << x+w << " " << y << " +" << y+h << " " << layer << "\n";
+      if(i % 50 == 0)
+         line << "Pin " << x << " " << x+1 << " " << y << " " << y+1 << " " << layer << " net" << i << "\r\n";
+      text += line.str();
+      expected[layer].insert(boost::polygon::rectangle_data<intDC>(x, y, x+w, y+h));
+   }
+   for(std::size_t threads=1; threads<4; threads+=2){
+      Layers layers;
+      boost::polygon::parse_layout_rectangles(text.data(), text.data() + text.size(), layers, threads);
+      if(layers.size() != expected.size()){
+         std::cerr << "FAILED: layout read " << layers.size() << " layers" << std::endl;
+         return 1;
+      }
+      for(Layers::iterator itr = layers.begin(); itr != layers.end(); ++itr){
+         itr->second.clean();
+         expected[itr->first].clean();
+         if(itr->second.value() != expected[itr->first].value()){
+            std::cerr << "FAILED: layer " << itr->first << " read on " << threads << " threads differs" << std::endl;
+            return 1;
+         }
+      }
+   }
+   std::string input = "3\n0 0\n-2147483645 7\n1 +2\n\n1\n0 0 3 4\n";
+   std::vector<boost::polygon::point_data<int> > points;
+   std::vector<boost::polygon::segment_data<int> > segments;
+   boost::polygon::parse_points_and_segments(input.data(), input.data() + input.size(), points, segments);
+   if(points.size() != 3 || points[1] != boost::polygon::point_data<int>(-2147483645, 7) ||
+      points[2] != boost::polygon::point_data<int>(1, 2) || segments.size() != 1 ||
+      boost::polygon::high(segments[0]) != boost::polygon::point_data<int>(3, 4)){
+      std::cerr << "FAILED: points and segments read wrong" << std::endl;
+      return 1;
+   }
+   const char* malformed[] = {"Rectangle 0 1 0 1 M1\nPin 0 1 0 1 M1 a\nRectangle 0 1 x 4 M1\n",
+                              "Rectangle 0 1 0 1 M1\nRectangle 0 1 0 1\nRectangle 0 1 0 3000000000 M1\n",
+                              "Rectangle 0 1 0 1 M1\nRectangle 0 1 2.5 4 M1\n\n"};
+   const char* lines[] = {"line 3", "line 2", "line 2"};
+   for(int i=0; i<3; i++){
+      Layers layers;
+      std::string message;
+      try {
+         boost::polygon::parse_layout_rectangles(malformed[i], malformed[i] + std::strlen(malformed[i]), layers);
+      } catch(const std::runtime_error& error) {
+         message = error.what();
+      }
+      if(message.find(lines[i]) == std::string::npos){
+         std::cerr << "FAILED: malformed layout " << i << " gave \"" << message << "\"" << std::endl;
+         return 1;
+      }
+   }
+   std::cout << "[test_polygon_text_reader] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: slice random rectangle sets of both orientations into
+ * rectangles into a container and through a sink. Both must give the
+ * same rectangles, which must be XOR clean with the set and add up to
+ * its area. Splice runs of a FlatTailMap, some across blocks, and
+ * check it against a std::map.
+ */
+struct GTLRectangleSink {
+   std::vector<boost::polygon::rectangle_data<intDC> >& rects_;
+   GTLRectangleSink(std::vector<boost::polygon::rectangle_data<intDC> >& rects) : rects_(rects) {}
+   void operator()(const boost::polygon::rectangle_data<intDC>& rect){
+      rects_.push_back(rect);
+   }
+};
+
+int test_rectangle_formation_sink(){
+   typedef boost::polygon::rectangle_data<intDC> Rect;
+   unsigned int state = 13;
+   for(int trial=0; trial<6; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::VERTICAL : boost::polygon::HORIZONTAL;
+      GTLPolygonSet pset(orient);
+      std::vector<Rect> drawn = random_rects(state, 500, 400, 40);
+      for(size_t i=0; i<drawn.size(); i++) pset.insert(drawn[i], i % 5 == 4);
+      std::vector<Rect> rects, streamed;
+      pset.get_rectangles(rects);
+      GTLRectangleSink sink(streamed);
+      pset.get_rectangles_to_sink(sink);
+      if(rects.empty() || rects != streamed){
+         std::cerr << "FAILED: streamed rectangles differ in trial " << trial << std::endl;
+         return 1;
+      }
+      GTLPolygonSet result(orient);
+      long long total = 0;
+      for(size_t i=0; i<rects.size(); i++){
+         result.insert(rects[i]);
+         total += boost::polygon::area(rects[i]);
+      }
+      if(total != (long long)boost::polygon::area(pset)){
+         std::cerr << "FAILED: rectangles overlap in trial " << trial << std::endl;
+         return 1;
+      }
+      result ^= pset;
+      if(!result.empty()){
+         std::cerr << "FAILED: rectangles are not XOR clean in trial " << trial << std::endl;
+         return 1;
+      }
+   }
+   typedef boost::polygon::polygon_formation::FlatTailMap<int, int> FlatMap;
+   FlatMap flat;
+   std::map<int, int> gold;
+   for(int i=0; i<1000; i++){
+      flat.insert(std::make_pair(i * 10, i));
+      gold.insert(std::make_pair(i * 10, i));
+   }
+   for(int i=0; i<2000; i++){
+      int key = next_random(state) % 10000;
+      size_t count = i % 10 ? next_random(state) % 4 : next_random(state) % 300;
+      FlatMap::iterator first = flat.lower_bound(key);
+      std::map<int, int>::iterator gfirst = gold.lower_bound(key), glast = gfirst;
+      for(size_t j=0; j<count && glast != gold.end(); j++) ++glast;
+      count = std::distance(gfirst, glast);
+      int low = gfirst == gold.begin() ? -1000 : (--std::map<int, int>::iterator(gfirst))->first;
+      int high = glast == gold.end() ? 11000 : glast->first;
+      std::vector<std::pair<int, int> > values;
+      for(int value = low + 1 + (int)((state >> 4) % 3); value < high && values.size() < (state >> 12) % 5; value += 2)
+         values.push_back(std::make_pair(value, i));
+      gold.erase(gfirst, glast);
+      gold.insert(values.begin(), values.end());
+      flat.replace(first, count, values.begin(), values.end());
+   }
+   std::map<int, int>::iterator gitr = gold.begin();
+   for(FlatMap::iterator itr = flat.begin(); itr != flat.end(); ++itr, ++gitr){
+      if(gitr == gold.end() || itr->first != gitr->first || itr->second != gitr->second){
+         std::cerr << "FAILED: spliced map differs" << std::endl;
+         return 1;
+      }
+   }
+   if(gitr != gold.end() || flat.size() != gold.size()){
+      std::cerr << "FAILED: spliced map size mismatch" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_rectangle_formation_sink] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: get the max rectangles of a random set large enough to
+ * run over connected components and of a comb, a bar over more teeth
+ * than a node keeps in its list of traced paths. The rectangles must
+ * lie in the set and cover it, the comb must give the bar and one
+ * rectangle per tooth through the bar, and the component runs must
+ * give the serial rectangles in the serial order.
+ */
+int test_max_cover_components(){
+   typedef boost::polygon::rectangle_data<intDC> Rect;
+   unsigned int state = 17;
+   GTLPolygonSet pset;
+   std::vector<Rect> drawn = random_rects(state, 6000, 3000);
+   pset.insert(drawn.begin(), drawn.end());
+   GTLPolygonSet comb;
+   comb.insert(Rect(0, 100, 400, 110));
+   for(int i=0; i<40; i++)
+      comb.insert(Rect(i * 10, 90 - i, i * 10 + 5, 100));
+   std::vector<Rect> serial;
+   for(int trial=0; trial<2; trial++){
+      GTLPolygonSet& set = trial ? comb : pset;
+      std::vector<Rect> rects;
+      boost::polygon::get_max_rectangles(rects, set);
+      GTLPolygonSet result;
+      for(size_t i=0; i<rects.size(); i++){
+         GTLPolygonSet outside;
+         outside.insert(rects[i]);
+         outside -= set;
+         if(!outside.empty()){
+            std::cerr << "FAILED: max rectangle outside the set in trial " << trial << std::endl;
+            return 1;
+         }
+         result.insert(rects[i]);
+      }
+      result ^= set;
+      if(!result.empty()){
+         std::cerr << "FAILED: max rectangles do not cover the set in trial " << trial << std::endl;
+         return 1;
+      }
+      if(trial){
+         if(rects.size() != 41 || std::find(rects.begin(), rects.end(), Rect(0, 100, 400, 110)) == rects.end() ||
+            std::find(rects.begin(), rects.end(), Rect(390, 51, 395, 110)) == rects.end()){
+            std::cerr << "FAILED: comb gave " << rects.size() << " max rectangles" << std::endl;
+            return 1;
+         }
+      } else {
+         serial = rects;
+      }
+   }
+   if(serial.size() < 4096){
+      std::cerr << "FAILED: too few rectangles to run over components" << std::endl;
+      return 1;
+   }
+   boost::polygon::polygon_max_cover_threads() = 4;
+   std::vector<Rect> components;
+   boost::polygon::get_max_rectangles(components, pset);
+   boost::polygon::polygon_max_cover_threads() = 1;
+   if(components != serial){
+      std::cerr << "FAILED: component runs differ from the serial max rectangles" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_max_cover_components] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: extract the connectivity of random rectangles, with some
+ * nodes inserted as polygon sets of several rectangles, as a graph, as
+ * components and as an edge list. The components must be the connected
+ * components of the graph labeled by their least node and the edge list
+ * must hold the edges of the graph.
+ */
+struct GTLEdgeSink {
+   std::set<std::pair<int, int> > edges;
+   void operator()(int a, int b){ edges.insert(std::make_pair((std::min)(a, b), (std::max)(a, b))); }
+};
+
+int test_connectivity_components(){
+   typedef boost::polygon::rectangle_data<intDC> Rect;
+   boost::polygon::connectivity_extraction_90<intDC> ce;
+   unsigned int state = 5;
+   for(int i=0; i<3000; i++){
+      GTLPolygonSet node;
+      std::vector<Rect> drawn = random_rects(state, 1+(i%3), 4000, 40);
+      node.insert(drawn.begin(), drawn.end());
+      ce.insert(node);
+   }
+   std::vector<std::set<int> > graph(3000);
+   ce.extract(graph);
+   std::vector<unsigned int> labels;
+   unsigned int componentCount = ce.extract_components(labels);
+   GTLEdgeSink sink;
+   ce.extract_edges(sink);
+   std::set<std::pair<int, int> > edges;
+   for(int i=0; i<3000; i++)
+      for(std::set<int>::iterator itr = graph[i].begin(); itr != graph[i].end(); ++itr)
+         if(i < *itr) edges.insert(std::make_pair(i, *itr));
+   if(edges.empty() || sink.edges != edges){
+      std::cerr << "FAILED: edge list differs from the graph" << std::endl;
+      return 1;
+   }
+   std::vector<unsigned int> expected(3000, 3000);
+   unsigned int expectedCount = 0;
+   for(int i=0; i<3000; i++){
+      if(expected[i] != 3000) continue;
+      ++expectedCount;
+      std::vector<int> stack(1, i);
+      expected[i] = i;
+      while(!stack.empty()){
+         int node = stack.back();
+         stack.pop_back();
+         for(std::set<int>::iterator itr = graph[node].begin(); itr != graph[node].end(); ++itr){
+            if(expected[*itr] == 3000){
+               expected[*itr] = i;
+               stack.push_back(*itr);
+            }
+         }
+      }
+   }
+   if(labels != expected || componentCount != expectedCount || componentCount == 3000){
+      std::cerr << "FAILED: components differ from the graph" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_connectivity_components] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: merge random rectangles on 30 layers, some inserted more
+ * than once, into a map keyed by property sets and into a map keyed by
+ * property masks. Each mask must have the region of the property set
+ * with its bits and the two maps must have the same number of entries.
+ * Properties outside 0 to 63 must be left out of the masks.
+ */
+int test_property_merge_mask(){
+   typedef boost::polygon::rectangle_data<intDC> Rect;
+   typedef polygon_ulong_long_type Mask;
+   boost::polygon::property_merge_90<intDC, int> pm;
+   unsigned int state = 11;
+   std::vector<Rect> drawn = random_rects(state, 3000, 2000, 100);
+   for(int i=0; i<3000; i++){
+      pm.insert(drawn[i], i % 30);
+      if(i % 7 == 0) pm.insert(drawn[i], i % 30);
+   }
+   std::map<std::set<int>, GTLPolygonSet> sets;
+   std::map<Mask, GTLPolygonSet> masks;
+   pm.merge(sets);
+   pm.merge(masks);
+   if(sets.size() < 100 || sets.size() != masks.size()){
+      std::cerr << "FAILED: " << sets.size() << " property sets and " << masks.size() << " masks" << std::endl;
+      return 1;
+   }
+   for(std::map<std::set<int>, GTLPolygonSet>::iterator itr = sets.begin(); itr != sets.end(); ++itr){
+      Mask mask = 0;
+      for(std::set<int>::const_iterator pitr = itr->first.begin(); pitr != itr->first.end(); ++pitr)
+         mask |= (Mask)1 << *pitr;
+      if(masks.find(mask) == masks.end()){
+         std::cerr << "FAILED: missing mask" << std::endl;
+         return 1;
+      }
+      GTLPolygonSet diff(masks[mask]);
+      diff ^= itr->second;
+      if(!diff.empty()){
+         std::cerr << "FAILED: mask region differs from the property set region" << std::endl;
+         return 1;
+      }
+   }
+   boost::polygon::property_merge_90<intDC, int> outside;
+   outside.insert(Rect(0, 0, 10, 10), 3);
+   outside.insert(Rect(5, 5, 20, 20), 64);
+   outside.insert(Rect(-5, -5, 3, 3), -1);
+   std::map<Mask, GTLPolygonSet> outsideMasks;
+   outside.merge(outsideMasks);
+   GTLPolygonSet kept(outsideMasks[(Mask)1 << 3]);
+   kept ^= Rect(0, 0, 10, 10);
+   if(outsideMasks.size() != 1 || !kept.empty()){
+      std::cerr << "FAILED: properties outside 0 to 63 gave " << outsideMasks.size() << " masks" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_property_merge_mask] PASSED" << std::endl;
+   return 0;
+}
+
+/*
+ * TEST PLAN: bloat, shrink and resize random sets with holes, corners
+ * touching and parts narrower than the sizing, in both orientations.
+ * bloat and shrink must give what the convolution of their rectangles
+ * in bloat2 and shrink2 gives, and a resize with different signs must
+ * give the shrink of one axis followed by the bloat of the other.
+ * Sets within the sizing of the limits of the coordinate type must
+ * shrink as they do away from them, and a set spanning nearly the
+ * whole coordinate range must shrink as its polygons do.
+ */
+int test_resize_edges(){
+   typedef boost::polygon::rectangle_data<intDC> Rect;
+   unsigned int state = 23;
+   for(int trial=0; trial<600; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet set(orient), holes(orient);
+      std::vector<Rect> drawn = random_rects(state, 20, 60, 15);
+      for(size_t i=0; i<drawn.size(); i++){
+         if(i % 4 == 3) holes.insert(drawn[i]);
+         else set.insert(drawn[i]);
+      }
+      set.insert(Rect(70, 70, 73, 73));
+      set.insert(Rect(73, 73, 76, 76));
+      set -= holes;
+      int west = next_random(state) % 7, east = next_random(state) % 7;
+      int south = next_random(state) % 7, north = next_random(state) % 7;
+      GTLPolygonSet result(set), expected(set);
+      if(trial % 3 == 0){
+         result.bloat(west, east, south, north);
+         expected.bloat2(west, east, south, north);
+      } else if(trial % 3 == 1){
+         result.shrink(west, east, south, north);
+         expected.shrink2(west, east, south, north);
+      } else {
+         result.resize(-west, east, south, north);
+         expected.move(west, -south);
+         if(east - west < 0) expected.shrink2(0, west - east, 0, 0);
+         if(south + north > 0) expected.bloat2(0, 0, 0, south + north);
+         if(east - west > 0) expected.bloat2(0, east - west, 0, 0);
+      }
+      result.clean();
+      expected.clean();
+      if(!(result == expected)){
+         std::cerr << "FAILED: resize differs from the convolution in trial " << trial << std::endl;
+         return 1;
+      }
+   }
+   const intDC max_coord = (std::numeric_limits<intDC>::max)();
+   const intDC min_coord = (std::numeric_limits<intDC>::min)();
+   for(int trial=0; trial<40; trial++){
+      boost::polygon::orientation_2d orient = trial % 2 ? boost::polygon::HORIZONTAL : boost::polygon::VERTICAL;
+      GTLPolygonSet set(orient);
+      std::vector<Rect> drawn = random_rects(state, 10, 60, 15);
+      for(size_t i=0; i<drawn.size(); i++) set.insert(drawn[i]);
+      int west = next_random(state) % 7, east = next_random(state) % 7;
+      int south = next_random(state) % 7, north = next_random(state) % 7;
+      //the rectangles lie in [0, 75], moved to within 9 of a corner of the coordinate range
+      intDC x_shift = trial % 4 < 2 ? max_coord - 84 : min_coord + 9;
+      intDC y_shift = trial % 8 < 4 ? max_coord - 84 : min_coord + 9;
+      GTLPolygonSet result(set), expected(set);
+      result.move(x_shift, y_shift);
+      result.shrink(west, east, south, north);
+      expected.shrink(west, east, south, north);
+      expected.move(x_shift, y_shift);
+      result.clean();
+      expected.clean();
+      if(!(result == expected)){
+         std::cerr << "FAILED: shrink at the limits of the coordinates differs in trial " << trial << std::endl;
+         return 1;
+      }
+   }
+   GTLPolygonSet wide, wide_expected;
+   wide.insert(Rect(min_coord + 3, min_coord + 3, max_coord - 3, max_coord - 3));
+   wide.insert(Rect(-10, -10, 10, 10), true);
+   wide.shrink(2, 3, 4, 5);
+   wide_expected.insert(Rect(min_coord + 5, min_coord + 7, max_coord - 6, max_coord - 8));
+   wide_expected.insert(Rect(-13, -15, 12, 14), true);
+   wide.clean();
+   wide_expected.clean();
+   if(!(wide == wide_expected)){
+      std::cerr << "FAILED: shrink of a set spanning the coordinate range" << std::endl;
+      return 1;
+   }
+   std::cout << "[test_resize_edges] PASSED" << std::endl;
+   return 0;
+}
+
 /*******************Test Iterator Support*******************/
 
 int test_orthogonal_half_edge(void) {
@@ -291,6 +2189,119 @@ int main(int argc, char** argv) {
      return 1;
   }
 
+  if(test_polygon_formation_arena()){
+     std::cerr << "[test_polygon_formation_arena] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_flat_tail_map()){
+     std::cerr << "[test_flat_tail_map] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_flat_tail_map_formation()){
+     std::cerr << "[test_flat_tail_map_formation] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_formation_sink()){
+     std::cerr << "[test_polygon_formation_sink] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_parallel_polygon_formation()){
+     std::cerr << "[test_parallel_polygon_formation] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_buffer_formation()){
+     std::cerr << "[test_polygon_buffer_formation] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_formation_stats()){
+     std::cerr << "[test_polygon_formation_stats] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_formation_hole_threshold()){
+     std::cerr << "[test_polygon_formation_hole_threshold] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_45_formation_threshold()){
+     std::cerr << "[test_polygon_45_formation_threshold] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_set_formation_threshold()){
+     std::cerr << "[test_polygon_set_formation_threshold] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_90_compact_set()){
+     std::cerr << "[test_polygon_90_compact_set] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_radix_sort()){
+     std::cerr << "[test_polygon_radix_sort] failed" << std::endl;
+     return 1;
+  }
+
+  if(test_polygon_90_incremental_clean()){
+     std::cerr << "[test_polygon_90_incremental_clean] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_boolean_flat_scan()){
+     std::cerr << "[test_polygon_boolean_flat_scan] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_90_nary_op()){
+     std::cerr << "[test_polygon_90_nary_op] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_90_fused_view()){
+     std::cerr << "[test_polygon_90_fused_view] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_boolean_tiles()){
+     std::cerr << "[test_polygon_boolean_tiles] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_90_external_set()){
+     std::cerr << "[test_polygon_90_external_set] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_set_serialization()){
+     std::cerr << "[test_polygon_set_serialization] failed" << std::endl;
+     return 1;
+  }
+  if(test_polygon_text_reader()){
+     std::cerr << "[test_polygon_text_reader] failed" << std::endl;
+     return 1;
+  }
+  if(test_rectangle_formation_sink()){
+     std::cerr << "[test_rectangle_formation_sink] failed" << std::endl;
+     return 1;
+  }
+  if(test_max_cover_components()){
+     std::cerr << "[test_max_cover_components] failed" << std::endl;
+     return 1;
+  }
+  if(test_connectivity_components()){
+     std::cerr << "[test_connectivity_components] failed" << std::endl;
+     return 1;
+  }
+  if(test_property_merge_mask()){
+     std::cerr << "[test_property_merge_mask] failed" << std::endl;
+     return 1;
+  }
+  if(test_resize_edges()){
+     std::cerr << "[test_resize_edges] failed" << std::endl;
+     return 1;
+  }
+
   if (test_active_tail_formation()) {
     std::cerr << "[test_active_tail_formation] failed" << std::endl;
     return 1;